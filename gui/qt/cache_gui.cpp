@@ -103,7 +103,7 @@ void CacheGUI::setupConfigurationPanel()
     // Replacement policy
     layout->addWidget(new QLabel("Replacement Policy:"), 3, 0);
     m_replacementPolicyCombo = new QComboBox();
-    m_replacementPolicyCombo->addItems({"LRU", "FIFO", "RANDOM"});
+    m_replacementPolicyCombo->addItems({"LRU", "FIFO", "RANDOM", "TREE_PLRU", "BIT_PLRU", "SRRIP", "BRRIP", "DRRIP", "LFU", "ARC"});
     layout->addWidget(m_replacementPolicyCombo, 3, 1);
     
     // Write policy
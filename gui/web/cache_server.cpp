@@ -100,7 +100,13 @@ private:
             size_t num_sets = (associativity == 0) ? 1 : cache_size / (block_size * associativity);
             size_t actual_associativity = (associativity == 0) ? cache_size / block_size : associativity;
             
-            auto policy = ReplacementPolicyFactory::createPolicy(policy_type, num_sets, actual_associativity);
+            uint64_t seed = RandomPolicy::kDefaultSeed;
+            if (params.count("seed")) {
+                seed = std::stoull(params.at("seed"), nullptr, 0);
+            }
+            
+            auto policy = ReplacementPolicyFactory::createPolicy(policy_type, num_sets, actual_associativity,
+                                                                 nullptr, seed);
             
             SetAssociativeCache::WritePolicy write_policy = SetAssociativeCache::WritePolicy::WRITE_THROUGH;
             if (params.count("write_policy") && params.at("write_policy") == "WRITE_BACK") {
@@ -254,7 +260,17 @@ private:
         }
         
         std::string traceData = urlDecode(params.at("trace_data"));
-        std::vector<std::string> results;
+        
+        // Parse the whole trace first so it can be simulated as one batch
+        struct TraceEntry {
+            std::string operation;
+            std::string addressStr;
+            std::string error;      // Non-empty if the line failed to parse
+            size_t batchIndex = 0;  // Position in the access batch
+        };
+        std::vector<TraceEntry> entries;
+        std::vector<uint64_t> addresses;
+        std::vector<Cache::Operation> operations;
         
         std::istringstream iss(traceData);
         std::string line;
@@ -264,39 +280,45 @@ private:
             if (line.empty() || line[0] == '#') continue;
             
             std::istringstream lineStream(line);
-            std::string operation;
-            std::string addressStr;
+            TraceEntry entry;
             
-            if (lineStream >> operation >> addressStr) {
+            if (lineStream >> entry.operation >> entry.addressStr) {
                 try {
-                    uint64_t address = std::stoull(addressStr, nullptr, 16);
-                    Cache::Operation op = (operation == "W" || operation == "WRITE") ? 
+                    uint64_t address = std::stoull(entry.addressStr, nullptr, 16);
+                    Cache::Operation op = (entry.operation == "W" || entry.operation == "WRITE") ? 
                         Cache::Operation::WRITE : Cache::Operation::READ;
                     
-                    auto result = cache_->access(address, op);
-                    
-                    std::ostringstream resultJson;
-                    resultJson << "{";
-                    resultJson << R"("address": ")" << addressStr << "\",";
-                    resultJson << R"("operation": ")" << operation << "\",";
-                    resultJson << R"("result": ")" << resultToString(result) << "\"";
-                    resultJson << "}";
-                    
-                    results.push_back(resultJson.str());
+                    entry.batchIndex = addresses.size();
+                    addresses.push_back(address);
+                    operations.push_back(op);
                 } catch (const std::exception& e) {
-                    std::ostringstream errorJson;
-                    errorJson << "{";
-                    errorJson << R"("address": ")" << addressStr << "\",";
-                    errorJson << R"("operation": ")" << operation << "\",";
-                    errorJson << R"("result": "ERROR",)";
-                    errorJson << R"("error": ")" << e.what() << "\"";
-                    errorJson << "}";
-                    
-                    results.push_back(errorJson.str());
+                    entry.error = e.what();
                 }
+                entries.push_back(entry);
             }
         }
         
+        std::vector<Cache::AccessResult> batchResults(addresses.size());
+        cache_->accessBatch(addresses.data(), operations.data(), addresses.size(), batchResults.data());
+        
+        std::vector<std::string> results;
+        results.reserve(entries.size());
+        for (const auto& entry : entries) {
+            std::ostringstream resultJson;
+            resultJson << "{";
+            resultJson << R"("address": ")" << entry.addressStr << "\",";
+            resultJson << R"("operation": ")" << entry.operation << "\",";
+            if (entry.error.empty()) {
+                resultJson << R"("result": ")" << resultToString(batchResults[entry.batchIndex]) << "\"";
+            } else {
+                resultJson << R"("result": "ERROR",)";
+                resultJson << R"("error": ")" << entry.error << "\"";
+            }
+            resultJson << "}";
+            
+            results.push_back(resultJson.str());
+        }
+        
         auto stats = cache_->getStatistics();
         
         std::ostringstream response;
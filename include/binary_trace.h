@@ -0,0 +1,207 @@
+#ifndef BINARY_TRACE_H
+#define BINARY_TRACE_H
+
+#include "trace_reader.h"
+#include "gzip_stream.h"
+#include "mapped_file.h"
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Compact binary trace format
+ *
+ * Layout (all integers little-endian):
+ *   File header (48 bytes):
+ *     magic "CSBT", uint16 version, uint16 flags,
+ *     uint64 record count, uint64 block count, uint32 records per block,
+ *     uint32 reserved, uint64 payload checksum, uint64 header checksum
+ *   Blocks, each:
+ *     uint32 record count, uint32 payload bytes, uint64 payload checksum,
+ *     payload = operation bitmap (1 bit per record, set for writes)
+ *               followed by one LEB128 varint per record holding the
+ *               zigzag-encoded delta from the previous address, then, when
+ *               the kFlagCoreIds header flag is set, one varint core id
+ *               per record and, when kFlagTimestamps is set, one varint per
+ *               record holding the zigzag-encoded delta from the previous
+ *               timestamp
+ *
+ * Address and timestamp deltas restart from 0 in every block, so blocks decode
+ * independently and can be handed to different workers. Checksums are
+ * 64-bit FNV-1a; the header's payload checksum covers the block checksums.
+ */
+namespace binary_trace {
+
+constexpr char kMagic[4] = {'C', 'S', 'B', 'T'};
+constexpr uint16_t kVersion = 1;
+constexpr size_t kHeaderSize = 48;
+constexpr size_t kBlockHeaderSize = 16;
+constexpr uint32_t kDefaultRecordsPerBlock = 65536;
+constexpr uint16_t kFlagCoreIds = 0x1;      // Blocks carry a core id per record
+constexpr uint16_t kFlagTimestamps = 0x2;   // Blocks carry a timestamp per record
+
+/**
+ * @brief 64-bit FNV-1a checksum
+ * @param data Bytes to hash
+ * @param size Number of bytes
+ * @param seed Running checksum to continue from
+ * @return Checksum
+ */
+uint64_t checksum(const uint8_t* data, size_t size, uint64_t seed = 0xcbf29ce484222325ULL);
+
+/**
+ * @brief Check whether a file starts with the binary trace magic
+ *
+ * Gzip-compressed files are checked after decompression.
+ *
+ * @param filename File to inspect
+ * @return True for binary traces
+ */
+bool isBinaryTrace(const std::string& filename);
+
+} // namespace binary_trace
+
+/**
+ * @brief Writer for the binary trace format
+ */
+class BinaryTraceWriter {
+public:
+    /**
+     * @brief Constructor
+     * @param filename Output file
+     * @param records_per_block Records per independently decodable block
+     * @param core_ids Store the core id of each record
+     * @param timestamps Store the timestamp of each record
+     * @throws std::runtime_error if the file cannot be created
+     */
+    explicit BinaryTraceWriter(const std::string& filename,
+                               uint32_t records_per_block = binary_trace::kDefaultRecordsPerBlock,
+                               bool core_ids = false, bool timestamps = false);
+
+    /**
+     * @brief Destructor, finishes the file if finish() was not called
+     */
+    ~BinaryTraceWriter();
+
+    /**
+     * @brief Append one record
+     * @param record Trace record
+     * @throws std::invalid_argument for a non-zero core id or timestamp that is not stored
+     */
+    void write(const TraceRecord& record);
+
+    /**
+     * @brief Flush the last block and write the final header
+     */
+    void finish();
+
+    uint64_t getRecordCount() const { return record_count_; }
+
+private:
+    std::ofstream file_;
+    uint32_t records_per_block_;
+    uint64_t record_count_;
+    uint64_t block_count_;
+    uint64_t payload_checksum_;
+    bool core_ids_;
+    bool timestamps_;
+    bool finished_;
+
+    // Current block
+    std::vector<TraceRecord> pending_;
+    std::vector<uint8_t> payload_;
+
+    void flushBlock();
+    void writeHeader();
+};
+
+/**
+ * @brief Reader for the binary trace format over a memory-mapped file
+ */
+class BinaryTraceReader : public TraceReader {
+public:
+    /**
+     * @brief Block location inside the file
+     */
+    struct BlockInfo {
+        size_t offset;          // Offset of the block header
+        uint32_t record_count;  // Records in the block
+    };
+
+    /**
+     * @brief Constructor, validates the header and indexes the blocks
+     * @param filename Trace file
+     * @throws std::runtime_error on a malformed or corrupted file
+     */
+    explicit BinaryTraceReader(const std::string& filename);
+
+    size_t read(std::vector<TraceRecord>& out, size_t max_records) override;
+    uint64_t getInvalidRecords() const override { return 0; }
+
+    /**
+     * @brief Decode one block independently of the others
+     * @param block_index Block to decode
+     * @param out Records are appended here
+     * @throws std::runtime_error if the block checksum does not match
+     */
+    void decodeBlock(size_t block_index, std::vector<TraceRecord>& out) const;
+
+    uint64_t getRecordCount() const { return record_count_; }
+    bool hasCoreIds() const { return core_ids_; }
+    bool hasTimestamps() const { return timestamps_; }
+    const std::vector<BlockInfo>& getBlocks() const { return blocks_; }
+
+private:
+    MappedFile file_;
+    uint64_t record_count_;
+    bool core_ids_;
+    bool timestamps_;
+    std::vector<BlockInfo> blocks_;
+
+    // Streaming state for read()
+    size_t next_block_;
+    std::vector<TraceRecord> decoded_;
+    size_t decoded_pos_;
+};
+
+/**
+ * @brief Reader for gzip-compressed binary traces
+ *
+ * Blocks are decoded one at a time as they are decompressed; the record
+ * count and payload checksum in the header are verified at end of stream.
+ */
+class GzipBinaryTraceReader : public TraceReader {
+public:
+    /**
+     * @brief Constructor, validates the header
+     * @param filename Compressed trace file
+     * @throws std::runtime_error on a malformed file
+     */
+    explicit GzipBinaryTraceReader(const std::string& filename);
+
+    size_t read(std::vector<TraceRecord>& out, size_t max_records) override;
+    uint64_t getInvalidRecords() const override { return 0; }
+
+    uint64_t getRecordCount() const { return record_count_; }
+
+private:
+    GzipStream stream_;
+    std::string filename_;
+    uint64_t record_count_;
+    uint64_t expected_checksum_;
+    bool core_ids_;
+    bool timestamps_;
+
+    // Running totals checked at end of stream
+    uint64_t records_seen_;
+    uint64_t payload_checksum_;
+    size_t block_index_;
+    bool done_;
+
+    std::vector<uint8_t> payload_;
+    std::vector<TraceRecord> decoded_;
+    size_t decoded_pos_;
+};
+
+#endif // BINARY_TRACE_H
@@ -0,0 +1,62 @@
+#ifndef BLOCK_DATA_STORE_H
+#define BLOCK_DATA_STORE_H
+
+#include <cstdint>
+#include <cstddef>
+#include <cstdlib>
+#include <memory>
+
+/**
+ * @brief Arena holding the payload bytes of every cache block
+ *
+ * The store is a single contiguous allocation of num_blocks * block_size
+ * bytes, indexed by the same block slot as the tag array. It is only
+ * created when a cache runs in a data-carrying mode.
+ */
+class BlockDataStore {
+public:
+    /**
+     * @brief Constructor
+     * @param num_blocks Number of blocks in the cache
+     * @param block_size Block size in bytes
+     */
+    BlockDataStore(size_t num_blocks, size_t block_size);
+
+    /**
+     * @brief Get payload of a block
+     * @param slot Block slot (set * ways + way)
+     * @return Pointer to block_size bytes
+     */
+    uint8_t* block(size_t slot) { return arena_.get() + slot * block_size_; }
+    const uint8_t* block(size_t slot) const { return arena_.get() + slot * block_size_; }
+
+    /**
+     * @brief Zero the payload of a block
+     * @param slot Block slot
+     */
+    void clearBlock(size_t slot);
+
+    /**
+     * @brief Zero the whole arena
+     */
+    void clear();
+
+    size_t getBlockSize() const { return block_size_; }
+    size_t getNumBlocks() const { return num_blocks_; }
+
+    /**
+     * @brief Total bytes held by the arena
+     */
+    size_t getSizeBytes() const { return num_blocks_ * block_size_; }
+
+private:
+    struct FreeDeleter {
+        void operator()(uint8_t* p) const { std::free(p); }
+    };
+
+    size_t num_blocks_;
+    size_t block_size_;
+    std::unique_ptr<uint8_t, FreeDeleter> arena_; // calloc'd so untouched pages stay lazily zeroed
+};
+
+#endif // BLOCK_DATA_STORE_H
@@ -0,0 +1,75 @@
+#ifndef BLOCK_INDEX_H
+#define BLOCK_INDEX_H
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+/**
+ * @brief Hash index from block number to tag-store slot
+ *
+ * Open addressing with linear probing and backward-shift deletion, sized
+ * for at most one entry per cache block at a load factor of 1/2 or less, so
+ * lookups, inserts and erases take O(1) expected time and never allocate.
+ * Used instead of a tag scan when a set is too wide to search linearly.
+ */
+class BlockIndex {
+public:
+    /**
+     * @brief Constructor
+     * @param capacity Maximum number of entries (the number of cache blocks)
+     */
+    explicit BlockIndex(size_t capacity);
+
+    /**
+     * @brief Find the slot of a block
+     * @param key Block number
+     * @return Slot, or -1 if the block is not indexed
+     */
+    int64_t find(uint64_t key) const {
+        for (size_t i = bucket(key); slots_[i] != kEmpty; i = (i + 1) & mask_) {
+            if (keys_[i] == key) return slots_[i];
+        }
+        return -1;
+    }
+
+    /**
+     * @brief Add a block that is not indexed yet
+     * @param key Block number
+     * @param slot Tag-store slot holding the block
+     */
+    void insert(uint64_t key, uint32_t slot) {
+        size_t i = bucket(key);
+        while (slots_[i] != kEmpty) {
+            i = (i + 1) & mask_;
+        }
+        keys_[i] = key;
+        slots_[i] = slot;
+    }
+
+    /**
+     * @brief Remove a block if it is indexed
+     * @param key Block number
+     */
+    void erase(uint64_t key);
+
+    /**
+     * @brief Remove all entries
+     */
+    void clear();
+
+private:
+    static constexpr uint32_t kEmpty = UINT32_MAX;
+
+    std::vector<uint64_t> keys_;
+    std::vector<uint32_t> slots_;   // kEmpty marks a free bucket
+    size_t mask_;
+    unsigned shift_;
+
+    size_t bucket(uint64_t key) const {
+        // Fibonacci hashing spreads strided block numbers over the table
+        return static_cast<size_t>((key * 0x9E3779B97F4A7C15ULL) >> shift_);
+    }
+};
+
+#endif // BLOCK_INDEX_H
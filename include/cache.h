@@ -5,6 +5,7 @@
 #include <string>
 #include <vector>
 #include <memory>
+#include <utility>
 
 // Forward declarations
 class ReplacementPolicy;
@@ -33,6 +34,19 @@ public:
         WRITE
     };
 
+    /**
+     * @brief Aggregate outcome of a batch of accesses
+     */
+    struct BatchResult {
+        uint64_t read_hits = 0;
+        uint64_t read_misses = 0;
+        uint64_t write_hits = 0;
+        uint64_t write_misses = 0;
+
+        uint64_t hits() const { return read_hits + write_hits; }
+        uint64_t misses() const { return read_misses + write_misses; }
+    };
+
     /**
      * @brief Constructor
      * @param cache_size Total cache size in bytes
@@ -54,6 +68,17 @@ public:
      */
     virtual AccessResult access(uint64_t address, Operation operation) = 0;
 
+    /**
+     * @brief Access cache with a batch of addresses
+     * @param addresses Memory addresses (count entries)
+     * @param operations Operation for each address (count entries)
+     * @param count Number of accesses
+     * @param results Caller-provided buffer for count results, or nullptr for counts only
+     * @return Aggregate hit/miss counts of the batch
+     */
+    virtual BatchResult accessBatch(const uint64_t* addresses, const Operation* operations,
+                                    size_t count, AccessResult* results = nullptr);
+
     /**
      * @brief Get cache statistics
      * @return Statistics object
@@ -76,6 +101,22 @@ public:
      */
     virtual std::string getConfig() const;
 
+    /**
+     * @brief Print cache contents (for debugging)
+     */
+    virtual void printCacheContents() const;
+
+    /**
+     * @brief Named event counters of the replacement policy
+     */
+    using PolicyCounters = std::vector<std::pair<std::string, uint64_t>>;
+
+    /**
+     * @brief Get replacement policy counters
+     * @return Counters, empty if the policy keeps none
+     */
+    virtual PolicyCounters getPolicyCounters() const { return {}; }
+
     // Getters
     size_t getCacheSize() const { return cache_size_; }
     size_t getBlockSize() const { return block_size_; }
@@ -95,21 +136,31 @@ protected:
      * @param address Memory address
      * @return Set index
      */
-    size_t getSetIndex(uint64_t address) const;
+    size_t getSetIndex(uint64_t address) const { return (address >> offset_bits_) & index_mask_; }
 
     /**
      * @brief Extract tag from address
      * @param address Memory address
      * @return Tag
      */
-    uint64_t getTag(uint64_t address) const;
+    uint64_t getTag(uint64_t address) const { return address >> (offset_bits_ + index_bits_); }
 
     /**
      * @brief Extract block offset from address
      * @param address Memory address
      * @return Block offset
      */
-    size_t getBlockOffset(uint64_t address) const;
+    size_t getBlockOffset(uint64_t address) const { return address & offset_mask_; }
+
+    /**
+     * @brief Rebuild the block-aligned address of a cached block, e.g. a victim
+     * @param set_index Set index
+     * @param tag Tag
+     * @return Address of the first byte of the block
+     */
+    uint64_t blockAddress(size_t set_index, uint64_t tag) const {
+        return (tag << (offset_bits_ + index_bits_)) | (static_cast<uint64_t>(set_index) << offset_bits_);
+    }
 
 protected:
     size_t offset_bits_;     // Number of offset bits
@@ -0,0 +1,216 @@
+#ifndef CACHE_HIERARCHY_H
+#define CACHE_HIERARCHY_H
+
+#include "cache.h"
+#include "cache_spec.h"
+#include "cache_statistics.h"
+#include "lower_level.h"
+#include "set_associative_cache.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Chain of cache levels (L1, L2, ...) in front of memory
+ *
+ * Accesses enter at the first level. Misses fetch from the next level,
+ * write-through and no-write-allocate writes pass down as writes, and
+ * evicted blocks are handed down, carrying writebacks when dirty. Each level
+ * below the first states how its contents relate to the levels above it:
+ *
+ *   NON_INCLUSIVE  Fills allocate here too, but evictions here leave the
+ *                  upper copies alone.
+ *   INCLUSIVE      Like non-inclusive, but evicting a block also
+ *                  back-invalidates it in every upper level. Dirty upper copies
+ *                  are written back along with the victim.
+ *   EXCLUSIVE      Blocks live in either this level or the upper ones. A hit
+ *                  moves the block up, and the upper level's evictions
+ *                  (clean or dirty) fill this level.
+ *
+ * The first level keeps its own statistics. Lower levels count the requests
+ * that reach them: fills are reads, write-throughs and writebacks are writes.
+ * All levels must use the same block size.
+ *
+ * Each access is also attributed to the level that served it, for timing: a
+ * hit at level k costs the hit latencies of levels 1..k, and a block from
+ * memory costs all hit latencies plus the last level's miss penalty.
+ */
+class CacheHierarchy {
+public:
+    /**
+     * @brief Relationship of a level to the levels above it
+     */
+    enum class InclusionPolicy {
+        NON_INCLUSIVE,
+        INCLUSIVE,
+        EXCLUSIVE
+    };
+
+    /**
+     * @brief Configuration of one level
+     */
+    struct LevelSpec {
+        CacheSpec cache;
+        InclusionPolicy inclusion = InclusionPolicy::NON_INCLUSIVE;
+    };
+
+    /**
+     * @brief Hierarchy events counted per level
+     */
+    struct LevelCounters {
+        uint64_t writebacks = 0;           // Dirty blocks evicted to the next level
+        uint64_t back_invalidations = 0;   // Upper copies removed by this level's evictions
+        uint64_t victim_fills = 0;         // Blocks installed from upper-level evictions (exclusive)
+    };
+
+    /**
+     * @brief Constructor
+     * @param levels Level configurations, first level first
+     * @throws std::invalid_argument if there are no levels, block sizes differ, a level
+     *         is invalid or a level below the first has a prefetcher, victim cache or
+     *         miss cache
+     */
+    explicit CacheHierarchy(const std::vector<LevelSpec>& levels);
+
+    CacheHierarchy(const CacheHierarchy&) = delete;
+    CacheHierarchy& operator=(const CacheHierarchy&) = delete;
+
+    /**
+     * @brief Access the hierarchy
+     * @param address Memory address
+     * @param operation Operation type
+     * @return Result at the first level
+     */
+    Cache::AccessResult access(uint64_t address, Cache::Operation operation);
+
+    /**
+     * @brief Access the hierarchy with a batch of addresses
+     * @param addresses Memory addresses (count entries)
+     * @param operations Operation for each address (count entries)
+     * @param count Number of accesses
+     * @param results Caller-provided buffer for count first-level results, or nullptr
+     * @return Aggregate first-level hit/miss counts
+     */
+    Cache::BatchResult accessBatch(const uint64_t* addresses, const Cache::Operation* operations,
+                                   size_t count, Cache::AccessResult* results = nullptr);
+
+    size_t getLevelCount() const { return levels_.size(); }
+    const SetAssociativeCache& getLevel(size_t level) const { return *levels_.at(level); }
+    InclusionPolicy getInclusionPolicy(size_t level) const { return inclusion_.at(level); }
+
+    /**
+     * @brief Get statistics of one level
+     * @param level Level index, 0 for the first level
+     * @return Requests seen by that level
+     */
+    CacheStatistics getLevelStatistics(size_t level) const;
+
+    const LevelCounters& getLevelCounters(size_t level) const { return counters_.at(level); }
+    uint64_t getMemoryReads() const { return memory_reads_; }
+    uint64_t getMemoryWrites() const { return memory_writes_; }
+
+    /**
+     * @brief Get the simulated latencies of the accesses so far
+     *
+     * First-level hits cost its hit latency and victim or miss cache hits
+     * TimingModel::kVictimCacheCycles more. Misses that fetch a block wait
+     * for the level that supplies it. Stores are buffered, so no-write-allocate
+     * write misses cost a hit.
+     * @return Access latencies
+     */
+    AccessTiming getTiming() const;
+
+    /**
+     * @brief Reset statistics of all levels
+     */
+    void resetStatistics();
+
+    /**
+     * @brief Clear all levels and statistics
+     */
+    void clear();
+
+    /**
+     * @brief Get a per-level report with local and global miss rates
+     * @return Report text
+     */
+    std::string getReport() const;
+
+    /**
+     * @brief Parse a hierarchy description
+     *
+     * Levels are separated by ';' and hold comma-separated key=value pairs
+     * using the cache parameter keys of CacheSpec::setParameter plus
+     * i|inclusion (NON_INCLUSIVE, INCLUSIVE or EXCLUSIVE). Unset parameters
+     * come from the base configuration, except its prefetcher, which only
+     * the first level inherits.
+     *
+     * Example: "s=32K,a=8,w=WRITE_BACK;s=256K,a=8,i=INCLUSIVE;s=8M,a=16,i=EXCLUSIVE"
+     *
+     * @param spec Hierarchy description
+     * @param base Configuration supplying unset parameters
+     * @return Level configurations
+     * @throws std::invalid_argument on a malformed description
+     */
+    static std::vector<LevelSpec> parseSpec(const std::string& spec, const CacheSpec& base);
+
+    /**
+     * @brief Convert an inclusion policy name
+     * @param name NON_INCLUSIVE, INCLUSIVE or EXCLUSIVE (any case)
+     * @return Inclusion policy
+     * @throws std::invalid_argument for unknown names
+     */
+    static InclusionPolicy stringToInclusion(const std::string& name);
+
+    /**
+     * @brief Get the name of an inclusion policy
+     */
+    static const char* inclusionToString(InclusionPolicy inclusion);
+
+private:
+    /**
+     * @brief Port connecting a level to the one below it
+     */
+    class Link : public LowerLevel {
+    public:
+        Link(CacheHierarchy& hierarchy, size_t level) : hierarchy_(hierarchy), level_(level) {}
+        bool read(uint64_t address) override;
+        bool prefetch(uint64_t address) override { return hierarchy_.readLevel(level_ + 1, address); }
+        void write(uint64_t address) override { hierarchy_.writeLevel(level_ + 1, address); }
+        void evict(uint64_t address, bool dirty) override { hierarchy_.evictFrom(level_, address, dirty); }
+
+    private:
+        CacheHierarchy& hierarchy_;
+        size_t level_;
+    };
+
+    std::vector<std::unique_ptr<SetAssociativeCache>> levels_;
+    std::vector<InclusionPolicy> inclusion_;
+    std::vector<std::unique_ptr<Link>> links_;
+    std::vector<CacheStatistics> statistics_;   // Levels below the first
+    std::vector<LevelCounters> counters_;
+    uint64_t memory_reads_;
+    uint64_t memory_writes_;
+
+    // Timing: accesses by operation (read, write) and serving source, indexed
+    // 0 for a first-level hit, k for level k (levels_.size() is memory) and
+    // levels_.size() + 1 for a victim or miss cache hit
+    static constexpr size_t kNoFetch = SIZE_MAX;
+    std::vector<uint64_t> served_[2];
+    std::vector<uint64_t> latency_;   // Cycles of each serving source
+    size_t read_source_;               // Source of the last block read by readLevel
+    size_t demand_source_;             // Source of the current access's demand fetch, kNoFetch if none
+
+    /**
+     * @brief Attribute a first-level access to the source that served it
+     */
+    void recordServed(Cache::Operation operation, Cache::AccessResult result);
+
+    bool readLevel(size_t level, uint64_t address);
+    void writeLevel(size_t level, uint64_t address);
+    void writebackLevel(size_t level, uint64_t address);
+    void evictFrom(size_t level, uint64_t address, bool dirty);
+};
+
+#endif // CACHE_HIERARCHY_H
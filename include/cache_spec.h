@@ -0,0 +1,111 @@
+#ifndef CACHE_SPEC_H
+#define CACHE_SPEC_H
+
+#include "set_associative_cache.h"
+#include "timing.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Parameters of one cache configuration
+ *
+ * Policies are kept as their command-line names so a spec can be printed,
+ * compared and built into a cache in one place.
+ */
+struct CacheSpec {
+    size_t cache_size = 1024;                           // Total size in bytes
+    size_t block_size = 32;                             // Block size in bytes
+    size_t associativity = 4;                           // 1 = direct mapped, 0 = fully associative
+    std::string replacement_policy = "LRU";             // LRU|FIFO|RANDOM|TREE_PLRU|BIT_PLRU|SRRIP|BRRIP|DRRIP|LFU|ARC|OPT
+    std::string write_policy = "WRITE_THROUGH";         // WRITE_THROUGH|WRITE_BACK
+    std::string write_miss_policy = "WRITE_ALLOCATE";   // WRITE_ALLOCATE|NO_WRITE_ALLOCATE
+    bool track_data = false;                            // Store block payloads
+    uint64_t seed = RandomPolicy::kDefaultSeed;         // RANDOM replacement seed
+    std::string prefetcher = "NONE";                    // NONE|NEXT_LINE|STRIDE|STREAM
+    size_t prefetch_degree = 1;                         // Blocks prefetched per trigger
+    size_t prefetch_distance = 1;                       // How far ahead to prefetch
+    uint64_t prefetch_latency = 0;                      // Accesses before a prefetch arrives
+    size_t victim_cache = 0;                            // Victim cache blocks, 0 for none
+    size_t miss_cache = 0;                              // Miss cache blocks, 0 for none
+    uint64_t hit_latency = 1;                           // Cycles of a hit
+    uint64_t miss_penalty = 100;                        // Extra cycles of a miss served by memory
+
+    /**
+     * @brief Set one parameter by its command-line option name
+     *
+     * Keys are s|cache-size, b|block-size, a|associativity, r|replacement,
+     * w|write-policy, m|write-miss, p|prefetcher, prefetch-degree,
+     * prefetch-distance, prefetch-latency, victim-cache, miss-cache,
+     * hit-latency and miss-penalty. Sizes accept K and M suffixes and policy
+     * names are case-insensitive.
+     *
+     * @param key Parameter name
+     * @param value Parameter value
+     * @return False if the key is not a cache parameter
+     * @throws std::invalid_argument on a malformed size
+     */
+    bool setParameter(const std::string& key, const std::string& value);
+
+    /**
+     * @brief Strip leading and trailing spaces and tabs
+     */
+    static std::string trim(const std::string& str);
+
+    /**
+     * @brief Split a parameter list such as "s=8K,a=4" into trimmed, non-empty items
+     * @param str List text
+     * @param delimiter Item separator
+     * @return Items in order
+     */
+    static std::vector<std::string> splitList(const std::string& str, char delimiter);
+
+    /**
+     * @brief Build a cache for this configuration
+     * @param next_use Next-use index of the trace, required by OPT only
+     * @return New cache
+     * @throws std::invalid_argument if the configuration is invalid, OPT lacks a
+     *         next-use index built with this block size, OPT is combined with
+     *         a prefetcher, or both a victim and a miss cache are requested
+     */
+    std::unique_ptr<SetAssociativeCache> createCache(std::shared_ptr<const NextUseIndex> next_use = nullptr) const;
+
+    /**
+     * @brief Check whether the replacement policy needs a next-use index (OPT)
+     * @throws std::invalid_argument on an unknown replacement policy
+     */
+    bool needsNextUseIndex() const;
+
+    /**
+     * @brief Check whether the configuration has a prefetcher
+     * @throws std::invalid_argument on an unknown prefetcher
+     */
+    bool hasPrefetcher() const;
+
+    /**
+     * @brief Check whether the configuration has a victim or miss cache
+     */
+    bool hasVictimCache() const { return victim_cache > 0 || miss_cache > 0; }
+
+    /**
+     * @brief Get the latencies of this configuration
+     */
+    TimingModel getTimingModel() const { return TimingModel{hit_latency, miss_penalty}; }
+
+    /**
+     * @brief Derive the access latencies of a run of a cache built from this spec
+     */
+    AccessTiming evaluateTiming(const CacheStatistics& stats) const {
+        return getTimingModel().evaluate(stats, write_miss_policy != "NO_WRITE_ALLOCATE");
+    }
+
+    /**
+     * @brief Get a compact one-line description, e.g. "32768B/64B/8-way/LRU/WRITE_BACK/WRITE_ALLOCATE"
+     *
+     * A prefetcher is appended with its degree and distance, e.g. "/STREAM:4:16",
+     * and a victim or miss cache with its size, e.g. "/VC:8" or "/MC:8".
+     */
+    std::string toString() const;
+};
+
+#endif // CACHE_SPEC_H
@@ -1,6 +1,7 @@
 #ifndef CACHE_STATISTICS_H
 #define CACHE_STATISTICS_H
 
+#include <cstddef>
 #include <cstdint>
 #include <string>
 #include <ostream>
@@ -10,6 +11,18 @@
  */
 class CacheStatistics {
 public:
+    /**
+     * @brief Kinds of transfer between a cache and the level below it
+     */
+    enum class Transfer {
+        FILL,            // Block read on a demand miss
+        PREFETCH_FILL,   // Block read by the prefetcher
+        WRITEBACK,       // Dirty block written back
+        WRITE_THROUGH,   // Store written through by a write-through cache
+        BYPASS           // Store that missed and was not allocated (no-write-allocate)
+    };
+    static constexpr size_t kTransferKinds = 5;
+
     /**
      * @brief Constructor
      */
@@ -50,6 +63,55 @@ public:
      */
     void recordWrite();
 
+    /**
+     * @brief Record the outcome of a batch of accesses at once
+     * @param read_hits Read hits in the batch
+     * @param read_misses Read misses in the batch
+     * @param write_hits Write hits in the batch
+     * @param write_misses Write misses in the batch
+     */
+    void recordBatch(uint64_t read_hits, uint64_t read_misses, uint64_t write_hits, uint64_t write_misses);
+
+    /**
+     * @brief Record a prefetch fill
+     */
+    void recordPrefetch();
+
+    /**
+     * @brief Record the first demand access to a prefetched block
+     * @param late True if the access came before the prefetch completed
+     */
+    void recordPrefetchUse(bool late);
+
+    /**
+     * @brief Record a prefetched block leaving the cache without a demand access
+     */
+    void recordUnusedPrefetch();
+
+    /**
+     * @brief Record a demand miss on a block that a prefetch fill evicted
+     */
+    void recordPollutingPrefetch();
+
+    /**
+     * @brief Record a miss served by the victim or miss cache
+     * @param write True for a write miss
+     */
+    void recordVictimHit(bool write);
+
+    /**
+     * @brief Record a transfer to or from the level below
+     * @param kind Transfer kind
+     * @param bytes Bytes moved
+     */
+    void recordTransfer(Transfer kind, uint64_t bytes);
+
+    /**
+     * @brief Add the counters of another statistics object
+     * @param other Statistics to merge, e.g. from another shard of the same cache
+     */
+    void merge(const CacheStatistics& other);
+
     // Getters
     uint64_t getHits() const { return hits_; }
     uint64_t getMisses() const { return misses_; }
@@ -58,6 +120,25 @@ public:
     uint64_t getWriteHits() const { return write_hits_; }
     uint64_t getWriteMisses() const { return write_misses_; }
     uint64_t getTotalAccesses() const { return hits_ + misses_; }
+    uint64_t getPrefetches() const { return prefetches_; }
+    uint64_t getUsefulPrefetches() const { return useful_prefetches_; }
+    uint64_t getLatePrefetches() const { return late_prefetches_; }
+    uint64_t getUnusedPrefetches() const { return unused_prefetches_; }
+    uint64_t getPollutingPrefetches() const { return polluting_prefetches_; }
+    uint64_t getVictimHits() const { return victim_hits_; }
+    uint64_t getVictimWriteHits() const { return victim_write_hits_; }
+    uint64_t getTransfers(Transfer kind) const { return transfers_[static_cast<size_t>(kind)]; }
+    uint64_t getTransferBytes(Transfer kind) const { return transfer_bytes_[static_cast<size_t>(kind)]; }
+
+    /**
+     * @brief Get bytes read from the level below (demand and prefetch fills)
+     */
+    uint64_t getMemoryReadBytes() const;
+
+    /**
+     * @brief Get bytes written to the level below (writebacks, write-through and bypassing stores)
+     */
+    uint64_t getMemoryWriteBytes() const;
 
     /**
      * @brief Calculate hit rate
@@ -83,6 +164,24 @@ public:
      */
     double getWriteHitRate() const;
 
+    /**
+     * @brief Calculate prefetch accuracy
+     * @return Prefetches used by a demand access (useful or late) as percentage of prefetches
+     */
+    double getPrefetchAccuracy() const;
+
+    /**
+     * @brief Calculate prefetch coverage
+     * @return Misses removed by prefetching as percentage of the misses without it
+     */
+    double getPrefetchCoverage() const;
+
+    /**
+     * @brief Calculate victim cache hit rate
+     * @return Misses served by the victim or miss cache as percentage of misses
+     */
+    double getVictimHitRate() const;
+
     /**
      * @brief Get statistics as formatted string
      * @return Statistics string
@@ -101,6 +200,15 @@ private:
     uint64_t writes_;       // Total write accesses
     uint64_t write_hits_;   // Write hits
     uint64_t write_misses_; // Write misses
+    uint64_t prefetches_;           // Prefetch fills
+    uint64_t useful_prefetches_;    // Prefetched blocks used after they arrived
+    uint64_t late_prefetches_;      // Prefetched blocks used while still in flight
+    uint64_t unused_prefetches_;    // Prefetched blocks evicted or invalidated unused
+    uint64_t polluting_prefetches_; // Demand misses on blocks evicted by prefetch fills
+    uint64_t victim_hits_;          // Misses found in the victim or miss cache
+    uint64_t victim_write_hits_;    // Write misses found in the victim or miss cache
+    uint64_t transfers_[kTransferKinds];        // Transfers to or from the level below, by kind
+    uint64_t transfer_bytes_[kTransferKinds];   // Bytes moved, by kind
 };
 
 #endif // CACHE_STATISTICS_H
@@ -0,0 +1,210 @@
+#ifndef COHERENCE_H
+#define COHERENCE_H
+
+#include "cache.h"
+#include "cache_spec.h"
+#include "cache_statistics.h"
+#include "lower_level.h"
+#include "set_associative_cache.h"
+#include "trace_reader.h"
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Private per-core caches kept coherent by a MESI or MOESI protocol
+ *
+ * Each core owns a write-back, write-allocate SetAssociativeCache. A full-map
+ * directory tracks which cores hold each line and which core (if any) holds
+ * it Exclusive, Modified or Owned; the other holders are Shared. The directory
+ * is consulted on every access before the core's cache is touched:
+ *
+ *   Read miss    Bus read. A Modified holder supplies the data and becomes
+ *                Shared after writing it back (MESI) or keeps it as Owned
+ *                without a writeback (MOESI). With no other holder the line
+ *                is loaded Exclusive.
+ *   Write miss   Bus read-exclusive; all other copies are invalidated.
+ *   Write hit    Exclusive lines become Modified silently; Shared and Owned
+ *                lines issue an upgrade that invalidates the other copies.
+ *
+ * A miss on a line the core lost to another core's write is a coherence miss.
+ * It is classified as true sharing if the missing access touches a word
+ * written by another core since the invalidation, and as false sharing
+ * otherwise. A ping-pong is a write to a line whose previous writer was a
+ * different core.
+ */
+class CoherenceSimulator {
+public:
+    enum class Protocol {
+        MESI,
+        MOESI
+    };
+
+    enum class LineState {
+        INVALID,
+        SHARED,
+        EXCLUSIVE,
+        OWNED,
+        MODIFIED
+    };
+
+    /**
+     * @brief Coherence events seen by one core
+     */
+    struct CoreCounters {
+        uint64_t coherence_misses = 0;        // Misses on lines lost to invalidation
+        uint64_t true_sharing_misses = 0;     // ... touching a word another core wrote
+        uint64_t false_sharing_misses = 0;    // ... touching only words nobody else wrote
+        uint64_t invalidations_received = 0;  // Copies removed by other cores' writes
+        uint64_t upgrades = 0;                // Write hits on Shared/Owned lines
+        uint64_t writebacks = 0;              // Modified/Owned data written to memory
+    };
+
+    /**
+     * @brief Per-line contention summary
+     */
+    struct LineReport {
+        uint64_t address;                 // Block address
+        uint64_t ping_pongs;              // Writes by a different core than the previous writer
+        uint64_t invalidations;           // Copies invalidated on this line
+        uint64_t true_sharing_misses;
+        uint64_t false_sharing_misses;
+        size_t writers;                   // Distinct cores that wrote the line
+    };
+
+    /**
+     * @brief Constructor
+     * @param spec Configuration of each private cache; write policies are
+     *             forced to write-back and write-allocate
+     * @param cores Number of cores (1-64)
+     * @param protocol Coherence protocol
+     * @throws std::invalid_argument if the configuration or core count is invalid,
+     *         or the configuration has a prefetcher, victim cache or miss cache
+     */
+    CoherenceSimulator(const CacheSpec& spec, size_t cores, Protocol protocol = Protocol::MESI);
+
+    CoherenceSimulator(const CoherenceSimulator&) = delete;
+    CoherenceSimulator& operator=(const CoherenceSimulator&) = delete;
+
+    /**
+     * @brief Access memory from one core
+     * @param core Issuing core
+     * @param address Memory address
+     * @param operation Operation type
+     * @return Result in the core's private cache
+     * @throws std::out_of_range if core is not below the core count
+     */
+    Cache::AccessResult access(uint32_t core, uint64_t address, Cache::Operation operation);
+
+    /**
+     * @brief Access memory with a batch of trace records
+     * @param records Records carrying address, operation and core
+     * @param count Number of records
+     */
+    void accessBatch(const TraceRecord* records, size_t count);
+
+    size_t getCoreCount() const { return caches_.size(); }
+    Protocol getProtocol() const { return protocol_; }
+    const SetAssociativeCache& getCache(size_t core) const { return *caches_.at(core); }
+    CacheStatistics getStatistics(size_t core) const { return caches_.at(core)->getStatistics(); }
+    const CoreCounters& getCoreCounters(size_t core) const { return counters_.at(core); }
+
+    /**
+     * @brief Get the coherence state of a line in one core's cache
+     * @param core Core
+     * @param address Memory address
+     * @return Line state
+     */
+    LineState getLineState(size_t core, uint64_t address) const;
+
+    uint64_t getBusReads() const { return bus_reads_; }
+    uint64_t getBusReadExclusives() const { return bus_read_exclusives_; }
+    uint64_t getUpgrades() const { return upgrades_; }
+    uint64_t getInvalidations() const { return invalidations_; }
+    uint64_t getCacheToCacheTransfers() const { return cache_to_cache_; }
+    uint64_t getMemoryReads() const { return memory_reads_; }
+    uint64_t getMemoryWrites() const { return memory_writes_; }
+
+    /**
+     * @brief Get the lines that saw ping-pongs or invalidations
+     * @param limit Maximum number of lines, 0 for all
+     * @return Lines ordered by ping-pongs, then invalidations
+     */
+    std::vector<LineReport> getContendedLines(size_t limit = 0) const;
+
+    /**
+     * @brief Get a report of per-core and protocol-wide counters
+     * @param hot_lines Number of most contended lines to list
+     * @return Report text
+     */
+    std::string getReport(size_t hot_lines = 10) const;
+
+    /**
+     * @brief Convert a protocol name
+     * @param name MESI or MOESI (any case)
+     * @return Protocol
+     * @throws std::invalid_argument for unknown names
+     */
+    static Protocol stringToProtocol(const std::string& name);
+
+    static const char* protocolToString(Protocol protocol);
+    static const char* stateToString(LineState state);
+
+private:
+    static constexpr size_t kMaxCores = 64;   // Sharer sets are 64-bit masks
+
+    /**
+     * @brief Directory entry of one line
+     */
+    struct Line {
+        uint64_t sharers = 0;                 // Cores holding a valid copy
+        int owner = -1;                       // Core in E, M or O; -1 if all copies are Shared
+        LineState owner_state = LineState::INVALID;
+        int last_writer = -1;
+        uint64_t writers = 0;
+        uint64_t ping_pongs = 0;
+        uint64_t invalidations = 0;
+        uint64_t true_sharing_misses = 0;
+        uint64_t false_sharing_misses = 0;
+        // Cores that lost the line to a write, with the words written since
+        std::vector<std::pair<uint32_t, uint64_t>> invalidated;
+    };
+
+    /**
+     * @brief Eviction port of one core's cache
+     */
+    class CoreLink : public LowerLevel {
+    public:
+        CoreLink(CoherenceSimulator& simulator, uint32_t core) : simulator_(simulator), core_(core) {}
+        bool read(uint64_t) override { return false; }   // Fills are handled by the directory
+        void write(uint64_t) override {}
+        void evict(uint64_t address, bool) override { simulator_.evict(core_, address); }
+
+    private:
+        CoherenceSimulator& simulator_;
+        uint32_t core_;
+    };
+
+    Protocol protocol_;
+    std::vector<std::unique_ptr<SetAssociativeCache>> caches_;
+    std::vector<std::unique_ptr<CoreLink>> links_;
+    std::vector<CoreCounters> counters_;
+    std::unordered_map<uint64_t, Line> lines_;
+    size_t word_bytes_;   // Granularity of true/false sharing classification
+
+    uint64_t bus_reads_;
+    uint64_t bus_read_exclusives_;
+    uint64_t upgrades_;
+    uint64_t invalidations_;
+    uint64_t cache_to_cache_;
+    uint64_t memory_reads_;
+    uint64_t memory_writes_;
+
+    void classifyMiss(uint32_t core, Line& line, uint64_t word_mask);
+    void invalidateOthers(uint32_t core, Line& line, uint64_t block_address);
+    void evict(uint32_t core, uint64_t block_address);
+};
+
+#endif // COHERENCE_H
@@ -0,0 +1,98 @@
+#ifndef GZIP_STREAM_H
+#define GZIP_STREAM_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct gzFile_s;
+
+/**
+ * @brief Streaming gzip decompressor with a background inflate thread
+ *
+ * A producer thread inflates the file into a fixed ring of chunk buffers and
+ * blocks when all of them are full; the consumer takes chunks in order and
+ * hands each one back when it asks for the next. Nothing is inflated to disk
+ * and memory use is bounded by chunk_size * chunk_count.
+ */
+class GzipStream {
+public:
+    /**
+     * @brief Open a gzip file and start decompressing
+     * @param filename File to read
+     * @param chunk_size Bytes per decompressed chunk
+     * @param chunk_count Number of chunks buffered ahead of the consumer
+     * @throws std::runtime_error if the file cannot be opened
+     */
+    explicit GzipStream(const std::string& filename, size_t chunk_size = 1 << 20, size_t chunk_count = 4);
+
+    /**
+     * @brief Destructor, stops the decompression thread
+     */
+    ~GzipStream();
+
+    GzipStream(const GzipStream&) = delete;
+    GzipStream& operator=(const GzipStream&) = delete;
+
+    /**
+     * @brief Get the next decompressed chunk
+     *
+     * The previous chunk is released and must no longer be used.
+     *
+     * @param data Start of the chunk
+     * @param size Size of the chunk
+     * @return False at end of stream
+     * @throws std::runtime_error if decompression failed
+     */
+    bool next(const char*& data, size_t& size);
+
+    /**
+     * @brief Copy decompressed bytes into a buffer
+     * @param buffer Destination
+     * @param size Number of bytes wanted
+     * @return Number of bytes copied, less than size only at end of stream
+     * @throws std::runtime_error if decompression failed
+     */
+    size_t read(char* buffer, size_t size);
+
+    /**
+     * @brief Check whether a file starts with the gzip magic bytes
+     * @param filename File to inspect
+     * @return True for gzip files
+     */
+    static bool isGzipFile(const std::string& filename);
+
+private:
+    struct Chunk {
+        std::vector<char> data;
+        size_t size = 0;
+    };
+
+    std::string filename_;
+    gzFile_s* file_;
+    std::vector<Chunk> chunks_;
+
+    // Ring state, guarded by mutex_
+    std::mutex mutex_;
+    std::condition_variable not_full_;
+    std::condition_variable not_empty_;
+    size_t filled_;       // Chunks ready for the consumer
+    size_t read_index_;   // Next chunk for the consumer
+    bool finished_;       // Producer reached end of file or failed
+    bool stop_;           // Consumer is shutting down
+    std::string error_;
+
+    // Consumer state; the chunk before read_index_ is never refilled while held
+    bool holding_;        // Consumer owns the chunk before read_index_
+    size_t offset_;       // Bytes of the held chunk already returned by read()
+
+    std::thread producer_;
+
+    void produce();
+    void release();
+};
+
+#endif // GZIP_STREAM_H
@@ -0,0 +1,86 @@
+#ifndef INDEX_LISTS_H
+#define INDEX_LISTS_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Doubly linked lists threaded through a fixed array of nodes
+ *
+ * Nodes are small integers, e.g. set * associativity + way. Each node is in
+ * at most one list at a time. Lists only store their ends and size, so a
+ * policy can keep many of them per set, for example one per frequency bucket.
+ * All operations are O(1) and never allocate. The front of a list is its most
+ * recently pushed node.
+ */
+class IndexLists {
+public:
+    static constexpr uint32_t kNil = UINT32_MAX;
+
+    struct List {
+        uint32_t front = kNil;
+        uint32_t back = kNil;
+        uint32_t size = 0;
+    };
+
+    /**
+     * @brief Constructor
+     * @param nodes Number of nodes
+     */
+    explicit IndexLists(size_t nodes) : prev_(nodes, kNil), next_(nodes, kNil) {}
+
+    /**
+     * @brief Insert a node that is in no list at the front of a list
+     */
+    void pushFront(List& list, uint32_t node) {
+        prev_[node] = kNil;
+        next_[node] = list.front;
+        if (list.front != kNil) {
+            prev_[list.front] = node;
+        } else {
+            list.back = node;
+        }
+        list.front = node;
+        ++list.size;
+    }
+
+    /**
+     * @brief Unlink a node from the list holding it
+     */
+    void remove(List& list, uint32_t node) {
+        if (prev_[node] != kNil) {
+            next_[prev_[node]] = next_[node];
+        } else {
+            list.front = next_[node];
+        }
+        if (next_[node] != kNil) {
+            prev_[next_[node]] = prev_[node];
+        } else {
+            list.back = prev_[node];
+        }
+        prev_[node] = kNil;
+        next_[node] = kNil;
+        --list.size;
+    }
+
+    /**
+     * @brief Detach every node; lists referring to them must be reset too
+     */
+    void clear() {
+        std::fill(prev_.begin(), prev_.end(), kNil);
+        std::fill(next_.begin(), next_.end(), kNil);
+    }
+
+    /**
+     * @brief Get the node after a node, toward the back
+     */
+    uint32_t next(uint32_t node) const { return next_[node]; }
+
+private:
+    std::vector<uint32_t> prev_;
+    std::vector<uint32_t> next_;
+};
+
+#endif // INDEX_LISTS_H
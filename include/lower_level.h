@@ -0,0 +1,47 @@
+#ifndef LOWER_LEVEL_H
+#define LOWER_LEVEL_H
+
+#include <cstdint>
+
+/**
+ * @brief Port through which a cache talks to the level below it
+ *
+ * A cache without a lower level treats memory as an ideal sink. All
+ * addresses passed through the port are block-aligned.
+ */
+class LowerLevel {
+public:
+    virtual ~LowerLevel() = default;
+
+    /**
+     * @brief Fetch a block on a miss
+     * @param address Block address
+     * @return True if the block is handed over dirty (e.g. moved out of an exclusive level)
+     */
+    virtual bool read(uint64_t address) = 0;
+
+    /**
+     * @brief Fetch a block for a prefetch
+     *
+     * Behaves like read(); levels that time demand fetches override it to
+     * tell the two apart.
+     * @param address Block address
+     * @return True if the block is handed over dirty
+     */
+    virtual bool prefetch(uint64_t address) { return read(address); }
+
+    /**
+     * @brief Write a block through (write-through or no-write-allocate write)
+     * @param address Block address
+     */
+    virtual void write(uint64_t address) = 0;
+
+    /**
+     * @brief Notify that a valid block was evicted
+     * @param address Block address
+     * @param dirty True if the block was modified and must be written back
+     */
+    virtual void evict(uint64_t address, bool dirty) = 0;
+};
+
+#endif // LOWER_LEVEL_H
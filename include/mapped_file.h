@@ -0,0 +1,41 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Read-only memory mapping of a whole file
+ *
+ * Uses mmap where available; other platforms fall back to reading the file
+ * into a heap buffer so callers can treat both cases the same.
+ */
+class MappedFile {
+public:
+    /**
+     * @brief Map a file
+     * @param filename File to map
+     * @throws std::runtime_error if the file cannot be opened or mapped
+     */
+    explicit MappedFile(const std::string& filename);
+
+    /**
+     * @brief Destructor, unmaps the file
+     */
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* data() const { return data_; }
+    size_t size() const { return size_; }
+
+private:
+    const char* data_;
+    size_t size_;
+    bool mapped_;               // True if data_ is an mmap region
+    std::vector<char> buffer_;  // Fallback storage when mmap is unavailable
+};
+
+#endif // MAPPED_FILE_H
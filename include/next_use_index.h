@@ -0,0 +1,114 @@
+#ifndef NEXT_USE_INDEX_H
+#define NEXT_USE_INDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+class TraceReader;
+
+/**
+ * @brief Forward distance from every access of a trace to the next access of its block
+ *
+ * This is the first pass of offline (Belady OPT) replacement. The trace is read
+ * once, and its block numbers are walked backwards with a map from block to the
+ * latest position seen. Each access is then stored as a 32-bit distance: 0 if
+ * the block is never accessed again, and capped at UINT32_MAX for reuses that
+ * are farther away than that.
+ *
+ * Traces of up to memory_records accesses are indexed in memory. Longer traces
+ * spool their block numbers to a temporary file. That file is then processed in
+ * chunks from the end, and the distances go to a second temporary file, so
+ * only the map of distinct blocks has to fit in memory.
+ */
+class NextUseIndex {
+public:
+    static constexpr uint64_t kNever = UINT64_MAX;              // Position returned for blocks without reuse
+    // 12 bytes per record while building (64-bit block number and 32-bit distance), so
+    // 768 MiB plus the map of distinct blocks at most; the built index keeps 256 MiB
+    static constexpr size_t kDefaultMemoryRecords = 1 << 26;
+
+    /**
+     * @brief Build the index by reading a trace to its end
+     * @param reader Trace source
+     * @param block_size Block size in bytes
+     * @param memory_records Longest trace indexed in memory
+     * @throws std::invalid_argument if block_size is zero
+     * @throws std::runtime_error if a temporary file cannot be used
+     */
+    NextUseIndex(TraceReader& reader, size_t block_size, size_t memory_records = kDefaultMemoryRecords);
+
+    /**
+     * @brief Build the index of an in-memory address sequence
+     * @param addresses Memory addresses in trace order
+     * @param block_size Block size in bytes
+     * @throws std::invalid_argument if block_size is zero
+     */
+    NextUseIndex(const std::vector<uint64_t>& addresses, size_t block_size);
+
+    NextUseIndex(const NextUseIndex&) = delete;
+    NextUseIndex& operator=(const NextUseIndex&) = delete;
+
+    size_t getBlockSize() const { return block_size_; }
+    uint64_t size() const { return size_; }
+    bool isFileBacked() const { return file_ != nullptr; }
+
+    /**
+     * @brief Sequential reader of a shared index
+     *
+     * Each simulated cache owns a cursor. File-backed indexes are read one
+     * chunk at a time, so consecutive positions cost one load per chunk.
+     */
+    class Cursor {
+    public:
+        explicit Cursor(const NextUseIndex& index) : index_(&index), chunk_base_(0) {}
+
+        /**
+         * @brief Get the position of the next access to the block accessed at position
+         * @param position Zero-based access position in the trace
+         * @return Next position, or kNever if there is none or position is past the trace
+         */
+        uint64_t nextUse(uint64_t position);
+
+    private:
+        const NextUseIndex* index_;
+        std::vector<uint32_t> chunk_;   // Distances of a file-backed index from chunk_base_
+        uint64_t chunk_base_;
+
+        void load(uint64_t position);
+    };
+
+private:
+    static constexpr size_t kChunkEntries = 1 << 16;   // Entries per temporary file read or write
+
+    size_t block_size_;
+    uint64_t size_;
+    std::vector<uint32_t> distances_;   // In-memory index
+    std::unique_ptr<std::FILE, int (*)(std::FILE*)> file_;   // File-backed index, nullptr if in memory
+    mutable std::mutex file_mutex_;     // Cursors of parallel sweep jobs share file_
+
+    void build(const std::vector<uint64_t>& blocks);
+    void buildSpooled(std::FILE* spool);
+    void readChunk(uint64_t base, std::vector<uint32_t>& chunk) const;
+};
+
+inline uint64_t NextUseIndex::Cursor::nextUse(uint64_t position) {
+    if (position >= index_->size_) {
+        return kNever;
+    }
+    uint32_t distance;
+    if (!index_->file_) {
+        distance = index_->distances_[position];
+    } else {
+        if (position < chunk_base_ || position - chunk_base_ >= chunk_.size()) {
+            load(position);
+        }
+        distance = chunk_[position - chunk_base_];
+    }
+    return distance == 0 ? kNever : position + distance;
+}
+
+#endif // NEXT_USE_INDEX_H
@@ -0,0 +1,176 @@
+#ifndef NONBLOCKING_CACHE_H
+#define NONBLOCKING_CACHE_H
+
+#include "cache.h"
+#include "cache_spec.h"
+#include "cache_statistics.h"
+#include "lower_level.h"
+#include "set_associative_cache.h"
+#include "timing.h"
+#include "trace_reader.h"
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Non-blocking cache with miss status holding registers (MSHRs)
+ *
+ * Replays a timestamped trace against a SetAssociativeCache and models when
+ * each access completes. Accesses issue in trace order at their timestamps,
+ * one per cycle at most, so untimed traces issue one access per cycle:
+ *
+ *   Hit            Completes after the hit latency, also while misses are
+ *                  outstanding (hit-under-miss).
+ *   Primary miss   Allocates an MSHR; the block arrives after the hit latency
+ *                  plus the miss penalty. With every MSHR busy the access
+ *                  stalls until the oldest fill returns. The stall holds the
+ *                  issuing core back, so every later timestamp is delayed by
+ *                  the stalled cycles.
+ *   Secondary miss An access to a block with an outstanding MSHR merges into
+ *                  it and completes when the fill returns.
+ *
+ * Victim and miss cache hits cost TimingModel::kVictimCacheCycles more than
+ * a hit. Stores are buffered: writebacks, write-through stores and
+ * no-write-allocate write misses take no MSHR. Prefetch fills are not timed.
+ *
+ * The tag store is updated when an access is issued, so hit/miss counts
+ * equal those of a blocking run; only timing differs.
+ */
+class NonBlockingCache {
+public:
+    static constexpr size_t kMaxMshrs = 4096;   // Far beyond real caches; bounds the occupancy histogram
+
+    /**
+     * @brief MSHR events
+     */
+    struct MshrCounters {
+        uint64_t primary_misses = 0;     // Misses that allocated an MSHR
+        uint64_t secondary_misses = 0;   // Accesses merged into an outstanding MSHR
+        uint64_t hits_under_miss = 0;    // Hits completed while misses were outstanding
+        uint64_t stalls = 0;             // Misses that waited for a free MSHR
+        uint64_t stall_cycles = 0;       // Cycles spent waiting for a free MSHR
+    };
+
+    /**
+     * @brief Constructor
+     * @param spec Cache configuration, including hit latency and miss penalty
+     * @param mshrs Number of MSHRs
+     * @throws std::invalid_argument if mshrs is zero or above kMaxMshrs, the policy is OPT,
+     *         or the configuration is invalid
+     */
+    NonBlockingCache(const CacheSpec& spec, size_t mshrs);
+
+    NonBlockingCache(const NonBlockingCache&) = delete;
+    NonBlockingCache& operator=(const NonBlockingCache&) = delete;
+
+    /**
+     * @brief Access the cache
+     * @param record Address, operation and timestamp of the access
+     * @return Result in the tag store
+     */
+    Cache::AccessResult access(const TraceRecord& record);
+
+    /**
+     * @brief Access the cache with a batch of trace records
+     * @param records Records in trace order
+     * @param count Number of records
+     */
+    void accessBatch(const TraceRecord* records, size_t count);
+
+    size_t getMshrCount() const { return mshrs_; }
+    const SetAssociativeCache& getCache() const { return *cache_; }
+    CacheStatistics getStatistics() const { return cache_->getStatistics(); }
+    const MshrCounters& getCounters() const { return counters_; }
+
+    /**
+     * @brief Get the latencies of the accesses so far, from issue (before any stall) to completion
+     */
+    const AccessTiming& getTiming() const { return timing_; }
+
+    /**
+     * @brief Get cycles from the first issue until every access completed
+     */
+    uint64_t getElapsedCycles() const;
+
+    /**
+     * @brief Get the cycles spent with each number of busy MSHRs
+     * @return Entry k counts the cycles with k MSHRs busy (mshrs + 1 entries)
+     */
+    std::vector<uint64_t> getOccupancy() const;
+
+    /**
+     * @brief Get the memory-level parallelism
+     * @return Average busy MSHRs over the cycles with at least one busy
+     */
+    double getMLP() const;
+
+    /**
+     * @brief Get the average number of busy MSHRs over all cycles
+     */
+    double getAverageOccupancy() const;
+
+    /**
+     * @brief Get a report of MSHR use and access latencies
+     * @return Report text
+     */
+    std::string getReport() const;
+
+private:
+    /**
+     * @brief Port below the tag store that notes demand fetches
+     */
+    class MemoryPort : public LowerLevel {
+    public:
+        explicit MemoryPort(NonBlockingCache& owner) : owner_(owner) {}
+        bool read(uint64_t) override { owner_.fetched_ = true; return false; }
+        bool prefetch(uint64_t) override { return false; }
+        void write(uint64_t) override {}
+        void evict(uint64_t, bool) override {}
+
+    private:
+        NonBlockingCache& owner_;
+    };
+
+    /**
+     * @brief Outstanding miss
+     */
+    struct Mshr {
+        uint64_t block;   // Block number
+        uint64_t fill;    // Cycle the block arrives
+    };
+
+    std::unique_ptr<SetAssociativeCache> cache_;
+    MemoryPort port_;
+    size_t mshrs_;
+    uint64_t hit_latency_;
+    uint64_t miss_latency_;          // Hit latency plus miss penalty
+    bool write_allocate_;
+
+    // Fills complete in allocation order, so the queue stays sorted by fill cycle
+    std::deque<Mshr> outstanding_;
+    bool started_;
+    bool fetched_;                   // The current access fetched a block
+    uint64_t delay_;                 // Stalled cycles so far, added to later timestamps
+    uint64_t last_issue_;
+    uint64_t first_issue_;
+    uint64_t last_completion_;
+    uint64_t clock_;                 // Cycle up to which occupancy_ is accounted
+    std::vector<uint64_t> occupancy_;
+    MshrCounters counters_;
+    AccessTiming timing_;
+
+    /**
+     * @brief Retire the fills that arrive by a cycle and account occupancy up to it
+     */
+    void advance(uint64_t cycle);
+
+    /**
+     * @brief Find the outstanding MSHR of a block
+     * @return MSHR, or nullptr if the block is not in flight
+     */
+    const Mshr* findMshr(uint64_t block) const;
+};
+
+#endif // NONBLOCKING_CACHE_H
@@ -0,0 +1,187 @@
+#ifndef PREFETCHER_H
+#define PREFETCHER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Abstract base class for hardware prefetchers
+ *
+ * A prefetcher attached to a cache is trained on demand misses and on the
+ * first demand hit to each prefetched block, the usual training stream of
+ * hardware prefetchers. It works on block numbers (address / block size) and
+ * answers with the blocks to fetch; the cache drops blocks it already holds.
+ */
+class Prefetcher {
+public:
+    /**
+     * @brief Virtual destructor
+     */
+    virtual ~Prefetcher() = default;
+
+    /**
+     * @brief Train on a demand access and queue prefetches
+     * @param block Block number of the access
+     * @param prefetches Receives the block numbers to prefetch, nearest first
+     */
+    virtual void train(uint64_t block, std::vector<uint64_t>& prefetches) = 0;
+
+    /**
+     * @brief Reset prefetcher state
+     */
+    virtual void reset() = 0;
+
+    /**
+     * @brief Get prefetcher name
+     * @return Prefetcher name as string
+     */
+    virtual std::string getName() const = 0;
+};
+
+/**
+ * @brief Next-line prefetcher
+ *
+ * Fetches blocks B+distance .. B+distance+degree-1 after an access to block B.
+ * Since first hits on prefetched blocks also train it, a sequential stream
+ * keeps running ahead of the demand accesses (tagged prefetching).
+ */
+class NextLinePrefetcher final : public Prefetcher {
+public:
+    /**
+     * @brief Constructor
+     * @param degree Blocks fetched per trigger
+     * @param distance Offset of the first fetched block
+     */
+    NextLinePrefetcher(size_t degree, size_t distance);
+
+    void train(uint64_t block, std::vector<uint64_t>& prefetches) override;
+    void reset() override {}
+    std::string getName() const override { return "Next-Line"; }
+
+private:
+    size_t degree_;
+    size_t distance_;
+};
+
+/**
+ * @brief Stride prefetcher without instruction addresses
+ *
+ * Traces carry no program counter, so accesses are grouped by 4 KiB region
+ * instead. A direct-mapped table keeps the last block and stride of each
+ * region with a 2-bit confidence counter. Once the stride between consecutive
+ * accesses has repeated twice, an access to block B fetches
+ * B + stride * (distance + i) for i in 0 .. degree-1.
+ */
+class StridePrefetcher final : public Prefetcher {
+public:
+    static constexpr size_t kTableEntries = 64;     // Tracked regions
+    static constexpr size_t kRegionBytes = 4096;    // Bytes per region
+    static constexpr uint8_t kMaxConfidence = 3;
+    static constexpr uint8_t kIssueConfidence = 2;  // Confidence needed to prefetch
+
+    /**
+     * @brief Constructor
+     * @param block_size Block size in bytes
+     * @param degree Blocks fetched per trigger
+     * @param distance Strides between the access and the first fetched block
+     */
+    StridePrefetcher(size_t block_size, size_t degree, size_t distance);
+
+    void train(uint64_t block, std::vector<uint64_t>& prefetches) override;
+    void reset() override;
+    std::string getName() const override { return "Stride"; }
+
+private:
+    struct Entry {
+        uint64_t region = UINT64_MAX;   // Region number, UINT64_MAX when unused
+        uint64_t last_block = 0;
+        int64_t stride = 0;
+        uint8_t confidence = 0;
+    };
+
+    size_t region_shift_;   // log2 of blocks per region
+    size_t degree_;
+    size_t distance_;
+    std::vector<Entry> table_;
+};
+
+/**
+ * @brief Stream prefetcher
+ *
+ * Tracks up to kStreams streams, each started by a miss outside the others'
+ * windows. A second access within kWindow blocks sets the stream's direction;
+ * from then on each access that keeps to it fetches up to degree more blocks,
+ * so that the stream head stays at most distance blocks ahead of the demand
+ * access. Streams are replaced in LRU order.
+ */
+class StreamPrefetcher final : public Prefetcher {
+public:
+    static constexpr size_t kStreams = 16;      // Tracked streams
+    static constexpr uint64_t kWindow = 16;     // Blocks around a stream's last access that belong to it
+
+    /**
+     * @brief Constructor
+     * @param degree Blocks fetched per trigger
+     * @param distance Farthest the stream head runs ahead of demand accesses, in blocks
+     */
+    StreamPrefetcher(size_t degree, size_t distance);
+
+    void train(uint64_t block, std::vector<uint64_t>& prefetches) override;
+    void reset() override;
+    std::string getName() const override { return "Stream"; }
+
+private:
+    struct Stream {
+        bool valid = false;
+        uint64_t last_block = 0;   // Last demand access of the stream
+        uint64_t head = 0;         // Last block fetched, or the start before any fetch
+        int direction = 0;         // +1 ascending, -1 descending, 0 not yet known
+        uint64_t last_use = 0;     // For LRU replacement
+    };
+
+    size_t degree_;
+    size_t distance_;
+    std::vector<Stream> streams_;
+    uint64_t time_;
+};
+
+/**
+ * @brief Factory class for creating prefetchers
+ */
+class PrefetcherFactory {
+public:
+    /**
+     * @brief Prefetcher types
+     */
+    enum class PrefetcherType {
+        NONE,
+        NEXT_LINE,
+        STRIDE,
+        STREAM
+    };
+
+    /**
+     * @brief Create prefetcher
+     * @param type Prefetcher type
+     * @param block_size Block size in bytes
+     * @param degree Blocks fetched per trigger
+     * @param distance How far ahead to fetch; see the prefetcher classes
+     * @return Unique pointer to prefetcher, nullptr for NONE
+     * @throws std::invalid_argument if degree or distance is zero
+     */
+    static std::unique_ptr<Prefetcher> createPrefetcher(
+        PrefetcherType type, size_t block_size, size_t degree, size_t distance);
+
+    /**
+     * @brief Convert string to prefetcher type
+     * @param prefetcher_str Prefetcher string
+     * @return Prefetcher type
+     * @throws std::invalid_argument on an unknown name
+     */
+    static PrefetcherType stringToPrefetcher(const std::string& prefetcher_str);
+};
+
+#endif // PREFETCHER_H
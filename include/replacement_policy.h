@@ -1,9 +1,16 @@
 #ifndef REPLACEMENT_POLICY_H
 #define REPLACEMENT_POLICY_H
 
+#include "block_index.h"
+#include "index_lists.h"
+#include "next_use_index.h"
+#include "way_mask.h"
+#include <algorithm>
 #include <cstdint>
+#include <string>
 #include <vector>
 #include <memory>
+#include <utility>
 
 /**
  * @brief Abstract base class for replacement policies
@@ -18,10 +25,10 @@ public:
     /**
      * @brief Select victim block for replacement
      * @param set_index Set index
-     * @param valid_blocks Vector indicating which blocks are valid
+     * @param valid_blocks Valid bits of the set's ways; all set when the cache evicts
      * @return Index of block to replace
      */
-    virtual size_t selectVictim(size_t set_index, const std::vector<bool>& valid_blocks) = 0;
+    virtual size_t selectVictim(size_t set_index, WayMask valid_blocks) = 0;
 
     /**
      * @brief Update policy state on cache access
@@ -36,17 +43,57 @@ public:
      */
     virtual void reset() = 0;
 
+    /**
+     * @brief True for offline policies that need setTracePosition before every access
+     *
+     * Policies that need the position hide this constant with their own, so the
+     * specialized cache engines skip the call for all other policies.
+     */
+    static constexpr bool kUsesTracePosition = false;
+
+    /**
+     * @brief Tell the policy which trace access the next update belongs to
+     * @param position Zero-based index of the access in the trace
+     */
+    virtual void setTracePosition(uint64_t position) { (void)position; }
+
+    /**
+     * @brief True for policies that need setIncomingBlock before every fill
+     */
+    static constexpr bool kUsesBlockTags = false;
+
+    /**
+     * @brief Tell the policy which block the next fill brings into a set
+     *
+     * Called before selectVictim and the miss update of the fill, so policies
+     * that remember evicted blocks can recognize them when they return.
+     * @param set_index Set index
+     * @param tag Tag of the incoming block
+     */
+    virtual void setIncomingBlock(size_t set_index, uint64_t tag) { (void)set_index; (void)tag; }
+
     /**
      * @brief Get policy name
      * @return Policy name as string
      */
     virtual std::string getName() const = 0;
+
+    /**
+     * @brief Named event counters, in report order
+     */
+    using Counters = std::vector<std::pair<std::string, uint64_t>>;
+
+    /**
+     * @brief Get policy-specific event counters
+     * @return Counters, empty for policies without any
+     */
+    virtual Counters getCounters() const { return {}; }
 };
 
 /**
  * @brief Least Recently Used (LRU) replacement policy
  */
-class LRUPolicy : public ReplacementPolicy {
+class LRUPolicy final : public ReplacementPolicy {
 public:
     /**
      * @brief Constructor
@@ -55,7 +102,7 @@ public:
      */
     LRUPolicy(size_t num_sets, size_t associativity);
 
-    size_t selectVictim(size_t set_index, const std::vector<bool>& valid_blocks) override;
+    size_t selectVictim(size_t set_index, WayMask valid_blocks) override;
     void updateOnAccess(size_t set_index, size_t block_index, bool hit) override;
     void reset() override;
     std::string getName() const override { return "LRU"; }
@@ -63,14 +110,48 @@ public:
 private:
     size_t num_sets_;
     size_t associativity_;
-    std::vector<std::vector<uint64_t>> access_order_; // Access order for each set
+    std::vector<uint64_t> access_order_; // Last access time, indexed as set * associativity + way
     uint64_t global_time_;
 };
 
+/**
+ * @brief True LRU with an intrusive recency list per set
+ *
+ * Each set keeps its ways in a doubly-linked list ordered from most to least
+ * recently used, stored as prev/next way arrays. Hits and fills move a way to
+ * the head and the victim is the tail, all in O(1). The factory uses this for
+ * PolicyType::LRU above kListThreshold ways, where LRUPolicy's timestamp scan
+ * dominates; the replacement decisions are identical.
+ */
+class ListLRUPolicy final : public ReplacementPolicy {
+public:
+    static constexpr size_t kListThreshold = 64;   // Associativity above which the factory picks this
+
+    /**
+     * @brief Constructor
+     * @param num_sets Number of sets in cache
+     * @param associativity Associativity of cache
+     */
+    ListLRUPolicy(size_t num_sets, size_t associativity);
+
+    size_t selectVictim(size_t set_index, WayMask valid_blocks) override;
+    void updateOnAccess(size_t set_index, size_t block_index, bool hit) override;
+    void reset() override;
+    std::string getName() const override { return "LRU"; }
+
+private:
+    size_t num_sets_;
+    size_t associativity_;
+    std::vector<uint32_t> prev_;   // Toward the head (more recent), indexed as set * associativity + way
+    std::vector<uint32_t> next_;   // Toward the tail (less recent)
+    std::vector<uint32_t> head_;   // Most recently used way per set
+    std::vector<uint32_t> tail_;   // Least recently used way per set
+};
+
 /**
  * @brief First In First Out (FIFO) replacement policy
  */
-class FIFOPolicy : public ReplacementPolicy {
+class FIFOPolicy final : public ReplacementPolicy {
 public:
     /**
      * @brief Constructor
@@ -79,7 +160,7 @@ public:
      */
     FIFOPolicy(size_t num_sets, size_t associativity);
 
-    size_t selectVictim(size_t set_index, const std::vector<bool>& valid_blocks) override;
+    size_t selectVictim(size_t set_index, WayMask valid_blocks) override;
     void updateOnAccess(size_t set_index, size_t block_index, bool hit) override;
     void reset() override;
     std::string getName() const override { return "FIFO"; }
@@ -87,30 +168,391 @@ public:
 private:
     size_t num_sets_;
     size_t associativity_;
-    std::vector<std::vector<uint64_t>> insertion_order_; // Insertion order for each set
+    std::vector<uint64_t> insertion_order_; // Insertion time, indexed as set * associativity + way
     uint64_t global_time_;
 };
 
 /**
  * @brief Random replacement policy
+ *
+ * Each instance owns a xoshiro256** generator seeded through splitmix64, so a
+ * given seed always reproduces the same victims and caches on different
+ * threads share no state. reset() restarts the sequence from the seed. A
+ * victim takes a single draw, mapped onto the valid ways by multiplication
+ * instead of a rejection loop.
  */
-class RandomPolicy : public ReplacementPolicy {
+class RandomPolicy final : public ReplacementPolicy {
 public:
+    static constexpr uint64_t kDefaultSeed = 1;
+
     /**
      * @brief Constructor
      * @param num_sets Number of sets in cache
      * @param associativity Associativity of cache
+     * @param seed Generator seed
      */
-    RandomPolicy(size_t num_sets, size_t associativity);
+    RandomPolicy(size_t num_sets, size_t associativity, uint64_t seed = kDefaultSeed);
 
-    size_t selectVictim(size_t set_index, const std::vector<bool>& valid_blocks) override;
+    size_t selectVictim(size_t set_index, WayMask valid_blocks) override;
     void updateOnAccess(size_t set_index, size_t block_index, bool hit) override;
     void reset() override;
     std::string getName() const override { return "Random"; }
 
+    uint64_t getSeed() const { return seed_; }
+
+private:
+    size_t num_sets_;
+    size_t associativity_;
+    uint64_t seed_;
+    uint64_t state_[4];     // xoshiro256** state
+
+    uint64_t next() {
+        uint64_t result = rotl(state_[1] * 5, 7) * 9;
+        uint64_t t = state_[1] << 17;
+        state_[2] ^= state_[0];
+        state_[3] ^= state_[1];
+        state_[1] ^= state_[2];
+        state_[0] ^= state_[3];
+        state_[2] ^= t;
+        state_[3] = rotl(state_[3], 45);
+        return result;
+    }
+
+    // Uniform value in [0, bound) from the high bits of a 64x64 product
+    size_t below(size_t bound) {
+        return static_cast<size_t>((static_cast<unsigned __int128>(next()) * bound) >> 64);
+    }
+
+    static uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+};
+
+/**
+ * @brief Tree pseudo-LRU replacement policy
+ *
+ * Each set keeps a binary tree of direction bits over its ways, stored
+ * heap-ordered (node n has children 2n and 2n+1) in a packed bit vector.
+ * An access flips the bits on the path to its way to point away from it;
+ * the victim is found by following the bits from the root. Both take
+ * log2(ways) steps. Non-power-of-two associativities use the next power of
+ * two and never descend into subtrees without real ways.
+ */
+class TreePLRUPolicy final : public ReplacementPolicy {
+public:
+    /**
+     * @brief Constructor
+     * @param num_sets Number of sets in cache
+     * @param associativity Associativity of cache
+     */
+    TreePLRUPolicy(size_t num_sets, size_t associativity);
+
+    size_t selectVictim(size_t set_index, WayMask valid_blocks) override;
+    void updateOnAccess(size_t set_index, size_t block_index, bool hit) override;
+    void reset() override;
+    std::string getName() const override { return "Tree-PLRU"; }
+
+private:
+    size_t num_sets_;
+    size_t associativity_;
+    size_t leaves_;           // Associativity rounded up to a power of two
+    size_t levels_;           // log2(leaves_)
+    size_t words_per_set_;    // 64-bit words holding the leaves_ node bits of a set
+    std::vector<uint64_t> tree_bits_;
+};
+
+/**
+ * @brief Bit pseudo-LRU (MRU-bit) replacement policy
+ *
+ * Each way has one bit that is set when it is accessed. When the last clear
+ * bit of a set would be set, all other bits are cleared. The victim is the
+ * first way whose bit is clear.
+ */
+class BitPLRUPolicy final : public ReplacementPolicy {
+public:
+    /**
+     * @brief Constructor
+     * @param num_sets Number of sets in cache
+     * @param associativity Associativity of cache
+     */
+    BitPLRUPolicy(size_t num_sets, size_t associativity);
+
+    size_t selectVictim(size_t set_index, WayMask valid_blocks) override;
+    void updateOnAccess(size_t set_index, size_t block_index, bool hit) override;
+    void reset() override;
+    std::string getName() const override { return "Bit-PLRU"; }
+
 private:
     size_t num_sets_;
     size_t associativity_;
+    size_t words_per_set_;    // 64-bit words holding the MRU bits of a set
+    std::vector<uint64_t> mru_bits_;
+};
+
+/**
+ * @brief Re-reference interval prediction (SRRIP, BRRIP and DRRIP)
+ *
+ * Every block carries a 2-bit re-reference prediction value (RRPV); 0 means
+ * re-reference expected soon, 3 means distant. Hits promote a block to 0.
+ * The victim is the first block at 3, after aging all blocks of the set
+ * until one gets there. Fills are inserted at
+ *
+ *   STATIC (SRRIP)   2, so scans age out before blocks that were reused
+ *   BIMODAL (BRRIP)  3, and 2 on every kBimodalPeriod-th fill
+ *   DYNAMIC (DRRIP)  SRRIP or BRRIP, chosen by set dueling: a few leader sets
+ *                    always use one of them and their misses move a
+ *                    saturating PSEL counter; the follower sets use whichever
+ *                    side currently misses less
+ *
+ * Leader sets are one pair in every max(4, num_sets / kLeaderSets) sets, so
+ * at least half of the sets follow once there are four or more. Smaller
+ * caches have fewer followers: with three sets one follows, with two both
+ * sets are leaders and none follows, and a single set (fully associative)
+ * is an SRRIP leader, so DRRIP behaves like SRRIP there.
+ */
+class RRIPPolicy final : public ReplacementPolicy {
+public:
+    enum class Mode {
+        STATIC,
+        BIMODAL,
+        DYNAMIC
+    };
+
+    static constexpr uint8_t kMaxRRPV = 3;          // 2-bit prediction values
+    static constexpr uint32_t kBimodalPeriod = 32;  // BRRIP inserts at kMaxRRPV - 1 once per period
+    static constexpr size_t kLeaderSets = 32;       // Leader sets per dueling side in large caches
+    static constexpr uint32_t kPselMax = 1023;      // 10-bit policy selector
+
+    /**
+     * @brief Constructor
+     * @param num_sets Number of sets in cache
+     * @param associativity Associativity of cache
+     * @param mode Insertion policy
+     */
+    RRIPPolicy(size_t num_sets, size_t associativity, Mode mode);
+
+    size_t selectVictim(size_t set_index, WayMask valid_blocks) override;
+    void updateOnAccess(size_t set_index, size_t block_index, bool hit) override;
+    void reset() override;
+    std::string getName() const override;
+    Counters getCounters() const override;
+
+    Mode getMode() const { return mode_; }
+    uint32_t getPsel() const { return psel_; }
+    uint8_t getRRPV(size_t set_index, size_t block_index) const { return rrpv_[set_index * associativity_ + block_index]; }
+
+private:
+    size_t num_sets_;
+    size_t associativity_;
+    Mode mode_;
+    size_t dueling_period_;         // Sets per leader pair
+    std::vector<uint8_t> rrpv_;     // Indexed as set * associativity + way
+    uint32_t bimodal_count_;
+    uint32_t psel_;                 // High: SRRIP leaders miss more, followers use BRRIP
+
+    // Event counters
+    uint64_t long_fills_;           // Inserted at kMaxRRPV - 1
+    uint64_t distant_fills_;        // Inserted at kMaxRRPV
+    uint64_t srrip_leader_misses_;
+    uint64_t brrip_leader_misses_;
+    uint64_t srrip_follower_fills_;
+    uint64_t brrip_follower_fills_;
+
+    uint8_t bimodalInsertion() {
+        return (++bimodal_count_ % kBimodalPeriod == 0) ? kMaxRRPV - 1 : kMaxRRPV;
+    }
+};
+
+/**
+ * @brief Least Frequently Used replacement with frequency buckets and aging
+ *
+ * Each set keeps one list per access count from 1 to kMaxFrequency, ordered by
+ * recency, plus a bitmask of the non-empty lists. A hit moves the block to the
+ * front of the next list. The victim is the least recently used block of the
+ * lowest non-empty list, found with one count-trailing-zeros. Every
+ * kAgingPeriod * associativity accesses to a set halve the counts of its
+ * blocks, so formerly hot blocks can age out. Aging is O(ways) but rare, which
+ * keeps the amortized cost O(1) per access.
+ */
+class LFUPolicy final : public ReplacementPolicy {
+public:
+    static constexpr uint32_t kMaxFrequency = 15;   // Saturating 4-bit counts
+    static constexpr uint32_t kAgingPeriod = 8;     // Set accesses per way between agings
+
+    /**
+     * @brief Constructor
+     * @param num_sets Number of sets in cache
+     * @param associativity Associativity of cache
+     */
+    LFUPolicy(size_t num_sets, size_t associativity);
+
+    size_t selectVictim(size_t set_index, WayMask valid_blocks) override;
+    void updateOnAccess(size_t set_index, size_t block_index, bool hit) override;
+    void reset() override;
+    std::string getName() const override { return "LFU"; }
+    Counters getCounters() const override;
+
+    uint32_t getFrequency(size_t set_index, size_t block_index) const { return frequency_[set_index * associativity_ + block_index]; }
+
+private:
+    size_t num_sets_;
+    size_t associativity_;
+    IndexLists lists_;                          // Nodes are set * associativity + way
+    std::vector<IndexLists::List> buckets_;     // Indexed as set * (kMaxFrequency + 1) + count
+    std::vector<uint32_t> occupied_;            // Per set: bit f set if bucket f is non-empty
+    std::vector<uint8_t> frequency_;            // Per block: access count, 0 if in no bucket
+    std::vector<uint32_t> set_accesses_;        // Per set: accesses since the last aging
+    uint64_t agings_;
+
+    IndexLists::List& bucket(size_t set_index, uint32_t count) {
+        return buckets_[set_index * (kMaxFrequency + 1) + count];
+    }
+    void place(size_t set_index, uint32_t node, uint32_t count);
+    void unplace(size_t set_index, uint32_t node);
+    void age(size_t set_index);
+};
+
+/**
+ * @brief Adaptive Replacement Cache (ARC) applied to each set
+ *
+ * Each set splits its blocks into T1 (seen once recently) and T2 (seen at least
+ * twice), both in LRU order. Ghost lists B1 and B2 keep the tags of blocks
+ * recently evicted from T1 and T2. A miss on a B1 ghost shows that T1 was too
+ * small and raises the target size p of T1. A miss on a B2 ghost lowers p.
+ * Victims come from T1 while it is larger than p and from T2 otherwise.
+ * Ghosts are found through a hash index, so hits, fills and victim choice take
+ * O(1) time at any associativity.
+ *
+ * The cache reports incoming tags through setIncomingBlock; fills without it
+ * are treated as new blocks.
+ */
+class ARCPolicy final : public ReplacementPolicy {
+public:
+    static constexpr bool kUsesBlockTags = true;
+
+    /**
+     * @brief Constructor
+     * @param num_sets Number of sets in cache
+     * @param associativity Associativity of cache
+     */
+    ARCPolicy(size_t num_sets, size_t associativity);
+
+    size_t selectVictim(size_t set_index, WayMask valid_blocks) override;
+    void updateOnAccess(size_t set_index, size_t block_index, bool hit) override;
+    void setIncomingBlock(size_t set_index, uint64_t tag) override;
+    void reset() override;
+    std::string getName() const override { return "ARC"; }
+    Counters getCounters() const override;
+
+    /**
+     * @brief Get the current T1 target size of a set
+     */
+    uint32_t getTarget(size_t set_index) const { return sets_[set_index].target; }
+
+    /**
+     * @brief Get the sizes of T1, T2, B1 and B2 of a set
+     */
+    std::vector<uint32_t> getListSizes(size_t set_index) const {
+        const SetState& state = sets_[set_index];
+        return {state.t1.size, state.t2.size, state.b1.size, state.b2.size};
+    }
+
+private:
+    enum ListId : uint8_t { NONE, T1, T2, B1, B2 };
+    enum class Incoming : uint8_t { NEW, GHOST_B1, GHOST_B2 };
+
+    struct SetState {
+        IndexLists::List t1, t2;      // Resident ways
+        IndexLists::List b1, b2;      // Ghost nodes
+        IndexLists::List free_ghosts; // Unused ghost nodes of the set
+        uint32_t target = 0;          // p: target size of T1
+    };
+
+    size_t num_sets_;
+    size_t associativity_;
+    std::vector<SetState> sets_;
+    IndexLists way_lists_;          // Nodes are set * associativity + way
+    IndexLists ghost_lists_;        // Nodes are set * associativity + ghost
+    std::vector<uint8_t> way_list_; // ListId per way
+    std::vector<uint64_t> way_tag_;
+    std::vector<uint8_t> ghost_list_;
+    std::vector<uint64_t> ghost_tag_;
+    BlockIndex ghost_index_;        // ghostKey -> ghost node
+
+    // The fill announced by setIncomingBlock
+    bool pending_ = false;
+    size_t pending_set_ = 0;
+    uint64_t pending_tag_ = 0;
+    Incoming pending_kind_ = Incoming::NEW;
+    bool discard_t1_ = false;       // T1 fills the whole set and B1 is empty: drop T1's LRU untracked
+
+    uint64_t ghost_hits_b1_;
+    uint64_t ghost_hits_b2_;
+    uint64_t t1_evictions_;
+    uint64_t t2_evictions_;
+
+    uint64_t ghostKey(size_t set_index, uint64_t tag) const { return tag * num_sets_ + set_index; }
+    IndexLists::List& wayList(SetState& state, uint8_t id) { return id == T1 ? state.t1 : state.t2; }
+    void dropGhost(size_t set_index, uint32_t ghost);
+    void addGhost(size_t set_index, uint8_t id, uint64_t tag);
+};
+
+/**
+ * @brief Belady's optimal (OPT) offline replacement
+ *
+ * Evicts the block whose next access lies farthest in the future, which gives
+ * the lowest miss count any replacement policy can reach without bypassing
+ * fills. The future comes from a NextUseIndex built from the same trace in a
+ * first pass. The cache reports the position of every access through
+ * setTracePosition, and every hit or fill stores the block's next use. Each set
+ * keeps its ways in a binary max-heap keyed on that position, so victims cost
+ * O(1) and updates O(log ways).
+ *
+ * Results are exact only while the cache sees the indexed trace from its first
+ * access, one access per position, as in cache_simulator runs and sweeps.
+ */
+class BeladyPolicy final : public ReplacementPolicy {
+public:
+    static constexpr bool kUsesTracePosition = true;
+
+    /**
+     * @brief Constructor
+     * @param num_sets Number of sets in cache
+     * @param associativity Associativity of cache
+     * @param next_use Next-use index of the trace to be simulated
+     * @throws std::invalid_argument if next_use is null
+     */
+    BeladyPolicy(size_t num_sets, size_t associativity, std::shared_ptr<const NextUseIndex> next_use);
+
+    size_t selectVictim(size_t set_index, WayMask valid_blocks) override;
+    void updateOnAccess(size_t set_index, size_t block_index, bool hit) override;
+    void setTracePosition(uint64_t position) override { position_ = position; }
+    void reset() override;
+    std::string getName() const override { return "OPT"; }
+
+    const NextUseIndex& getNextUseIndex() const { return *next_use_; }
+
+    /**
+     * @brief Get the next use of a block as recorded at its latest access
+     * @return Trace position, NextUseIndex::kNever if it is not used again
+     */
+    uint64_t getNextUse(size_t set_index, size_t block_index) const { return next_use_of_[set_index * associativity_ + block_index]; }
+
+private:
+    size_t num_sets_;
+    size_t associativity_;
+    std::shared_ptr<const NextUseIndex> next_use_;
+    NextUseIndex::Cursor cursor_;
+    uint64_t position_;
+    std::vector<uint64_t> next_use_of_;   // Heap key per block, indexed as set * associativity + way
+    std::vector<uint32_t> heap_;          // Per set: ways in max-heap order of next use
+    std::vector<uint32_t> heap_slot_;     // Per block: its index within the set's heap
+
+    void siftUp(size_t set_index, size_t slot);
+    void siftDown(size_t set_index, size_t slot);
+    void swapSlots(uint32_t* heap, size_t base, size_t a, size_t b) {
+        std::swap(heap[a], heap[b]);
+        heap_slot_[base + heap[a]] = static_cast<uint32_t>(a);
+        heap_slot_[base + heap[b]] = static_cast<uint32_t>(b);
+    }
 };
 
 /**
@@ -124,7 +566,15 @@ public:
     enum class PolicyType {
         LRU,
         FIFO,
-        RANDOM
+        RANDOM,
+        TREE_PLRU,
+        BIT_PLRU,
+        SRRIP,
+        BRRIP,
+        DRRIP,
+        OPT,
+        LFU,
+        ARC
     };
 
     /**
@@ -132,10 +582,15 @@ public:
      * @param type Policy type
      * @param num_sets Number of sets in cache
      * @param associativity Associativity of cache
+     * @param next_use Next-use index of the trace, required by OPT only
+     * @param seed Generator seed of RANDOM
      * @return Unique pointer to replacement policy
+     * @throws std::invalid_argument for OPT without a next-use index
      */
     static std::unique_ptr<ReplacementPolicy> createPolicy(
-        PolicyType type, size_t num_sets, size_t associativity);
+        PolicyType type, size_t num_sets, size_t associativity,
+        std::shared_ptr<const NextUseIndex> next_use = nullptr,
+        uint64_t seed = RandomPolicy::kDefaultSeed);
 
     /**
      * @brief Convert string to policy type
@@ -143,6 +598,381 @@ public:
      * @return Policy type
      */
     static PolicyType stringToPolicy(const std::string& policy_str);
+
+    /**
+     * @brief Invoke a visitor with the concrete type of a policy
+     *
+     * Lets callers pick a policy-specialized instantiation at runtime. Unknown
+     * policy types are passed as the ReplacementPolicy base.
+     * @param policy Policy to inspect
+     * @param visitor Generic callable taking the policy by reference
+     * @return Whatever the visitor returns
+     */
+    template <typename Visitor>
+    static decltype(auto) visit(ReplacementPolicy& policy, Visitor&& visitor) {
+        if (auto* lru = dynamic_cast<LRUPolicy*>(&policy)) {
+            return visitor(*lru);
+        }
+        if (auto* list_lru = dynamic_cast<ListLRUPolicy*>(&policy)) {
+            return visitor(*list_lru);
+        }
+        if (auto* fifo = dynamic_cast<FIFOPolicy*>(&policy)) {
+            return visitor(*fifo);
+        }
+        if (auto* random = dynamic_cast<RandomPolicy*>(&policy)) {
+            return visitor(*random);
+        }
+        if (auto* tree_plru = dynamic_cast<TreePLRUPolicy*>(&policy)) {
+            return visitor(*tree_plru);
+        }
+        if (auto* bit_plru = dynamic_cast<BitPLRUPolicy*>(&policy)) {
+            return visitor(*bit_plru);
+        }
+        if (auto* rrip = dynamic_cast<RRIPPolicy*>(&policy)) {
+            return visitor(*rrip);
+        }
+        if (auto* belady = dynamic_cast<BeladyPolicy*>(&policy)) {
+            return visitor(*belady);
+        }
+        if (auto* lfu = dynamic_cast<LFUPolicy*>(&policy)) {
+            return visitor(*lfu);
+        }
+        if (auto* arc = dynamic_cast<ARCPolicy*>(&policy)) {
+            return visitor(*arc);
+        }
+        return visitor(policy);
+    }
 };
 
+// Hot-path methods of the concrete policies are defined inline so the
+// policy-specialized cache engine can inline them into its access loop.
+
+inline size_t LRUPolicy::selectVictim(size_t set_index, WayMask valid_blocks) {
+    const uint64_t* order = &access_order_[set_index * associativity_];
+    size_t oldest_block_index = 0;
+    uint64_t oldest_time = order[0];
+    for (size_t i = 1; i < associativity_; ++i) {
+        if (valid_blocks[i] && order[i] < oldest_time) {
+            oldest_time = order[i];
+            oldest_block_index = i;
+        }
+    }
+    return oldest_block_index;
+}
+
+inline void LRUPolicy::updateOnAccess(size_t set_index, size_t block_index, bool /*hit*/) {
+    access_order_[set_index * associativity_ + block_index] = ++global_time_;
+}
+
+inline size_t ListLRUPolicy::selectVictim(size_t set_index, WayMask valid_blocks) {
+    const uint32_t* prev = &prev_[set_index * associativity_];
+    // The tail is the victim; invalid ways are only passed over with holes in the set
+    uint32_t way = tail_[set_index];
+    while (!valid_blocks[way] && prev[way] != way) {
+        way = prev[way];
+    }
+    return way;
+}
+
+inline void ListLRUPolicy::updateOnAccess(size_t set_index, size_t block_index, bool /*hit*/) {
+    uint32_t way = static_cast<uint32_t>(block_index);
+    uint32_t& head = head_[set_index];
+    if (head == way) return;
+    
+    uint32_t* prev = &prev_[set_index * associativity_];
+    uint32_t* next = &next_[set_index * associativity_];
+    uint32_t& tail = tail_[set_index];
+    
+    // Unlink (way is not the head, so it has a predecessor)
+    next[prev[way]] = next[way];
+    if (tail == way) {
+        tail = prev[way];
+    } else {
+        prev[next[way]] = prev[way];
+    }
+    
+    // Push at the head; the head's prev points at itself
+    next[way] = head;
+    prev[head] = way;
+    prev[way] = way;
+    head = way;
+}
+
+inline size_t FIFOPolicy::selectVictim(size_t set_index, WayMask valid_blocks) {
+    const uint64_t* order = &insertion_order_[set_index * associativity_];
+    size_t first_in_block_index = 0;
+    uint64_t first_in_time = order[0];
+    for (size_t i = 1; i < associativity_; ++i) {
+        if (valid_blocks[i] && order[i] < first_in_time) {
+            first_in_time = order[i];
+            first_in_block_index = i;
+        }
+    }
+    return first_in_block_index;
+}
+
+inline void FIFOPolicy::updateOnAccess(size_t set_index, size_t block_index, bool hit) {
+    if (!hit) {
+        insertion_order_[set_index * associativity_ + block_index] = ++global_time_;
+    }
+}
+
+inline size_t RandomPolicy::selectVictim(size_t /*set_index*/, WayMask valid_blocks) {
+    size_t victim = below(associativity_);
+    if (valid_blocks[victim]) {
+        return victim;
+    }
+    
+    // Holes in the set: draw the rank of the victim among the valid ways
+    size_t valid = valid_blocks.count();
+    if (valid == 0) {
+        return victim;
+    }
+    return valid_blocks.nthValid(below(valid));
+}
+
+inline void RandomPolicy::updateOnAccess(size_t /*set_index*/, size_t /*block_index*/, bool /*hit*/) {
+    // No state to update for random policy
+}
+
+inline size_t TreePLRUPolicy::selectVictim(size_t set_index, WayMask valid_blocks) {
+    const uint64_t* bits = &tree_bits_[set_index * words_per_set_];
+    size_t node = 1;
+    for (size_t level = 1; level <= levels_; ++level) {
+        size_t child = 2 * node + ((bits[node >> 6] >> (node & 63)) & 1);
+        // Leftmost way under the child; skip padding subtrees past the last way
+        if ((child << (levels_ - level)) - leaves_ >= associativity_) {
+            child &= ~size_t(1);
+        }
+        node = child;
+    }
+    size_t victim = node - leaves_;
+    if (!valid_blocks[victim]) {
+        // Only reachable with holes in the set; any invalid way will do
+        victim = valid_blocks.firstInvalid();
+    }
+    return victim;
+}
+
+inline void TreePLRUPolicy::updateOnAccess(size_t set_index, size_t block_index, bool /*hit*/) {
+    uint64_t* bits = &tree_bits_[set_index * words_per_set_];
+    for (size_t node = leaves_ + block_index; node > 1; node >>= 1) {
+        size_t parent = node >> 1;
+        uint64_t mask = 1ULL << (parent & 63);
+        // Point the parent at the sibling subtree
+        if (node & 1) {
+            bits[parent >> 6] &= ~mask;
+        } else {
+            bits[parent >> 6] |= mask;
+        }
+    }
+}
+
+inline size_t BitPLRUPolicy::selectVictim(size_t set_index, WayMask valid_blocks) {
+    const uint64_t* bits = &mru_bits_[set_index * words_per_set_];
+    for (size_t word = 0; word < words_per_set_; ++word) {
+        // Valid ways without their MRU bit; the lowest one is the victim
+        uint64_t candidates = ~bits[word] & valid_blocks.words()[word];
+        if (candidates != 0) {
+            size_t way = word * 64 + static_cast<size_t>(__builtin_ctzll(candidates));
+            return way < associativity_ ? way : 0;
+        }
+    }
+    return 0;
+}
+
+inline void BitPLRUPolicy::updateOnAccess(size_t set_index, size_t block_index, bool /*hit*/) {
+    uint64_t* bits = &mru_bits_[set_index * words_per_set_];
+    bits[block_index >> 6] |= 1ULL << (block_index & 63);
+    
+    // All ways recently used: start a new epoch with only this way marked
+    size_t last = words_per_set_ - 1;
+    uint64_t last_mask = (associativity_ % 64 == 0) ? ~0ULL : (1ULL << (associativity_ % 64)) - 1;
+    for (size_t word = 0; word < last; ++word) {
+        if (bits[word] != ~0ULL) return;
+    }
+    if ((bits[last] & last_mask) != last_mask) return;
+    for (size_t word = 0; word <= last; ++word) {
+        bits[word] = 0;
+    }
+    bits[block_index >> 6] = 1ULL << (block_index & 63);
+}
+
+inline size_t RRIPPolicy::selectVictim(size_t set_index, WayMask valid_blocks) {
+    uint8_t* rrpv = &rrpv_[set_index * associativity_];
+    
+    // Aging until some block reaches kMaxRRPV is one step by the oldest block's distance
+    uint8_t oldest = 0;
+    for (size_t i = 0; i < associativity_; ++i) {
+        if (valid_blocks[i] && rrpv[i] > oldest) {
+            oldest = rrpv[i];
+        }
+    }
+    uint8_t age = kMaxRRPV - oldest;
+    size_t victim = associativity_;
+    for (size_t i = 0; i < associativity_; ++i) {
+        if (!valid_blocks[i]) continue;
+        rrpv[i] = static_cast<uint8_t>(rrpv[i] + age);
+        if (victim == associativity_ && rrpv[i] == kMaxRRPV) {
+            victim = i;
+        }
+    }
+    return victim == associativity_ ? 0 : victim;
+}
+
+inline void RRIPPolicy::updateOnAccess(size_t set_index, size_t block_index, bool hit) {
+    uint8_t& rrpv = rrpv_[set_index * associativity_ + block_index];
+    if (hit) {
+        rrpv = 0;
+        return;
+    }
+    
+    switch (mode_) {
+        case Mode::STATIC:
+            rrpv = kMaxRRPV - 1;
+            break;
+        case Mode::BIMODAL:
+            rrpv = bimodalInsertion();
+            break;
+        case Mode::DYNAMIC: {
+            size_t role = set_index % dueling_period_;
+            if (role == 0) {
+                srrip_leader_misses_++;
+                psel_ = psel_ < kPselMax ? psel_ + 1 : psel_;
+                rrpv = kMaxRRPV - 1;
+            } else if (role == 1) {
+                brrip_leader_misses_++;
+                psel_ = psel_ > 0 ? psel_ - 1 : psel_;
+                rrpv = bimodalInsertion();
+            } else if (psel_ > kPselMax / 2) {
+                brrip_follower_fills_++;
+                rrpv = bimodalInsertion();
+            } else {
+                srrip_follower_fills_++;
+                rrpv = kMaxRRPV - 1;
+            }
+            break;
+        }
+    }
+    
+    if (rrpv == kMaxRRPV) {
+        distant_fills_++;
+    } else {
+        long_fills_++;
+    }
+}
+
+inline void LFUPolicy::place(size_t set_index, uint32_t node, uint32_t count) {
+    frequency_[node] = static_cast<uint8_t>(count);
+    lists_.pushFront(bucket(set_index, count), node);
+    occupied_[set_index] |= 1u << count;
+}
+
+inline void LFUPolicy::unplace(size_t set_index, uint32_t node) {
+    uint32_t count = frequency_[node];
+    IndexLists::List& list = bucket(set_index, count);
+    lists_.remove(list, node);
+    if (list.size == 0) {
+        occupied_[set_index] &= ~(1u << count);
+    }
+    frequency_[node] = 0;
+}
+
+inline size_t LFUPolicy::selectVictim(size_t set_index, WayMask valid_blocks) {
+    uint32_t occupied = occupied_[set_index];
+    if (occupied == 0) {
+        return 0;
+    }
+    uint32_t node = bucket(set_index, static_cast<uint32_t>(__builtin_ctz(occupied))).back;
+    size_t base = set_index * associativity_;
+    if (valid_blocks[node - base]) {
+        return node - base;
+    }
+    
+    // Only reached with a partially valid mask; take the least frequent valid block
+    for (uint32_t count = 1; count <= kMaxFrequency; ++count) {
+        for (uint32_t n = bucket(set_index, count).front; n != IndexLists::kNil; n = lists_.next(n)) {
+            if (valid_blocks[n - base]) return n - base;
+        }
+    }
+    return node - base;
+}
+
+inline void LFUPolicy::updateOnAccess(size_t set_index, size_t block_index, bool hit) {
+    uint32_t node = static_cast<uint32_t>(set_index * associativity_ + block_index);
+    uint32_t count = frequency_[node];
+    if (count != 0) {
+        unplace(set_index, node);
+    }
+    // A fill replaces whatever the way held before, so it starts over at 1
+    place(set_index, node, hit ? std::min(count + 1, kMaxFrequency) : 1);
+    
+    if (++set_accesses_[set_index] >= kAgingPeriod * associativity_) {
+        age(set_index);
+    }
+}
+
+inline size_t BeladyPolicy::selectVictim(size_t set_index, WayMask valid_blocks) {
+    size_t victim = heap_[set_index * associativity_];
+    if (valid_blocks[victim]) {
+        return victim;
+    }
+    
+    // Only reached with a partially valid mask; fall back to a scan
+    victim = 0;
+    uint64_t farthest = 0;
+    for (size_t i = 0; i < associativity_; ++i) {
+        uint64_t next = next_use_of_[set_index * associativity_ + i];
+        if (valid_blocks[i] && next >= farthest) {
+            farthest = next;
+            victim = i;
+        }
+    }
+    return victim;
+}
+
+inline void BeladyPolicy::updateOnAccess(size_t set_index, size_t block_index, bool hit) {
+    (void)hit;
+    size_t base = set_index * associativity_;
+    uint64_t& key = next_use_of_[base + block_index];
+    uint64_t next = cursor_.nextUse(position_);
+    if (next > key) {
+        key = next;
+        siftUp(set_index, heap_slot_[base + block_index]);
+    } else {
+        key = next;
+        siftDown(set_index, heap_slot_[base + block_index]);
+    }
+}
+
+inline void BeladyPolicy::siftUp(size_t set_index, size_t slot) {
+    size_t base = set_index * associativity_;
+    uint32_t* heap = &heap_[base];
+    while (slot > 0) {
+        size_t parent = (slot - 1) / 2;
+        if (next_use_of_[base + heap[parent]] >= next_use_of_[base + heap[slot]]) break;
+        swapSlots(heap, base, parent, slot);
+        slot = parent;
+    }
+}
+
+inline void BeladyPolicy::siftDown(size_t set_index, size_t slot) {
+    size_t base = set_index * associativity_;
+    uint32_t* heap = &heap_[base];
+    while (true) {
+        size_t largest = slot;
+        size_t left = 2 * slot + 1;
+        size_t right = left + 1;
+        if (left < associativity_ && next_use_of_[base + heap[left]] > next_use_of_[base + heap[largest]]) {
+            largest = left;
+        }
+        if (right < associativity_ && next_use_of_[base + heap[right]] > next_use_of_[base + heap[largest]]) {
+            largest = right;
+        }
+        if (largest == slot) break;
+        swapSlots(heap, base, slot, largest);
+        slot = largest;
+    }
+}
+
 #endif // REPLACEMENT_POLICY_H
@@ -4,6 +4,12 @@
 #include "cache.h"
 #include "cache_statistics.h"
 #include "replacement_policy.h"
+#include "block_data_store.h"
+#include "block_index.h"
+#include "tag_lookup.h"
+#include "lower_level.h"
+#include "prefetcher.h"
+#include "victim_cache.h"
 #include <vector>
 #include <memory>
 
@@ -14,10 +20,10 @@ struct CacheBlock {
     bool valid;          // Valid bit
     bool dirty;          // Dirty bit (for write-back policy)
     uint64_t tag;        // Tag bits
-    std::vector<uint8_t> data; // Block data (optional for simulation)
+    std::vector<uint8_t> data; // Block data (empty unless the cache tracks data)
 
-    CacheBlock(size_t block_size = 0) 
-        : valid(false), dirty(false), tag(0), data(block_size, 0) {}
+    CacheBlock() 
+        : valid(false), dirty(false), tag(0) {}
 };
 
 /**
@@ -41,6 +47,14 @@ public:
         NO_WRITE_ALLOCATE
     };
 
+    /**
+     * @brief Block payload mode
+     */
+    enum class DataMode {
+        TAG_ONLY,    // Only tag metadata is simulated
+        TRACK_DATA   // Block payloads are kept in an arena-backed data store
+    };
+
     /**
      * @brief Constructor
      * @param cache_size Total cache size in bytes
@@ -49,6 +63,7 @@ public:
      * @param replacement_policy Replacement policy
      * @param write_policy Write policy
      * @param write_miss_policy Write miss policy
+     * @param data_mode Whether block payloads are stored
      */
     SetAssociativeCache(
         size_t cache_size,
@@ -56,7 +71,8 @@ public:
         size_t associativity,
         std::unique_ptr<ReplacementPolicy> replacement_policy,
         WritePolicy write_policy = WritePolicy::WRITE_THROUGH,
-        WriteMissPolicy write_miss_policy = WriteMissPolicy::WRITE_ALLOCATE
+        WriteMissPolicy write_miss_policy = WriteMissPolicy::WRITE_ALLOCATE,
+        DataMode data_mode = DataMode::TAG_ONLY
     );
 
     /**
@@ -72,6 +88,20 @@ public:
      */
     AccessResult access(uint64_t address, Operation operation) override;
 
+    /**
+     * @brief Access cache with a batch of addresses
+     *
+     * Set indices and tags are decoded a chunk at a time and statistics are
+     * flushed once per batch.
+     * @param addresses Memory addresses (count entries)
+     * @param operations Operation for each address (count entries)
+     * @param count Number of accesses
+     * @param results Caller-provided buffer for count results, or nullptr for counts only
+     * @return Aggregate hit/miss counts of the batch
+     */
+    BatchResult accessBatch(const uint64_t* addresses, const Operation* operations,
+                            size_t count, AccessResult* results = nullptr) override;
+
     /**
      * @brief Get cache statistics
      * @return Statistics object
@@ -97,7 +127,7 @@ public:
     /**
      * @brief Print cache contents (for debugging)
      */
-    void printCacheContents() const;
+    void printCacheContents() const override;
 
     /**
      * @brief Get write policy
@@ -111,11 +141,25 @@ public:
      */
     WriteMissPolicy getWriteMissPolicy() const { return write_miss_policy_; }
 
+    /**
+     * @brief Get replacement policy
+     * @return Replacement policy instance
+     */
+    const ReplacementPolicy& getReplacementPolicy() const { return *replacement_policy_; }
+
+    PolicyCounters getPolicyCounters() const override { return replacement_policy_->getCounters(); }
+
+    /**
+     * @brief Get block payload mode
+     * @return Data mode
+     */
+    DataMode getDataMode() const { return data_store_ ? DataMode::TRACK_DATA : DataMode::TAG_ONLY; }
+
     /**
      * @brief Get cache contents for visualization
-     * @return Vector of cache sets with their blocks
+     * @return Snapshot of cache sets with their blocks, built from the tag store
      */
-    const std::vector<std::vector<CacheBlock>>& getCacheContents() const { return cache_; }
+    std::vector<std::vector<CacheBlock>> getCacheContents() const;
 
     /**
      * @brief Get cache contents as JSON string for GUI
@@ -147,27 +191,251 @@ public:
      */
     uint64_t getBlockTag(size_t set_index, size_t block_index) const;
 
+    /**
+     * @brief Get block payload
+     * @param set_index Set index
+     * @param block_index Block index
+     * @return Pointer to block_size bytes, or nullptr in tag-only mode
+     */
+    const uint8_t* getBlockData(size_t set_index, size_t block_index) const;
+
+    /**
+     * @brief Attach the level below this cache
+     * @param lower Lower level, or nullptr for an ideal memory (not owned)
+     */
+    void setLowerLevel(LowerLevel* lower) { lower_level_ = lower; }
+
+    /**
+     * @brief Attach a prefetcher
+     *
+     * Prefetched blocks are filled like read misses and carry a prefetch tag
+     * until their first demand access, which the statistics count as useful,
+     * or as late if it comes within latency accesses of the prefetch. Tagged
+     * blocks that leave unused and demand misses on blocks evicted by prefetch
+     * fills are counted too.
+     * @param prefetcher Prefetcher, or nullptr to stop prefetching
+     * @param latency Demand accesses to this cache before a prefetched block arrives
+     */
+    void setPrefetcher(std::unique_ptr<Prefetcher> prefetcher, uint64_t latency = 0);
+
+    /**
+     * @brief Get the attached prefetcher
+     * @return Prefetcher, or nullptr without prefetching
+     */
+    const Prefetcher* getPrefetcher() const { return prefetcher_.get(); }
+
+    /**
+     * @brief Check if a block was prefetched and not yet accessed
+     * @param set_index Set index
+     * @param block_index Block index
+     * @return True if the block carries the prefetch tag
+     */
+    bool isBlockPrefetched(size_t set_index, size_t block_index) const;
+
+    /**
+     * @brief Attach a victim or miss cache
+     *
+     * Misses that fill a block look in the buffer before the lower level. A
+     * victim cache receives every block this cache evicts and swaps a block
+     * back in when a miss finds it; a miss cache keeps a clean copy of each
+     * block fetched on a miss. Misses served by the buffer are still misses of
+     * this cache, and the statistics count them as victim cache hits.
+     * @param buffer Buffer, or nullptr to remove it
+     */
+    void setVictimCache(std::unique_ptr<VictimCache> buffer) { victim_cache_ = std::move(buffer); }
+
+    /**
+     * @brief Get the attached victim or miss cache
+     * @return Buffer, or nullptr without one
+     */
+    const VictimCache* getVictimCache() const { return victim_cache_.get(); }
+
+    /**
+     * @brief Check whether the block holding an address is cached
+     * @param address Memory address
+     * @return True if present; neither statistics nor replacement state change
+     */
+    bool contains(uint64_t address) const;
+
+    /**
+     * @brief Look up a block on behalf of another level
+     *
+     * Updates replacement state on a hit but does not record statistics or
+     * allocate on a miss.
+     * @param address Memory address
+     * @param mark_dirty Set the dirty bit on a hit
+     * @return True on hit
+     */
+    bool touchBlock(uint64_t address, bool mark_dirty);
+
+    /**
+     * @brief Install a block without counting an access or fetching it
+     *
+     * A valid victim is passed to the lower level. Used for writebacks and
+     * victims arriving from an upper level.
+     * @param address Memory address
+     * @param dirty Dirty state of the installed block
+     */
+    void insertBlock(uint64_t address, bool dirty);
+
+    /**
+     * @brief Remove a block if present
+     * @param address Memory address
+     * @param dirty Receives the dirty state of the removed block (may be nullptr)
+     * @return True if the block was present
+     */
+    bool invalidateBlock(uint64_t address, bool* dirty = nullptr);
+
 private:
-    std::vector<std::vector<CacheBlock>> cache_; // Cache storage
+    // Flat structure-of-arrays tag store. Tags are indexed as set * ways + way;
+    // valid and dirty bits are packed into words_per_set_ 64-bit words per set.
+    std::vector<uint64_t> tags_;
+    std::vector<uint64_t> valid_bits_;
+    std::vector<uint64_t> dirty_bits_;
+    size_t words_per_set_;
+    std::vector<uint32_t> valid_counts_;         // Valid blocks per set
+    std::unique_ptr<BlockDataStore> data_store_; // Only allocated in TRACK_DATA mode
+    std::unique_ptr<BlockIndex> block_index_;    // Only allocated above kIndexedLookupThreshold ways
     std::unique_ptr<ReplacementPolicy> replacement_policy_;
     CacheStatistics statistics_;
     WritePolicy write_policy_;
     WriteMissPolicy write_miss_policy_;
+    LowerLevel* lower_level_;   // Next level, nullptr for ideal memory
+    uint64_t trace_position_;   // Accesses since construction or clear(), for offline policies
+    
+    // Prefetching state, only allocated with a prefetcher
+    std::unique_ptr<Prefetcher> prefetcher_;
+    uint64_t prefetch_latency_;              // Accesses before a prefetched block arrives
+    std::vector<uint64_t> prefetched_bits_;  // Prefetch tags, laid out like valid_bits_
+    std::vector<uint64_t> prefetch_ready_;   // trace_position_ up to which a prefetched block is in flight
+    std::vector<uint64_t> pollution_filter_; // Block number + 1 of recent prefetch victims, 0 if empty
+    std::vector<uint64_t> prefetch_queue_;   // Prefetcher output, reused across accesses
+    
+    std::unique_ptr<VictimCache> victim_cache_;   // Victim or miss cache, nullptr without one
+
+    /**
+     * @brief Index of a block in the tag array
+     */
+    size_t blockSlot(size_t set_index, size_t block_index) const {
+        return set_index * associativity_ + block_index;
+    }
+
+    /**
+     * @brief Index of the bitmap word holding a block's valid/dirty bit
+     */
+    size_t bitWord(size_t set_index, size_t block_index) const {
+        return set_index * words_per_set_ + (block_index >> 6);
+    }
+
+    /**
+     * @brief Mask selecting a block's bit within its bitmap word
+     */
+    static uint64_t bitMask(size_t block_index) {
+        return 1ULL << (block_index & 63);
+    }
+
+    bool testValid(size_t set_index, size_t block_index) const {
+        return (valid_bits_[bitWord(set_index, block_index)] & bitMask(block_index)) != 0;
+    }
+
+    bool testDirty(size_t set_index, size_t block_index) const {
+        return (dirty_bits_[bitWord(set_index, block_index)] & bitMask(block_index)) != 0;
+    }
+
+    void setDirty(size_t set_index, size_t block_index, bool dirty) {
+        uint64_t& word = dirty_bits_[bitWord(set_index, block_index)];
+        word = dirty ? (word | bitMask(block_index)) : (word & ~bitMask(block_index));
+    }
+
+    bool testPrefetched(size_t set_index, size_t block_index) const {
+        return (prefetched_bits_[bitWord(set_index, block_index)] & bitMask(block_index)) != 0;
+    }
+
+    void setPrefetched(size_t set_index, size_t block_index, bool prefetched) {
+        uint64_t& word = prefetched_bits_[bitWord(set_index, block_index)];
+        word = prefetched ? (word | bitMask(block_index)) : (word & ~bitMask(block_index));
+    }
+
+    /**
+     * @brief Slot of a block in the pollution filter
+     */
+    static size_t pollutionSlot(uint64_t block) {
+        return static_cast<size_t>((block ^ (block >> 12)) % kPollutionFilterEntries);
+    }
 
     /**
-     * @brief Find block in set
+     * @brief Key of a block in the block index
+     */
+    uint64_t indexKey(size_t set_index, uint64_t tag) const {
+        return (tag << index_bits_) | set_index;
+    }
+
+    /**
+     * @brief Find block and first empty block in set in one pass
      * @param set_index Set index
      * @param tag Tag to search for
-     * @return Block index if found, -1 otherwise
+     * @return Hit way (-1 if not found) and first empty way (-1 if set is full)
      */
-    int findBlock(size_t set_index, uint64_t tag) const;
+    TagLookupResult findBlock(size_t set_index, uint64_t tag) const {
+        if (block_index_) {
+            return findIndexed(set_index, tag);
+        }
+        return lookupTag(&tags_[blockSlot(set_index, 0)], &valid_bits_[bitWord(set_index, 0)],
+                         associativity_, tag);
+    }
 
     /**
-     * @brief Find empty block in set
-     * @param set_index Set index
-     * @return Block index if found, -1 if set is full
+     * @brief findBlock through the block index instead of a tag scan
+     */
+    TagLookupResult findIndexed(size_t set_index, uint64_t tag) const;
+
+    static constexpr size_t kIndexedLookupThreshold = 64;  // Wider sets use the block index
+    static constexpr size_t kBatchChunk = 256;       // Accesses decoded per batch step
+    static constexpr size_t kPrefetchDistance = 8;   // Sets prefetched ahead within a chunk
+    static constexpr size_t kPollutionFilterEntries = 4096;   // Remembered prefetch victims
+    static constexpr size_t kStoreBytes = 8;   // Bytes per store; traces carry no access size
+
+    /**
+     * @brief Entry points specialized for one policy type and write policy
+     */
+    using AccessFunction = AccessResult (SetAssociativeCache::*)(uint64_t, Operation);
+    using BatchFunction = BatchResult (SetAssociativeCache::*)(const uint64_t*, const Operation*, size_t, AccessResult*);
+    AccessFunction access_fn_;
+    BatchFunction batch_fn_;
+
+    /**
+     * @brief Pick the engine instantiation matching the replacement and write policies
+     */
+    void selectEngine();
+
+    /**
+     * @brief Access cache with the policy logic inlined
+     * @tparam Policy Concrete replacement policy type (ReplacementPolicy for virtual dispatch)
+     * @tparam WP Write policy
+     * @param address Memory address
+     * @param operation Operation type
+     * @return Access result
+     */
+    template <typename Policy, WritePolicy WP>
+    AccessResult accessWith(uint64_t address, Operation operation);
+
+    /**
+     * @brief Batch access with the policy logic inlined
+     */
+    template <typename Policy, WritePolicy WP>
+    BatchResult accessBatchWith(const uint64_t* addresses, const Operation* operations,
+                                size_t count, AccessResult* results);
+
+    /**
+     * @brief Look up and update one block without touching the statistics
+     * @param address Memory address
+     * @param set_index Set index of the address
+     * @param tag Tag of the address
+     * @param operation Operation type
+     * @return Access result
      */
-    int findEmptyBlock(size_t set_index) const;
+    template <typename Policy, WritePolicy WP>
+    AccessResult accessBlock(uint64_t address, size_t set_index, uint64_t tag, Operation operation);
 
     /**
      * @brief Handle cache hit
@@ -176,6 +444,7 @@ private:
      * @param operation Operation type
      * @return Access result
      */
+    template <typename Policy, WritePolicy WP>
     AccessResult handleHit(size_t set_index, size_t block_index, Operation operation);
 
     /**
@@ -184,30 +453,79 @@ private:
      * @param set_index Set index
      * @param tag Tag
      * @param operation Operation type
+     * @param empty_block First empty block in the set, -1 if the set is full
      * @return Access result
      */
-    AccessResult handleMiss(uint64_t address, size_t set_index, uint64_t tag, Operation operation);
+    template <typename Policy, WritePolicy WP>
+    AccessResult handleMiss(uint64_t address, size_t set_index, uint64_t tag, Operation operation, int empty_block);
 
     /**
      * @brief Allocate block in cache
      * @param set_index Set index
      * @param tag Tag
-     * @param operation Operation type
+     * @param dirty Dirty state of the new block
+     * @param empty_block First empty block in the set, -1 if the set is full
+     * @param fetch Read the block from the lower level
+     * @param prefetch The fill is a prefetch
      * @return Block index where data was allocated
      */
-    size_t allocateBlock(size_t set_index, uint64_t tag, Operation operation);
+    template <typename Policy, WritePolicy WP>
+    size_t allocateBlock(size_t set_index, uint64_t tag, bool dirty, int empty_block, bool fetch,
+                         bool prefetch = false);
 
     /**
-     * @brief Write data to memory (simulated)
-     * @param address Memory address
+     * @brief Train the prefetcher on a demand access and fill the blocks it asks for
+     * @param address Memory address of the access
      */
-    void writeToMemory(uint64_t address);
+    template <typename Policy, WritePolicy WP>
+    void runPrefetcher(uint64_t address);
 
     /**
-     * @brief Read data from memory (simulated)
+     * @brief Look for a missing block in the victim or miss cache
+     *
+     * A victim cache hands the block over; a miss cache keeps its copy, and on
+     * a miss records the block about to be fetched.
      * @param address Memory address
+     * @param write True for a write miss
+     * @param dirty Receives the dirty state of a block handed over
+     * @return True if the block can be filled without the lower level
+     */
+    bool probeVictimCache(uint64_t address, bool write, bool& dirty);
+
+    /**
+     * @brief Pass a block evicted from the tag store on
+     *
+     * A victim cache takes it and hands its own victim to the lower level.
+     * @param address Block address
+     * @param dirty True if the block must be written back
+     */
+    void evictBlock(uint64_t address, bool dirty);
+
+    /**
+     * @brief Write data to the lower level
+     *
+     * Writebacks move a whole block, stores kStoreBytes.
+     * @param address Block address
+     * @param kind WRITEBACK, WRITE_THROUGH or BYPASS, for the traffic counters
+     */
+    void writeToMemory(uint64_t address, CacheStatistics::Transfer kind);
+
+    /**
+     * @brief Read data from the lower level
+     * @param address Block address
+     * @param prefetch The read is a prefetch fill
+     * @return True if the block arrives dirty
+     */
+    bool readFromMemory(uint64_t address, bool prefetch);
+
+    /**
+     * @brief Pass an evicted block to the lower level
+     *
+     * Dirty blocks count as a writeback of the whole block.
+     * @param address Block address
+     * @param dirty True if the block must be written back
      */
-    void readFromMemory(uint64_t address);
+    void evictToMemory(uint64_t address, bool dirty);
 };
 
 #endif // SET_ASSOCIATIVE_CACHE_H
@@ -0,0 +1,81 @@
+#ifndef SHARDED_CACHE_H
+#define SHARDED_CACHE_H
+
+#include "cache.h"
+#include "cache_spec.h"
+#include "cache_statistics.h"
+#include "set_associative_cache.h"
+#include <memory>
+#include <vector>
+
+/**
+ * @brief Set-sharded cache that simulates disjoint set ranges in parallel
+ *
+ * The sets are split into a power-of-two number of contiguous ranges by the
+ * high bits of the set index, and each range is simulated by its own
+ * SetAssociativeCache with its own replacement policy state. A shard is a
+ * cache of cache_size / shards bytes fed the original addresses: its set
+ * index is the low bits of the full set index and its tag absorbs the shard
+ * bits, which are constant within a shard, so every set behaves exactly as
+ * in the serial engine.
+ *
+ * accessBatch partitions the stream by shard with a stable parallel counting
+ * sort, which keeps per-set order, runs the shards on worker threads and
+ * scatters results back to their original positions. With LRU and FIFO the
+ * results are identical to a single SetAssociativeCache; Random draws from a
+ * different sequence.
+ */
+class ShardedCache : public Cache {
+public:
+    /**
+     * @brief Constructor
+     * @param spec Cache configuration
+     * @param threads Requested worker threads; the shard count is the largest
+     *                power of two not above threads and the number of sets
+     * @throws std::invalid_argument if the configuration is invalid, has a prefetcher,
+     *         victim cache or miss cache, or uses BRRIP or DRRIP replacement
+     */
+    ShardedCache(const CacheSpec& spec, size_t threads);
+
+    AccessResult access(uint64_t address, Operation operation) override;
+    BatchResult accessBatch(const uint64_t* addresses, const Operation* operations,
+                            size_t count, AccessResult* results = nullptr) override;
+
+    /**
+     * @brief Get statistics merged over all shards
+     * @return Statistics object
+     */
+    CacheStatistics getStatistics() const override;
+
+    void resetStatistics() override;
+    void clear() override;
+    std::string getConfig() const override;
+
+    /**
+     * @brief Get replacement policy counters summed over all shards
+     * @return Counters by name, in the first shard's order
+     */
+    PolicyCounters getPolicyCounters() const override;
+    void printCacheContents() const override;
+
+    size_t getShardCount() const { return shards_.size(); }
+    const SetAssociativeCache& getShard(size_t shard) const { return *shards_.at(shard); }
+
+private:
+    static constexpr size_t kMinParallelBatch = 1 << 16; // Smaller batches run on the calling thread
+
+    std::vector<std::unique_ptr<SetAssociativeCache>> shards_;
+    size_t shard_bits_;         // log2 of the shard count
+    size_t local_index_bits_;   // Set index bits within a shard
+
+    // Partition buffers, reused across batches
+    std::vector<uint8_t> shard_ids_;
+    std::vector<uint64_t> part_addresses_;
+    std::vector<Operation> part_operations_;
+    std::vector<size_t> part_positions_;
+    std::vector<AccessResult> part_results_;
+
+    size_t shardOf(uint64_t address) const { return getSetIndex(address) >> local_index_bits_; }
+};
+
+#endif // SHARDED_CACHE_H
@@ -0,0 +1,118 @@
+#ifndef STACK_DISTANCE_H
+#define STACK_DISTANCE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Mattson stack-distance analyzer for LRU miss-ratio curves
+ *
+ * LRU has the stack inclusion property: an access hits in a fully associative
+ * cache of C blocks exactly when its reuse distance (distinct blocks touched
+ * since the previous access to the same block) is below C. The analyzer
+ * measures every reuse distance in O(log n) with a Fenwick tree over access
+ * times, where each block keeps a mark at the time of its latest access, so
+ * one pass yields the exact miss count for every fully associative size.
+ *
+ * For a fixed number of sets it also keeps a bounded LRU stack per set, which
+ * gives the miss count for 1 to max_ways ways at that set count.
+ *
+ * Reads and writes are treated alike, matching an LRU cache with write-allocate.
+ */
+class StackDistanceAnalyzer {
+public:
+    /**
+     * @brief Constructor
+     * @param block_size Block size in bytes (power of two)
+     * @param num_sets Set count for the per-set histograms (power of two)
+     * @param max_ways Largest associativity tracked per set
+     * @throws std::invalid_argument if a size is zero or not a power of two
+     */
+    StackDistanceAnalyzer(size_t block_size, size_t num_sets, size_t max_ways = 32);
+
+    /**
+     * @brief Record one access
+     * @param address Memory address
+     */
+    void access(uint64_t address);
+
+    /**
+     * @brief Record a batch of accesses
+     * @param addresses Memory addresses
+     * @param count Number of accesses
+     */
+    void accessBatch(const uint64_t* addresses, size_t count);
+
+    uint64_t getAccesses() const { return accesses_; }
+    uint64_t getColdMisses() const { return last_access_.size(); }
+    size_t getBlockSize() const { return block_size_; }
+    size_t getNumSets() const { return num_sets_; }
+    size_t getMaxWays() const { return max_ways_; }
+
+    /**
+     * @brief Get the reuse distance histogram of the fully associative stack
+     * @return Entry d counts re-references with reuse distance d (cold misses excluded)
+     */
+    const std::vector<uint64_t>& getDistanceHistogram() const { return distance_histogram_; }
+
+    /**
+     * @brief Get misses of a fully associative LRU cache
+     * @param blocks Capacity in blocks
+     * @return Miss count, including cold misses
+     */
+    uint64_t getMisses(size_t blocks) const;
+
+    /**
+     * @brief Get misses of an LRU cache with getNumSets() sets
+     * @param ways Associativity, 1 to getMaxWays()
+     * @return Miss count, including cold misses
+     */
+    uint64_t getSetAssociativeMisses(size_t ways) const;
+
+    /**
+     * @brief Get the stack histogram of one set
+     * @param set Set index
+     * @return Entry d < max_ways counts hits at LRU depth d; the last entry counts deeper accesses and cold misses
+     */
+    std::vector<uint64_t> getSetHistogram(size_t set) const;
+
+    /**
+     * @brief Write the miss-ratio curves as CSV
+     *
+     * Rows list type, sets, ways, blocks, cache_size, misses and miss_rate (in
+     * percent). Fully associative rows are emitted for every capacity at which
+     * the miss count changes, up to the capacity that leaves only cold misses;
+     * set-associative rows cover 1 to max_ways ways.
+     *
+     * @param os Output stream
+     */
+    void writeCurve(std::ostream& os) const;
+
+private:
+    size_t block_size_;
+    size_t offset_bits_;
+    size_t num_sets_;
+    size_t max_ways_;
+    uint64_t accesses_;
+
+    // Fully associative stack: Fenwick tree over access times
+    std::vector<uint32_t> tree_;                            // 1-based Fenwick tree of live marks
+    uint64_t time_;                                         // Last used position
+    std::unordered_map<uint64_t, uint64_t> last_access_;    // Block -> position of its latest access
+    std::vector<uint64_t> distance_histogram_;
+
+    // Per-set bounded LRU stacks, most recent first
+    std::vector<uint64_t> set_stacks_;                      // set * max_ways + depth
+    std::vector<uint32_t> set_depths_;                      // Valid entries per set
+    std::vector<uint64_t> set_histograms_;                  // set * (max_ways + 1) + depth
+
+    void treeAdd(uint64_t position, int32_t delta);
+    uint64_t treePrefix(uint64_t position) const;
+    void compact();
+    void accessSet(uint64_t block);
+};
+
+#endif // STACK_DISTANCE_H
@@ -0,0 +1,77 @@
+#ifndef SWEEP_H
+#define SWEEP_H
+
+#include "cache_spec.h"
+#include "cache_statistics.h"
+#include "trace_reader.h"
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Result of simulating one configuration in a sweep
+ */
+struct SweepResult {
+    CacheSpec spec;
+    CacheStatistics statistics;
+    double simulation_time;   // Seconds spent simulating this configuration
+};
+
+/**
+ * @brief Expand a sweep grid into configurations
+ *
+ * The grid is a ';'-separated list of "key=value,value,..." entries and the
+ * result is the cartesian product of all listed values. Keys are the option
+ * names of cache_simulator: s|cache-size, b|block-size, a|associativity,
+ * r|replacement, w|write-policy, m|write-miss, p|prefetcher, prefetch-degree,
+ * prefetch-distance, prefetch-latency, victim-cache and miss-cache. Sizes
+ * accept K and M suffixes.
+ * Parameters not listed keep their value from the base configuration.
+ *
+ * Example: "s=8K,32K,128K;a=1,2,4,8;r=LRU,FIFO" expands to 24 configurations.
+ *
+ * @param grid Grid description
+ * @param base Configuration supplying unlisted parameters
+ * @return Expanded configurations
+ * @throws std::invalid_argument on an unknown key or malformed value
+ */
+std::vector<CacheSpec> parseSweepGrid(const std::string& grid, const CacheSpec& base);
+
+/**
+ * @brief Simulate many configurations in a single pass over a trace
+ *
+ * The calling thread decodes the trace into shared chunks, keeping at most a
+ * bounded window in memory. Worker threads pick configurations that have
+ * unprocessed chunks, lagging configurations first, and run each chunk
+ * through that configuration's cache with accessBatch. A chunk is dropped
+ * once every configuration has consumed it.
+ *
+ * OPT configurations take the next-use index with their block size from
+ * next_use; it must have been built from the same trace. Configurations that
+ * cannot be built are reported on stderr and skipped.
+ *
+ * @param reader Trace source, read once
+ * @param specs Configurations to simulate
+ * @param threads Worker threads (0 = hardware concurrency)
+ * @param next_use Next-use indexes for OPT, at most one per block size
+ * @return One result per valid configuration, in input order
+ */
+std::vector<SweepResult> runSweep(TraceReader& reader, const std::vector<CacheSpec>& specs, size_t threads = 0,
+                                  const std::vector<std::shared_ptr<const NextUseIndex>>& next_use = {});
+
+/**
+ * @brief Write sweep results as CSV with a header row
+ * @param os Output stream
+ * @param results Sweep results
+ */
+void writeSweepCSV(std::ostream& os, const std::vector<SweepResult>& results);
+
+/**
+ * @brief Write sweep results as a JSON array of objects
+ * @param os Output stream
+ * @param results Sweep results
+ */
+void writeSweepJSON(std::ostream& os, const std::vector<SweepResult>& results);
+
+#endif // SWEEP_H
@@ -0,0 +1,54 @@
+#ifndef TAG_LOOKUP_H
+#define TAG_LOOKUP_H
+
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @brief Result of probing one set of the tag store
+ */
+struct TagLookupResult {
+    int hit_way;    // Way holding the probe tag, -1 on a miss
+    int empty_way;  // First invalid way, -1 if the set is full (only computed on a miss)
+};
+
+/**
+ * @brief Available tag comparison kernels
+ */
+enum class TagLookupKernel {
+    SCALAR,  // One way per comparison
+    SSE2,    // Two ways per 128-bit compare
+    AVX2     // Four ways per 256-bit compare, eight ways per loop iteration
+};
+
+/**
+ * @brief Probe a set for a tag and its first invalid way in a single pass
+ * @param tags Tag array of the set (ways entries)
+ * @param valid_words Packed valid bitmap of the set ((ways + 63) / 64 words)
+ * @param ways Number of ways in the set
+ * @param tag Tag to search for
+ * @return Hit way and first invalid way
+ */
+TagLookupResult lookupTag(const uint64_t* tags, const uint64_t* valid_words, size_t ways, uint64_t tag);
+
+/**
+ * @brief Get the kernel used by lookupTag
+ * @return Kernel selected at startup from the CPU features, or by setTagLookupKernel
+ */
+TagLookupKernel getTagLookupKernel();
+
+/**
+ * @brief Force a specific kernel (for tests and benchmarks; not thread-safe)
+ * @param kernel Kernel to use
+ * @return False if the CPU or build does not support the kernel
+ */
+bool setTagLookupKernel(TagLookupKernel kernel);
+
+/**
+ * @brief Get kernel name
+ * @param kernel Kernel
+ * @return Kernel name as string
+ */
+const char* tagLookupKernelName(TagLookupKernel kernel);
+
+#endif // TAG_LOOKUP_H
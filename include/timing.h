@@ -0,0 +1,106 @@
+#ifndef TIMING_H
+#define TIMING_H
+
+#include "cache_statistics.h"
+#include <cstdint>
+#include <map>
+#include <string>
+
+/**
+ * @brief Exact histogram of simulated access latencies in cycles
+ *
+ * Latencies are built from a few fixed level latencies, so they take a small
+ * set of distinct values and one count per value stays compact.
+ */
+class LatencyHistogram {
+public:
+    /**
+     * @brief Record accesses of one latency
+     * @param cycles Latency in cycles
+     * @param count Number of accesses
+     */
+    void record(uint64_t cycles, uint64_t count = 1);
+
+    /**
+     * @brief Add the counts of another histogram
+     */
+    void merge(const LatencyHistogram& other);
+
+    uint64_t getCount() const { return count_; }
+    uint64_t getTotalCycles() const { return total_cycles_; }
+    const std::map<uint64_t, uint64_t>& getBuckets() const { return buckets_; }
+
+    /**
+     * @brief Get the mean latency
+     * @return Cycles per access, 0 if empty
+     */
+    double getMean() const;
+
+    /**
+     * @brief Get a latency percentile (nearest rank)
+     * @param percentile Percentile between 0 and 100
+     * @return Smallest latency at or below which percentile% of the accesses fall, 0 if empty
+     */
+    uint64_t getPercentile(double percentile) const;
+
+private:
+    std::map<uint64_t, uint64_t> buckets_;   // Latency -> accesses
+    uint64_t count_ = 0;
+    uint64_t total_cycles_ = 0;
+};
+
+/**
+ * @brief Simulated latencies of the accesses of a run, by operation type
+ */
+struct AccessTiming {
+    LatencyHistogram reads;
+    LatencyHistogram writes;
+
+    uint64_t getTotalCycles() const { return reads.getTotalCycles() + writes.getTotalCycles(); }
+
+    /**
+     * @brief Get the average memory access time
+     * @return Cycles per access over reads and writes
+     */
+    double getAMAT() const;
+
+    /**
+     * @brief Get reads and writes in one histogram
+     */
+    LatencyHistogram getCombined() const;
+
+    /**
+     * @brief Get a report with total cycles, AMAT and p50/p99 per operation type
+     * @param histogram Also list the accesses of every latency
+     */
+    std::string toString(bool histogram = true) const;
+};
+
+/**
+ * @brief Latency parameters of a single cache, in cycles
+ *
+ * Every access pays the hit latency. Misses that fetch a block also wait for
+ * the miss penalty, unless the victim or miss cache holds the block, which
+ * costs kVictimCacheCycles instead. Stores are buffered: write-through
+ * traffic, writebacks and no-write-allocate write misses add nothing.
+ */
+struct TimingModel {
+    static constexpr uint64_t kVictimCacheCycles = 1;   // Extra cycles of a victim cache hit
+
+    uint64_t hit_latency = 1;
+    uint64_t miss_penalty = 100;
+
+    /**
+     * @brief Derive the latency of every access from the statistics of a run
+     *
+     * The latency of an access depends only on its outcome, so the counters
+     * of CacheStatistics determine the histograms and the simulation itself
+     * pays nothing for timing.
+     * @param stats Statistics of the run
+     * @param write_allocate Write misses fetch the block (write-allocate)
+     * @return Access latencies
+     */
+    AccessTiming evaluate(const CacheStatistics& stats, bool write_allocate) const;
+};
+
+#endif // TIMING_H
@@ -0,0 +1,181 @@
+#ifndef TRACE_READER_H
+#define TRACE_READER_H
+
+#include "cache.h"
+#include "gzip_stream.h"
+#include "mapped_file.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @brief One decoded memory access from a trace
+ */
+struct TraceRecord {
+    uint64_t address;
+    Cache::Operation operation;
+    uint32_t core = 0;        // Issuing core for multi-core traces
+    uint64_t timestamp = 0;   // Issue cycle (or instruction count) from timed traces, 0 if untimed
+};
+
+/**
+ * @brief In-place parser for text traces
+ *
+ * Each line holds "<operation> <address> [core [timestamp]]" where the
+ * operation is R, W, READ or WRITE (any case), the address is hex (0x prefix),
+ * octal (leading 0) or decimal, the optional core id of multi-core traces
+ * defaults to 0 and the optional timestamp of timed traces defaults to 0. Empty lines and lines starting with '#' are skipped. The parser
+ * works directly on a character range and never allocates per line.
+ */
+class TextTraceParser {
+public:
+    /**
+     * @brief Constructor
+     * @param source_name Name used in warning messages
+     */
+    explicit TextTraceParser(std::string source_name = "trace");
+
+    /**
+     * @brief Parse lines from a character range
+     * @param begin Start of the range
+     * @param end End of the range
+     * @param final True if no more input follows, so a last line without '\n' is complete
+     * @param out Records are appended here
+     * @param max_records Stop after appending this many records
+     * @return Pointer to the first unconsumed character
+     */
+    const char* parse(const char* begin, const char* end, bool final,
+                      std::vector<TraceRecord>& out, size_t max_records);
+
+    /**
+     * @brief Get number of lines that were skipped because they were malformed
+     */
+    uint64_t getInvalidLines() const { return invalid_lines_; }
+
+    /**
+     * @brief Get number of lines consumed so far
+     */
+    uint64_t getLineNumber() const { return line_number_; }
+
+    /**
+     * @brief Parse an address token ("0x..." hex, leading 0 octal, otherwise decimal)
+     * @param begin Start of the token
+     * @param end End of the token
+     * @param address Parsed value
+     * @return False if the token is empty, has invalid digits or overflows
+     */
+    static bool parseAddress(const char* begin, const char* end, uint64_t& address);
+
+    /**
+     * @brief Parse a timestamp token ("0x..." hex, otherwise decimal even with leading zeros)
+     * @param begin Start of the token
+     * @param end End of the token
+     * @param timestamp Parsed value
+     * @return False if the token is empty, has invalid digits or overflows
+     */
+    static bool parseTimestamp(const char* begin, const char* end, uint64_t& timestamp);
+
+private:
+    static constexpr uint64_t kMaxWarnings = 10; // Individual warnings printed before summarizing
+
+    std::string source_name_;
+    uint64_t line_number_;
+    uint64_t invalid_lines_;
+
+    void parseLine(const char* begin, const char* end, std::vector<TraceRecord>& out);
+    void warn(const char* message, const char* begin, const char* end);
+    static bool parseDigits(const char* begin, const char* end, unsigned base, uint64_t& result);
+};
+
+/**
+ * @brief Streaming source of trace records
+ */
+class TraceReader {
+public:
+    virtual ~TraceReader() = default;
+
+    /**
+     * @brief Read the next records
+     * @param out Records are appended here
+     * @param max_records Maximum number of records to append
+     * @return Number of records appended, 0 at end of trace
+     */
+    virtual size_t read(std::vector<TraceRecord>& out, size_t max_records) = 0;
+
+    /**
+     * @brief Get number of malformed entries skipped so far
+     */
+    virtual uint64_t getInvalidRecords() const = 0;
+};
+
+/**
+ * @brief Text trace reader over a memory-mapped file
+ */
+class TextTraceReader : public TraceReader {
+public:
+    /**
+     * @brief Constructor
+     * @param filename Trace file
+     * @throws std::runtime_error if the file cannot be mapped
+     */
+    explicit TextTraceReader(const std::string& filename);
+
+    size_t read(std::vector<TraceRecord>& out, size_t max_records) override;
+    uint64_t getInvalidRecords() const override { return parser_.getInvalidLines(); }
+
+private:
+    MappedFile file_;
+    TextTraceParser parser_;
+    const char* cursor_;
+};
+
+/**
+ * @brief Text trace reader over a gzip-compressed file
+ *
+ * Parses decompressed chunks in place as the background thread of the
+ * GzipStream produces them; only a line split across two chunks is copied.
+ */
+class GzipTextTraceReader : public TraceReader {
+public:
+    /**
+     * @brief Constructor
+     * @param filename Compressed trace file
+     * @throws std::runtime_error if the file cannot be opened
+     */
+    explicit GzipTextTraceReader(const std::string& filename);
+
+    size_t read(std::vector<TraceRecord>& out, size_t max_records) override;
+    uint64_t getInvalidRecords() const override { return parser_.getInvalidLines(); }
+
+private:
+    GzipStream stream_;
+    TextTraceParser parser_;
+    const char* cursor_;
+    const char* chunk_end_;
+    std::string carry_;     // Incomplete line from the end of the previous chunk
+};
+
+/**
+ * @brief Open a trace file with the matching reader
+ *
+ * Binary traces are recognized by their magic number; anything else is
+ * read as text. Gzip-compressed files of either format are decompressed
+ * on the fly.
+ *
+ * @param filename Trace file
+ * @return Reader for the file
+ * @throws std::runtime_error if the file cannot be opened
+ */
+std::unique_ptr<TraceReader> openTraceReader(const std::string& filename);
+
+/**
+ * @brief Read a whole trace into memory
+ * @param filename Trace file
+ * @param records Records of the trace (replaced)
+ * @return Number of malformed entries that were skipped
+ * @throws std::runtime_error if the file cannot be opened
+ */
+uint64_t readTrace(const std::string& filename, std::vector<TraceRecord>& records);
+
+#endif // TRACE_READER_H
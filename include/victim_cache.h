@@ -0,0 +1,107 @@
+#ifndef VICTIM_CACHE_H
+#define VICTIM_CACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Small fully associative buffer beside a cache (Jouppi, 1990)
+ *
+ * A victim cache receives the blocks the cache evicts and swaps a block back
+ * in when a miss finds it, so blocks conflicting in one set can live on in
+ * the buffer. A miss cache instead keeps a copy of each block fetched on a
+ * miss; its entries are clean and are dropped when replaced.
+ *
+ * Entries are block numbers (address / block size) kept in LRU order.
+ */
+class VictimCache {
+public:
+    /**
+     * @brief What the buffer is filled with
+     */
+    enum class Mode {
+        VICTIM,   // Blocks evicted by the cache
+        MISS      // Blocks fetched on misses
+    };
+
+    /**
+     * @brief Constructor
+     * @param entries Number of blocks the buffer holds
+     * @param mode Victim or miss cache
+     * @throws std::invalid_argument if entries is zero
+     */
+    VictimCache(size_t entries, Mode mode);
+
+    /**
+     * @brief Look up a block and make it most recently used
+     * @param block Block number
+     * @return True if the block is buffered
+     */
+    bool find(uint64_t block);
+
+    /**
+     * @brief Check whether a block is buffered, without touching the LRU order
+     * @param block Block number
+     */
+    bool contains(uint64_t block) const { return position(block) != entries_.size(); }
+
+    /**
+     * @brief Remove a block if present
+     * @param block Block number
+     * @param dirty Receives the dirty state of the removed block (may be nullptr)
+     * @return True if the block was buffered
+     */
+    bool remove(uint64_t block, bool* dirty = nullptr);
+
+    /**
+     * @brief Insert a block as most recently used
+     *
+     * The block must not be buffered already.
+     * @param block Block number
+     * @param dirty Dirty state of the block
+     * @param evicted Receives the replaced block, if any
+     * @param evicted_dirty Receives the dirty state of the replaced block
+     * @return True if a block was replaced to make room
+     */
+    bool insert(uint64_t block, bool dirty, uint64_t& evicted, bool& evicted_dirty);
+
+    /**
+     * @brief Mark a buffered block dirty
+     * @param block Block number
+     * @return True if the block is buffered
+     */
+    bool markDirty(uint64_t block);
+
+    /**
+     * @brief Empty the buffer
+     */
+    void clear() { entries_.clear(); }
+
+    Mode getMode() const { return mode_; }
+    size_t getCapacity() const { return capacity_; }
+
+    /**
+     * @brief Get buffer name
+     * @return "Victim Cache" or "Miss Cache"
+     */
+    std::string getName() const { return mode_ == Mode::VICTIM ? "Victim Cache" : "Miss Cache"; }
+
+private:
+    struct Entry {
+        uint64_t block;
+        bool dirty;
+    };
+
+    size_t capacity_;
+    Mode mode_;
+    std::vector<Entry> entries_;   // Most recently used first
+
+    /**
+     * @brief Position of a block in entries_, or entries_.size() if absent
+     */
+    size_t position(uint64_t block) const;
+};
+
+#endif // VICTIM_CACHE_H
@@ -0,0 +1,92 @@
+#ifndef WAY_MASK_H
+#define WAY_MASK_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Read-only view of one valid bit per way of a cache set
+ *
+ * The bits are packed 64 ways to a word, way w in bit w % 64 of word w / 64,
+ * which is the layout of the tag store's valid bits. The cache hands
+ * replacement policies a view of the set it evicts from, so choosing a victim
+ * copies and allocates nothing. Bits past the last way are ignored.
+ */
+class WayMask {
+public:
+    /**
+     * @brief Constructor
+     * @param words (ways + 63) / 64 words of valid bits
+     * @param ways Number of ways in the set
+     */
+    WayMask(const uint64_t* words, size_t ways) : words_(words), ways_(ways) {}
+
+    size_t size() const { return ways_; }
+    const uint64_t* words() const { return words_; }
+
+    /**
+     * @brief Check whether a way is valid
+     */
+    bool operator[](size_t way) const { return (words_[way >> 6] >> (way & 63)) & 1; }
+
+    /**
+     * @brief Count the valid ways
+     */
+    size_t count() const {
+        size_t valid = 0;
+        for (size_t word = 0; word < wordCount(); ++word) {
+            valid += static_cast<size_t>(__builtin_popcountll(wordBits(word)));
+        }
+        return valid;
+    }
+
+    /**
+     * @brief Find the first invalid way
+     * @return Way index, or size() if every way is valid
+     */
+    size_t firstInvalid() const {
+        for (size_t word = 0; word < wordCount(); ++word) {
+            uint64_t clear = ~words_[word];
+            if (clear != 0) {
+                size_t way = word * 64 + static_cast<size_t>(__builtin_ctzll(clear));
+                return way < ways_ ? way : ways_;
+            }
+        }
+        return ways_;
+    }
+
+    /**
+     * @brief Find the valid way of a given rank
+     * @param rank Zero-based rank among the valid ways, in way order
+     * @return Way index, or size() if fewer ways are valid
+     */
+    size_t nthValid(size_t rank) const {
+        for (size_t word = 0; word < wordCount(); ++word) {
+            uint64_t bits = wordBits(word);
+            size_t valid = static_cast<size_t>(__builtin_popcountll(bits));
+            if (rank >= valid) {
+                rank -= valid;
+                continue;
+            }
+            for (; rank > 0; --rank) {
+                bits &= bits - 1;
+            }
+            return word * 64 + static_cast<size_t>(__builtin_ctzll(bits));
+        }
+        return ways_;
+    }
+
+private:
+    const uint64_t* words_;
+    size_t ways_;
+
+    size_t wordCount() const { return (ways_ + 63) / 64; }
+
+    // Bits of a word that belong to real ways
+    uint64_t wordBits(size_t word) const {
+        size_t tail = ways_ - word * 64;
+        return tail >= 64 ? words_[word] : words_[word] & ((1ULL << tail) - 1);
+    }
+};
+
+#endif // WAY_MASK_H
@@ -0,0 +1,382 @@
+#include "binary_trace.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <zlib.h>
+
+namespace {
+
+inline void putU16(uint8_t* p, uint16_t v) {
+    p[0] = static_cast<uint8_t>(v);
+    p[1] = static_cast<uint8_t>(v >> 8);
+}
+
+inline void putU32(uint8_t* p, uint32_t v) {
+    for (int i = 0; i < 4; ++i) p[i] = static_cast<uint8_t>(v >> (8 * i));
+}
+
+inline void putU64(uint8_t* p, uint64_t v) {
+    for (int i = 0; i < 8; ++i) p[i] = static_cast<uint8_t>(v >> (8 * i));
+}
+
+inline uint16_t getU16(const uint8_t* p) {
+    return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+inline uint32_t getU32(const uint8_t* p) {
+    uint32_t v = 0;
+    for (int i = 3; i >= 0; --i) v = (v << 8) | p[i];
+    return v;
+}
+
+inline uint64_t getU64(const uint8_t* p) {
+    uint64_t v = 0;
+    for (int i = 7; i >= 0; --i) v = (v << 8) | p[i];
+    return v;
+}
+
+inline uint64_t zigzagEncode(uint64_t delta) {
+    return (delta << 1) ^ (0 - (delta >> 63));
+}
+
+inline uint64_t zigzagDecode(uint64_t value) {
+    return (value >> 1) ^ (0 - (value & 1));
+}
+
+inline void putVarint(std::vector<uint8_t>& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+inline const uint8_t* getVarint(const uint8_t* p, const uint8_t* end, uint64_t& value) {
+    value = 0;
+    for (unsigned shift = 0; p < end && shift < 64; shift += 7) {
+        uint8_t byte = *p++;
+        value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) return p;
+    }
+    return nullptr;
+}
+
+// Validate the fixed file header
+void checkHeader(const uint8_t* header, const std::string& filename) {
+    if (std::memcmp(header, binary_trace::kMagic, sizeof(binary_trace::kMagic)) != 0) {
+        throw std::runtime_error("Not a binary trace: " + filename);
+    }
+    if (getU16(header + 4) != binary_trace::kVersion) {
+        throw std::runtime_error("Unsupported binary trace version in " + filename);
+    }
+    if (getU64(header + 40) != binary_trace::checksum(header, 40)) {
+        throw std::runtime_error("Corrupted binary trace header in " + filename);
+    }
+    if (getU16(header + 6) & ~(binary_trace::kFlagCoreIds | binary_trace::kFlagTimestamps)) {
+        throw std::runtime_error("Unsupported binary trace flags in " + filename);
+    }
+}
+
+// Decode one block payload given its block header
+void decodePayload(const uint8_t* header, const uint8_t* payload, size_t block_index,
+                   bool core_ids, bool timestamps, std::vector<TraceRecord>& out) {
+    uint32_t record_count = getU32(header);
+    uint32_t payload_bytes = getU32(header + 4);
+    const uint8_t* end = payload + payload_bytes;
+    
+    if (binary_trace::checksum(payload, payload_bytes) != getU64(header + 8)) {
+        throw std::runtime_error("Checksum mismatch in binary trace block " + std::to_string(block_index));
+    }
+    
+    size_t bitmap_bytes = (static_cast<size_t>(record_count) + 7) / 8;
+    if (bitmap_bytes > payload_bytes) {
+        throw std::runtime_error("Malformed binary trace block " + std::to_string(block_index));
+    }
+    
+    const uint8_t* ops = payload;
+    const uint8_t* p = payload + bitmap_bytes;
+    uint64_t address = 0;
+    size_t first = out.size();
+    out.reserve(out.size() + record_count);
+    for (uint32_t i = 0; i < record_count; ++i) {
+        uint64_t value;
+        p = getVarint(p, end, value);
+        if (!p) {
+            throw std::runtime_error("Malformed binary trace block " + std::to_string(block_index));
+        }
+        address += zigzagDecode(value);
+        bool is_write = (ops[i / 8] >> (i % 8)) & 1;
+        out.push_back(TraceRecord{address, is_write ? Cache::Operation::WRITE : Cache::Operation::READ});
+    }
+    
+    if (core_ids) {
+        for (uint32_t i = 0; i < record_count; ++i) {
+            uint64_t core;
+            p = getVarint(p, end, core);
+            if (!p || core > UINT32_MAX) {
+                throw std::runtime_error("Malformed binary trace block " + std::to_string(block_index));
+            }
+            out[first + i].core = static_cast<uint32_t>(core);
+        }
+    }
+    
+    if (timestamps) {
+        uint64_t timestamp = 0;
+        for (uint32_t i = 0; i < record_count; ++i) {
+            uint64_t value;
+            p = getVarint(p, end, value);
+            if (!p) {
+                throw std::runtime_error("Malformed binary trace block " + std::to_string(block_index));
+            }
+            timestamp += zigzagDecode(value);
+            out[first + i].timestamp = timestamp;
+        }
+    }
+}
+
+} // namespace
+
+namespace binary_trace {
+
+uint64_t checksum(const uint8_t* data, size_t size, uint64_t seed) {
+    uint64_t hash = seed;
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= data[i];
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+bool isBinaryTrace(const std::string& filename) {
+    // gzread passes uncompressed files through unchanged
+    gzFile file = gzopen(filename.c_str(), "rb");
+    if (!file) return false;
+    char magic[sizeof(kMagic)];
+    bool binary = gzread(file, magic, sizeof(magic)) == static_cast<int>(sizeof(magic)) &&
+                  std::memcmp(magic, kMagic, sizeof(kMagic)) == 0;
+    gzclose(file);
+    return binary;
+}
+
+} // namespace binary_trace
+
+BinaryTraceWriter::BinaryTraceWriter(const std::string& filename, uint32_t records_per_block, bool core_ids,
+                                     bool timestamps)
+    : file_(filename, std::ios::binary | std::ios::trunc), records_per_block_(records_per_block),
+      record_count_(0), block_count_(0), payload_checksum_(binary_trace::checksum(nullptr, 0)),
+      core_ids_(core_ids), timestamps_(timestamps), finished_(false) {
+    if (!file_) {
+        throw std::runtime_error("Cannot create trace file: " + filename);
+    }
+    if (records_per_block_ == 0) {
+        throw std::invalid_argument("Records per block must be positive");
+    }
+    pending_.reserve(records_per_block_);
+    writeHeader(); // Placeholder, rewritten by finish()
+}
+
+BinaryTraceWriter::~BinaryTraceWriter() {
+    if (!finished_) {
+        try {
+            finish();
+        } catch (...) {
+        }
+    }
+}
+
+void BinaryTraceWriter::write(const TraceRecord& record) {
+    if (record.core != 0 && !core_ids_) {
+        throw std::invalid_argument("Record with core id " + std::to_string(record.core) +
+                                    " in a trace written without core ids");
+    }
+    if (record.timestamp != 0 && !timestamps_) {
+        throw std::invalid_argument("Record with timestamp " + std::to_string(record.timestamp) +
+                                    " in a trace written without timestamps");
+    }
+    pending_.push_back(record);
+    if (pending_.size() == records_per_block_) {
+        flushBlock();
+    }
+}
+
+void BinaryTraceWriter::finish() {
+    if (finished_) return;
+    flushBlock();
+    file_.seekp(0);
+    writeHeader();
+    file_.flush();
+    finished_ = true;
+    if (!file_) {
+        throw std::runtime_error("Failed to write binary trace");
+    }
+}
+
+void BinaryTraceWriter::flushBlock() {
+    if (pending_.empty()) return;
+    
+    payload_.assign((pending_.size() + 7) / 8, 0);
+    for (size_t i = 0; i < pending_.size(); ++i) {
+        if (pending_[i].operation == Cache::Operation::WRITE) {
+            payload_[i / 8] |= static_cast<uint8_t>(1u << (i % 8));
+        }
+    }
+    uint64_t previous = 0;
+    for (const auto& record : pending_) {
+        putVarint(payload_, zigzagEncode(record.address - previous));
+        previous = record.address;
+    }
+    if (core_ids_) {
+        for (const auto& record : pending_) {
+            putVarint(payload_, record.core);
+        }
+    }
+    if (timestamps_) {
+        previous = 0;
+        for (const auto& record : pending_) {
+            putVarint(payload_, zigzagEncode(record.timestamp - previous));
+            previous = record.timestamp;
+        }
+    }
+    
+    uint64_t block_checksum = binary_trace::checksum(payload_.data(), payload_.size());
+    uint8_t header[binary_trace::kBlockHeaderSize];
+    putU32(header, static_cast<uint32_t>(pending_.size()));
+    putU32(header + 4, static_cast<uint32_t>(payload_.size()));
+    putU64(header + 8, block_checksum);
+    file_.write(reinterpret_cast<const char*>(header), sizeof(header));
+    file_.write(reinterpret_cast<const char*>(payload_.data()), payload_.size());
+    
+    payload_checksum_ = binary_trace::checksum(header + 8, 8, payload_checksum_);
+    record_count_ += pending_.size();
+    ++block_count_;
+    pending_.clear();
+}
+
+void BinaryTraceWriter::writeHeader() {
+    uint8_t header[binary_trace::kHeaderSize] = {};
+    std::memcpy(header, binary_trace::kMagic, sizeof(binary_trace::kMagic));
+    putU16(header + 4, binary_trace::kVersion);
+    putU16(header + 6, static_cast<uint16_t>((core_ids_ ? binary_trace::kFlagCoreIds : 0) |
+                                             (timestamps_ ? binary_trace::kFlagTimestamps : 0)));
+    putU64(header + 8, record_count_);
+    putU64(header + 16, block_count_);
+    putU32(header + 24, records_per_block_);
+    putU32(header + 28, 0);
+    putU64(header + 32, payload_checksum_);
+    putU64(header + 40, binary_trace::checksum(header, 40));
+    file_.write(reinterpret_cast<const char*>(header), sizeof(header));
+}
+
+BinaryTraceReader::BinaryTraceReader(const std::string& filename)
+    : file_(filename), record_count_(0), core_ids_(false), timestamps_(false), next_block_(0), decoded_pos_(0) {
+    const uint8_t* data = reinterpret_cast<const uint8_t*>(file_.data());
+    size_t size = file_.size();
+    
+    if (size < binary_trace::kHeaderSize) {
+        throw std::runtime_error("Not a binary trace: " + filename);
+    }
+    checkHeader(data, filename);
+    
+    record_count_ = getU64(data + 8);
+    core_ids_ = (getU16(data + 6) & binary_trace::kFlagCoreIds) != 0;
+    timestamps_ = (getU16(data + 6) & binary_trace::kFlagTimestamps) != 0;
+    uint64_t block_count = getU64(data + 16);
+    
+    // Walk the block headers so blocks can be located without decoding them
+    uint64_t payload_checksum = binary_trace::checksum(nullptr, 0);
+    uint64_t records = 0;
+    size_t offset = binary_trace::kHeaderSize;
+    for (uint64_t i = 0; i < block_count; ++i) {
+        if (size - offset < binary_trace::kBlockHeaderSize) {
+            throw std::runtime_error("Truncated binary trace: " + filename);
+        }
+        uint32_t block_records = getU32(data + offset);
+        uint32_t payload_bytes = getU32(data + offset + 4);
+        if (size - offset - binary_trace::kBlockHeaderSize < payload_bytes) {
+            throw std::runtime_error("Truncated binary trace: " + filename);
+        }
+        payload_checksum = binary_trace::checksum(data + offset + 8, 8, payload_checksum);
+        blocks_.push_back(BlockInfo{offset, block_records});
+        records += block_records;
+        offset += binary_trace::kBlockHeaderSize + payload_bytes;
+    }
+    
+    if (records != record_count_ || payload_checksum != getU64(data + 32)) {
+        throw std::runtime_error("Corrupted binary trace: " + filename);
+    }
+}
+
+void BinaryTraceReader::decodeBlock(size_t block_index, std::vector<TraceRecord>& out) const {
+    const uint8_t* header = reinterpret_cast<const uint8_t*>(file_.data()) + blocks_.at(block_index).offset;
+    decodePayload(header, header + binary_trace::kBlockHeaderSize, block_index, core_ids_, timestamps_, out);
+}
+
+size_t BinaryTraceReader::read(std::vector<TraceRecord>& out, size_t max_records) {
+    size_t before = out.size();
+    while (out.size() - before < max_records) {
+        if (decoded_pos_ == decoded_.size()) {
+            if (next_block_ == blocks_.size()) break;
+            decoded_.clear();
+            decoded_pos_ = 0;
+            decodeBlock(next_block_++, decoded_);
+            continue;
+        }
+        size_t count = std::min(decoded_.size() - decoded_pos_, max_records - (out.size() - before));
+        out.insert(out.end(), decoded_.begin() + decoded_pos_, decoded_.begin() + decoded_pos_ + count);
+        decoded_pos_ += count;
+    }
+    return out.size() - before;
+}
+
+GzipBinaryTraceReader::GzipBinaryTraceReader(const std::string& filename)
+    : stream_(filename), filename_(filename), record_count_(0), expected_checksum_(0), core_ids_(false),
+      timestamps_(false),
+      records_seen_(0), payload_checksum_(binary_trace::checksum(nullptr, 0)), block_index_(0),
+      done_(false), decoded_pos_(0) {
+    uint8_t header[binary_trace::kHeaderSize];
+    if (stream_.read(reinterpret_cast<char*>(header), sizeof(header)) != sizeof(header)) {
+        throw std::runtime_error("Not a binary trace: " + filename);
+    }
+    checkHeader(header, filename);
+    record_count_ = getU64(header + 8);
+    expected_checksum_ = getU64(header + 32);
+    core_ids_ = (getU16(header + 6) & binary_trace::kFlagCoreIds) != 0;
+    timestamps_ = (getU16(header + 6) & binary_trace::kFlagTimestamps) != 0;
+}
+
+size_t GzipBinaryTraceReader::read(std::vector<TraceRecord>& out, size_t max_records) {
+    size_t before = out.size();
+    while (out.size() - before < max_records) {
+        if (decoded_pos_ == decoded_.size()) {
+            if (done_) break;
+            
+            uint8_t header[binary_trace::kBlockHeaderSize];
+            size_t got = stream_.read(reinterpret_cast<char*>(header), sizeof(header));
+            if (got == 0) {
+                done_ = true;
+                if (records_seen_ != record_count_ || payload_checksum_ != expected_checksum_) {
+                    throw std::runtime_error("Corrupted binary trace: " + filename_);
+                }
+                break;
+            }
+            
+            uint32_t payload_bytes = getU32(header + 4);
+            payload_.resize(payload_bytes);
+            if (got != sizeof(header) ||
+                stream_.read(reinterpret_cast<char*>(payload_.data()), payload_bytes) != payload_bytes) {
+                throw std::runtime_error("Truncated binary trace: " + filename_);
+            }
+            
+            decoded_.clear();
+            decoded_pos_ = 0;
+            decodePayload(header, payload_.data(), block_index_++, core_ids_, timestamps_, decoded_);
+            records_seen_ += decoded_.size();
+            payload_checksum_ = binary_trace::checksum(header + 8, 8, payload_checksum_);
+            continue;
+        }
+        size_t count = std::min(decoded_.size() - decoded_pos_, max_records - (out.size() - before));
+        out.insert(out.end(), decoded_.begin() + decoded_pos_, decoded_.begin() + decoded_pos_ + count);
+        decoded_pos_ += count;
+    }
+    return out.size() - before;
+}
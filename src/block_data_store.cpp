@@ -0,0 +1,19 @@
+#include "block_data_store.h"
+#include <cstring>
+#include <new>
+
+BlockDataStore::BlockDataStore(size_t num_blocks, size_t block_size)
+    : num_blocks_(num_blocks), block_size_(block_size),
+      arena_(static_cast<uint8_t*>(std::calloc(num_blocks * block_size, 1))) {
+    if (!arena_ && num_blocks * block_size > 0) {
+        throw std::bad_alloc();
+    }
+}
+
+void BlockDataStore::clearBlock(size_t slot) {
+    std::memset(block(slot), 0, block_size_);
+}
+
+void BlockDataStore::clear() {
+    std::memset(arena_.get(), 0, getSizeBytes());
+}
@@ -0,0 +1,39 @@
+#include "block_index.h"
+#include <algorithm>
+
+BlockIndex::BlockIndex(size_t capacity) {
+    size_t buckets = 16;
+    unsigned bits = 4;
+    while (buckets < 2 * capacity) {
+        buckets <<= 1;
+        ++bits;
+    }
+    keys_.assign(buckets, 0);
+    slots_.assign(buckets, kEmpty);
+    mask_ = buckets - 1;
+    shift_ = 64 - bits;
+}
+
+void BlockIndex::erase(uint64_t key) {
+    size_t i = bucket(key);
+    while (slots_[i] != kEmpty && keys_[i] != key) {
+        i = (i + 1) & mask_;
+    }
+    if (slots_[i] == kEmpty) return;
+    
+    // Shift later members of the probe run back so lookups never stop early
+    size_t hole = i;
+    for (size_t j = (i + 1) & mask_; slots_[j] != kEmpty; j = (j + 1) & mask_) {
+        size_t home = bucket(keys_[j]);
+        if (((j - home) & mask_) >= ((j - hole) & mask_)) {
+            keys_[hole] = keys_[j];
+            slots_[hole] = slots_[j];
+            hole = j;
+        }
+    }
+    slots_[hole] = kEmpty;
+}
+
+void BlockIndex::clear() {
+    std::fill(slots_.begin(), slots_.end(), kEmpty);
+}
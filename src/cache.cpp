@@ -1,8 +1,21 @@
 #include "cache.h"
-#include <cmath>
+#include <iostream>
 #include <sstream>
 #include <stdexcept>
 
+namespace {
+
+// Integer log2, rounded down like the field widths of non-power-of-two sizes
+size_t floorLog2(size_t value) {
+    size_t bits = 0;
+    while (value >>= 1) {
+        ++bits;
+    }
+    return bits;
+}
+
+} // namespace
+
 Cache::Cache(size_t cache_size, size_t block_size, size_t associativity)
     : cache_size_(cache_size), block_size_(block_size), associativity_(associativity) {
     
@@ -35,8 +48,8 @@ Cache::Cache(size_t cache_size, size_t block_size, size_t associativity)
 
 void Cache::calculateBitMasks() {
     // Calculate number of bits for each field
-    offset_bits_ = static_cast<size_t>(std::log2(block_size_));
-    index_bits_ = static_cast<size_t>(std::log2(num_sets_));
+    offset_bits_ = floorLog2(block_size_);
+    index_bits_ = floorLog2(num_sets_);
     
     // Create masks
     offset_mask_ = (1ULL << offset_bits_) - 1;
@@ -44,16 +57,26 @@ void Cache::calculateBitMasks() {
     tag_mask_ = ~((1ULL << (offset_bits_ + index_bits_)) - 1);
 }
 
-size_t Cache::getSetIndex(uint64_t address) const {
-    return (address >> offset_bits_) & index_mask_;
+void Cache::printCacheContents() const {
+    std::cout << "\nCache contents are not available for this cache type.\n\n";
 }
 
-uint64_t Cache::getTag(uint64_t address) const {
-    return address >> (offset_bits_ + index_bits_);
-}
-
-size_t Cache::getBlockOffset(uint64_t address) const {
-    return address & offset_mask_;
+Cache::BatchResult Cache::accessBatch(const uint64_t* addresses, const Operation* operations,
+                                      size_t count, AccessResult* results) {
+    BatchResult batch;
+    for (size_t i = 0; i < count; ++i) {
+        AccessResult result = access(addresses[i], operations[i]);
+        switch (result) {
+            case AccessResult::HIT: batch.read_hits++; break;
+            case AccessResult::MISS: batch.read_misses++; break;
+            case AccessResult::WRITE_HIT: batch.write_hits++; break;
+            case AccessResult::WRITE_MISS: batch.write_misses++; break;
+        }
+        if (results) {
+            results[i] = result;
+        }
+    }
+    return batch;
 }
 
 std::string Cache::getConfig() const {
@@ -0,0 +1,369 @@
+#include "cache_hierarchy.h"
+#include <algorithm>
+#include <cctype>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+
+CacheHierarchy::CacheHierarchy(const std::vector<LevelSpec>& levels)
+    : memory_reads_(0), memory_writes_(0), read_source_(0), demand_source_(kNoFetch) {
+    if (levels.empty()) {
+        throw std::invalid_argument("Cache hierarchy needs at least one level");
+    }
+    
+    for (size_t i = 0; i < levels.size(); ++i) {
+        if (levels[i].cache.block_size != levels[0].cache.block_size) {
+            throw std::invalid_argument("All hierarchy levels must use the same block size");
+        }
+        // Lower levels are driven through touchBlock/insertBlock, which do not train a prefetcher
+        if (i > 0 && levels[i].cache.hasPrefetcher()) {
+            throw std::invalid_argument("Only the first hierarchy level can have a prefetcher");
+        }
+        // Nor do they probe a victim or miss cache, so it would only delay evictions
+        if (i > 0 && levels[i].cache.hasVictimCache()) {
+            throw std::invalid_argument("Only the first hierarchy level can have a victim or miss cache");
+        }
+        levels_.push_back(levels[i].cache.createCache());
+        inclusion_.push_back(levels[i].inclusion);
+        links_.push_back(std::make_unique<Link>(*this, i));
+        levels_.back()->setLowerLevel(links_.back().get());
+    }
+    
+    statistics_.resize(levels_.size() - 1);
+    counters_.resize(levels_.size());
+    
+    // A level's miss penalty stands for memory, so only the last one counts
+    latency_.assign(levels_.size() + 2, 0);
+    for (size_t i = 0; i < levels.size(); ++i) {
+        latency_[i] = (i > 0 ? latency_[i - 1] : 0) + levels[i].cache.hit_latency;
+    }
+    latency_[levels_.size()] = latency_[levels_.size() - 1] + levels.back().cache.miss_penalty;
+    latency_[levels_.size() + 1] = latency_[0] + TimingModel::kVictimCacheCycles;
+    for (auto& served : served_) {
+        served.assign(latency_.size(), 0);
+    }
+}
+
+bool CacheHierarchy::Link::read(uint64_t address) {
+    bool dirty = hierarchy_.readLevel(level_ + 1, address);
+    if (level_ == 0) {
+        hierarchy_.demand_source_ = hierarchy_.read_source_;
+    }
+    return dirty;
+}
+
+Cache::AccessResult CacheHierarchy::access(uint64_t address, Cache::Operation operation) {
+    demand_source_ = kNoFetch;
+    Cache::AccessResult result = levels_[0]->access(address, operation);
+    recordServed(operation, result);
+    return result;
+}
+
+Cache::BatchResult CacheHierarchy::accessBatch(const uint64_t* addresses, const Cache::Operation* operations,
+                                               size_t count, Cache::AccessResult* results) {
+    // Every miss already crosses the virtual lower-level port, so going
+    // access by access to attribute latencies costs little
+    Cache::BatchResult batch;
+    for (size_t i = 0; i < count; ++i) {
+        Cache::AccessResult result = access(addresses[i], operations[i]);
+        switch (result) {
+            case Cache::AccessResult::HIT: batch.read_hits++; break;
+            case Cache::AccessResult::MISS: batch.read_misses++; break;
+            case Cache::AccessResult::WRITE_HIT: batch.write_hits++; break;
+            case Cache::AccessResult::WRITE_MISS: batch.write_misses++; break;
+        }
+        if (results) {
+            results[i] = result;
+        }
+    }
+    return batch;
+}
+
+void CacheHierarchy::recordServed(Cache::Operation operation, Cache::AccessResult result) {
+    bool write = operation == Cache::Operation::WRITE;
+    size_t source;
+    if (result == Cache::AccessResult::HIT || result == Cache::AccessResult::WRITE_HIT) {
+        source = 0;
+    } else if (demand_source_ != kNoFetch) {
+        source = demand_source_;
+    } else if (!write || levels_[0]->getWriteMissPolicy() == SetAssociativeCache::WriteMissPolicy::WRITE_ALLOCATE) {
+        // A miss that allocated without fetching found the block in the victim or miss cache
+        source = levels_.size() + 1;
+    } else {
+        // No-write-allocate store, absorbed by the write buffer
+        source = 0;
+    }
+    served_[write ? 1 : 0][source]++;
+}
+
+AccessTiming CacheHierarchy::getTiming() const {
+    AccessTiming timing;
+    for (size_t source = 0; source < latency_.size(); ++source) {
+        timing.reads.record(latency_[source], served_[0][source]);
+        timing.writes.record(latency_[source], served_[1][source]);
+    }
+    return timing;
+}
+
+bool CacheHierarchy::readLevel(size_t level, uint64_t address) {
+    if (level == levels_.size()) {
+        memory_reads_++;
+        read_source_ = level;
+        return false;
+    }
+    
+    SetAssociativeCache& cache = *levels_[level];
+    CacheStatistics& stats = statistics_[level - 1];
+    stats.recordRead();
+    
+    if (cache.touchBlock(address, false)) {
+        stats.recordHit();
+        read_source_ = level;
+        if (inclusion_[level] == InclusionPolicy::EXCLUSIVE) {
+            // The block moves up; its dirty state travels with it
+            bool dirty = false;
+            cache.invalidateBlock(address, &dirty);
+            return dirty;
+        }
+        return false;
+    }
+    
+    stats.recordMiss();
+    bool dirty = readLevel(level + 1, address);
+    if (inclusion_[level] == InclusionPolicy::EXCLUSIVE) {
+        return dirty;
+    }
+    cache.insertBlock(address, dirty);
+    return false;
+}
+
+void CacheHierarchy::writeLevel(size_t level, uint64_t address) {
+    if (level == levels_.size()) {
+        memory_writes_++;
+        return;
+    }
+    
+    SetAssociativeCache& cache = *levels_[level];
+    CacheStatistics& stats = statistics_[level - 1];
+    bool write_back = cache.getWritePolicy() == SetAssociativeCache::WritePolicy::WRITE_BACK;
+    stats.recordWrite();
+    
+    if (cache.touchBlock(address, write_back)) {
+        stats.recordWriteHit();
+        if (!write_back) {
+            writeLevel(level + 1, address);
+        }
+        return;
+    }
+    
+    stats.recordWriteMiss();
+    if (inclusion_[level] == InclusionPolicy::EXCLUSIVE ||
+        cache.getWriteMissPolicy() == SetAssociativeCache::WriteMissPolicy::NO_WRITE_ALLOCATE) {
+        writeLevel(level + 1, address);
+        return;
+    }
+    
+    // Write-allocate: fetch the rest of the block, then apply the write
+    bool dirty = readLevel(level + 1, address);
+    cache.insertBlock(address, dirty || write_back);
+    if (!write_back) {
+        writeLevel(level + 1, address);
+    }
+}
+
+void CacheHierarchy::writebackLevel(size_t level, uint64_t address) {
+    if (level == levels_.size()) {
+        memory_writes_++;
+        return;
+    }
+    
+    SetAssociativeCache& cache = *levels_[level];
+    CacheStatistics& stats = statistics_[level - 1];
+    stats.recordWrite();
+    
+    if (cache.touchBlock(address, true)) {
+        stats.recordWriteHit();
+        if (cache.getWritePolicy() == SetAssociativeCache::WritePolicy::WRITE_THROUGH) {
+            writeLevel(level + 1, address);
+        }
+        return;
+    }
+    
+    // A writeback carries the whole block, so allocating needs no fetch
+    stats.recordWriteMiss();
+    if (cache.getWriteMissPolicy() == SetAssociativeCache::WriteMissPolicy::NO_WRITE_ALLOCATE) {
+        writebackLevel(level + 1, address);
+    } else {
+        cache.insertBlock(address, true);
+    }
+}
+
+void CacheHierarchy::evictFrom(size_t level, uint64_t address, bool dirty) {
+    if (inclusion_[level] == InclusionPolicy::INCLUSIVE) {
+        // Back-invalidate upper copies; modified data leaves with the victim
+        for (size_t upper = 0; upper < level; ++upper) {
+            bool upper_dirty = false;
+            if (levels_[upper]->invalidateBlock(address, &upper_dirty)) {
+                counters_[level].back_invalidations++;
+                dirty = dirty || upper_dirty;
+            }
+        }
+    }
+    
+    if (dirty) {
+        counters_[level].writebacks++;
+    }
+    
+    size_t next = level + 1;
+    if (next < levels_.size() && inclusion_[next] == InclusionPolicy::EXCLUSIVE) {
+        counters_[next].victim_fills++;
+        levels_[next]->insertBlock(address, dirty);
+    } else if (dirty) {
+        writebackLevel(next, address);
+    }
+}
+
+CacheStatistics CacheHierarchy::getLevelStatistics(size_t level) const {
+    if (level >= levels_.size()) {
+        throw std::out_of_range("Hierarchy level out of range");
+    }
+    return level == 0 ? levels_[0]->getStatistics() : statistics_[level - 1];
+}
+
+void CacheHierarchy::resetStatistics() {
+    levels_[0]->resetStatistics();
+    for (auto& stats : statistics_) {
+        stats.reset();
+    }
+    std::fill(counters_.begin(), counters_.end(), LevelCounters{});
+    for (auto& served : served_) {
+        std::fill(served.begin(), served.end(), 0);
+    }
+    memory_reads_ = 0;
+    memory_writes_ = 0;
+}
+
+void CacheHierarchy::clear() {
+    for (auto& level : levels_) {
+        level->clear();
+    }
+    resetStatistics();
+}
+
+std::string CacheHierarchy::getReport() const {
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(2);
+    
+    uint64_t total = levels_[0]->getStatistics().getTotalAccesses();
+    oss << "Cache Hierarchy (" << levels_.size() << " levels):\n";
+    for (size_t i = 0; i < levels_.size(); ++i) {
+        const SetAssociativeCache& cache = *levels_[i];
+        CacheStatistics stats = getLevelStatistics(i);
+        const LevelCounters& counters = counters_[i];
+        double global_miss_rate = total > 0 ? (static_cast<double>(stats.getMisses()) / total) * 100.0 : 0.0;
+        
+        oss << "\nL" << (i + 1) << ": " << cache.getCacheSize() << "B, " << cache.getBlockSize() << "B blocks, ";
+        if (cache.getAssociativity() == cache.getNumBlocks() && cache.getNumSets() == 1) {
+            oss << "fully associative";
+        } else {
+            oss << cache.getAssociativity() << "-way";
+        }
+        oss << ", " << cache.getReplacementPolicy().getName()
+            << (cache.getWritePolicy() == SetAssociativeCache::WritePolicy::WRITE_BACK ? ", write-back" : ", write-through");
+        if (i > 0) {
+            oss << ", " << inclusionToString(inclusion_[i]);
+        }
+        if (cache.getPrefetcher()) {
+            oss << ", " << cache.getPrefetcher()->getName() << " prefetcher";
+        }
+        if (cache.getVictimCache()) {
+            oss << ", " << cache.getVictimCache()->getCapacity() << "-block "
+                << (cache.getVictimCache()->getMode() == VictimCache::Mode::VICTIM ? "victim" : "miss") << " cache";
+        }
+        oss << "\n";
+        oss << "  Accesses: " << stats.getTotalAccesses()
+            << " (reads " << stats.getReads() << ", writes " << stats.getWrites() << ")\n";
+        oss << "  Hits: " << stats.getHits() << "\n";
+        oss << "  Misses: " << stats.getMisses() << "\n";
+        oss << "  Local Miss Rate: " << stats.getMissRate() << "%\n";
+        oss << "  Global Miss Rate: " << global_miss_rate << "%\n";
+        oss << "  Writebacks: " << counters.writebacks << "\n";
+        oss << "  Traffic Below: " << stats.getMemoryReadBytes() << " bytes read, "
+            << stats.getMemoryWriteBytes() << " bytes written\n";
+        if (inclusion_[i] == InclusionPolicy::INCLUSIVE) {
+            oss << "  Back-Invalidations: " << counters.back_invalidations << "\n";
+        }
+        if (inclusion_[i] == InclusionPolicy::EXCLUSIVE) {
+            oss << "  Victim Fills: " << counters.victim_fills << "\n";
+        }
+        if (cache.getPrefetcher()) {
+            oss << "  Prefetches: " << stats.getPrefetches()
+                << " (useful " << stats.getUsefulPrefetches() << ", late " << stats.getLatePrefetches()
+                << ", unused " << stats.getUnusedPrefetches() << ", polluting " << stats.getPollutingPrefetches() << ")\n";
+        }
+        if (cache.getVictimCache()) {
+            oss << "  Victim Cache Hits: " << stats.getVictimHits() << "\n";
+        }
+    }
+    oss << "\nMemory:\n";
+    oss << "  Reads: " << memory_reads_ << "\n";
+    oss << "  Writes: " << memory_writes_ << "\n";
+    
+    oss << "\n" << getTiming().toString();
+    
+    return oss.str();
+}
+
+std::vector<CacheHierarchy::LevelSpec> CacheHierarchy::parseSpec(const std::string& spec, const CacheSpec& base) {
+    std::vector<LevelSpec> levels;
+    
+    for (const auto& level_text : CacheSpec::splitList(spec, ';')) {
+        LevelSpec level;
+        level.cache = base;
+        if (!levels.empty()) {
+            // A prefetcher or victim cache from the base configuration belongs to L1
+            level.cache.prefetcher = "NONE";
+            level.cache.victim_cache = 0;
+            level.cache.miss_cache = 0;
+        }
+        for (const auto& entry : CacheSpec::splitList(level_text, ',')) {
+            size_t eq = entry.find('=');
+            if (eq == std::string::npos) {
+                throw std::invalid_argument("Expected key=value in hierarchy level: " + entry);
+            }
+            std::string key = CacheSpec::trim(entry.substr(0, eq));
+            std::string value = CacheSpec::trim(entry.substr(eq + 1));
+            if (key == "i" || key == "inclusion") {
+                level.inclusion = stringToInclusion(value);
+            } else if (!level.cache.setParameter(key, value)) {
+                throw std::invalid_argument("Unknown hierarchy parameter: " + key);
+            }
+        }
+        levels.push_back(level);
+    }
+    
+    if (levels.empty()) {
+        throw std::invalid_argument("Empty cache hierarchy description");
+    }
+    return levels;
+}
+
+CacheHierarchy::InclusionPolicy CacheHierarchy::stringToInclusion(const std::string& name) {
+    std::string upper = name;
+    std::transform(upper.begin(), upper.end(), upper.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::toupper(c)); });
+    
+    if (upper == "NON_INCLUSIVE") return InclusionPolicy::NON_INCLUSIVE;
+    if (upper == "INCLUSIVE") return InclusionPolicy::INCLUSIVE;
+    if (upper == "EXCLUSIVE") return InclusionPolicy::EXCLUSIVE;
+    
+    throw std::invalid_argument("Unknown inclusion policy: " + name);
+}
+
+const char* CacheHierarchy::inclusionToString(InclusionPolicy inclusion) {
+    switch (inclusion) {
+        case InclusionPolicy::INCLUSIVE: return "INCLUSIVE";
+        case InclusionPolicy::EXCLUSIVE: return "EXCLUSIVE";
+        default: return "NON_INCLUSIVE";
+    }
+}
@@ -0,0 +1,182 @@
+#include "cache_spec.h"
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+
+size_t parseSize(const std::string& value) {
+    size_t pos = 0;
+    unsigned long long number;
+    try {
+        number = std::stoull(value, &pos, 0);
+    } catch (const std::exception&) {
+        throw std::invalid_argument("Invalid size: " + value);
+    }
+    std::string suffix = value.substr(pos);
+    if (suffix == "K" || suffix == "k") {
+        number <<= 10;
+    } else if (suffix == "M" || suffix == "m") {
+        number <<= 20;
+    } else if (!suffix.empty()) {
+        throw std::invalid_argument("Invalid size: " + value);
+    }
+    return static_cast<size_t>(number);
+}
+
+std::string toUpper(std::string str) {
+    std::transform(str.begin(), str.end(), str.begin(), ::toupper);
+    return str;
+}
+
+} // namespace
+
+std::string CacheSpec::trim(const std::string& str) {
+    size_t begin = str.find_first_not_of(" \t");
+    if (begin == std::string::npos) return "";
+    size_t end = str.find_last_not_of(" \t");
+    return str.substr(begin, end - begin + 1);
+}
+
+std::vector<std::string> CacheSpec::splitList(const std::string& str, char delimiter) {
+    std::vector<std::string> tokens;
+    std::stringstream ss(str);
+    std::string token;
+    while (std::getline(ss, token, delimiter)) {
+        token = trim(token);
+        if (!token.empty()) {
+            tokens.push_back(token);
+        }
+    }
+    return tokens;
+}
+
+bool CacheSpec::setParameter(const std::string& key, const std::string& value) {
+    if (key == "s" || key == "cache-size") {
+        cache_size = parseSize(value);
+    } else if (key == "b" || key == "block-size") {
+        block_size = parseSize(value);
+    } else if (key == "a" || key == "associativity") {
+        associativity = parseSize(value);
+    } else if (key == "r" || key == "replacement") {
+        replacement_policy = toUpper(value);
+    } else if (key == "w" || key == "write-policy") {
+        write_policy = toUpper(value);
+    } else if (key == "m" || key == "write-miss") {
+        write_miss_policy = toUpper(value);
+    } else if (key == "p" || key == "prefetcher") {
+        prefetcher = toUpper(value);
+    } else if (key == "prefetch-degree") {
+        prefetch_degree = parseSize(value);
+    } else if (key == "prefetch-distance") {
+        prefetch_distance = parseSize(value);
+    } else if (key == "prefetch-latency") {
+        prefetch_latency = parseSize(value);
+    } else if (key == "victim-cache") {
+        victim_cache = parseSize(value);
+    } else if (key == "miss-cache") {
+        miss_cache = parseSize(value);
+    } else if (key == "hit-latency") {
+        hit_latency = parseSize(value);
+    } else if (key == "miss-penalty") {
+        miss_penalty = parseSize(value);
+    } else {
+        return false;
+    }
+    return true;
+}
+
+std::unique_ptr<SetAssociativeCache> CacheSpec::createCache(std::shared_ptr<const NextUseIndex> next_use) const {
+    if (cache_size == 0 || block_size == 0) {
+        throw std::invalid_argument("Cache size and block size must be greater than 0");
+    }
+    
+    if (cache_size % block_size != 0) {
+        throw std::invalid_argument("Cache size must be a multiple of block size");
+    }
+    
+    // Create replacement policy
+    auto policy_type = ReplacementPolicyFactory::stringToPolicy(replacement_policy);
+    
+    size_t num_sets, actual_associativity;
+    if (associativity == 0) {
+        // Fully associative
+        num_sets = 1;
+        actual_associativity = cache_size / block_size;
+    } else {
+        // Direct mapped or set associative
+        actual_associativity = associativity;
+        num_sets = cache_size / (block_size * actual_associativity);
+    }
+    
+    auto prefetcher_type = PrefetcherFactory::stringToPrefetcher(prefetcher);
+    if (prefetcher_type != PrefetcherFactory::PrefetcherType::NONE &&
+        policy_type == ReplacementPolicyFactory::PolicyType::OPT) {
+        throw std::invalid_argument("OPT replacement cannot be combined with a prefetcher");
+    }
+    
+    if (victim_cache > 0 && miss_cache > 0) {
+        throw std::invalid_argument("A cache can have a victim cache or a miss cache, not both");
+    }
+    
+    if (next_use && next_use->getBlockSize() != block_size) {
+        throw std::invalid_argument("Next-use index was built for a different block size");
+    }
+    auto policy = ReplacementPolicyFactory::createPolicy(policy_type, num_sets, actual_associativity,
+                                                       std::move(next_use), seed);
+    
+    // Parse write policies
+    SetAssociativeCache::WritePolicy write = (write_policy == "WRITE_BACK") ?
+        SetAssociativeCache::WritePolicy::WRITE_BACK :
+        SetAssociativeCache::WritePolicy::WRITE_THROUGH;
+    
+    SetAssociativeCache::WriteMissPolicy write_miss = (write_miss_policy == "NO_WRITE_ALLOCATE") ?
+        SetAssociativeCache::WriteMissPolicy::NO_WRITE_ALLOCATE :
+        SetAssociativeCache::WriteMissPolicy::WRITE_ALLOCATE;
+    
+    SetAssociativeCache::DataMode data_mode = track_data ?
+        SetAssociativeCache::DataMode::TRACK_DATA :
+        SetAssociativeCache::DataMode::TAG_ONLY;
+    
+    auto cache = std::make_unique<SetAssociativeCache>(cache_size, block_size, associativity,
+                                                       std::move(policy), write, write_miss, data_mode);
+    if (prefetcher_type != PrefetcherFactory::PrefetcherType::NONE) {
+        cache->setPrefetcher(PrefetcherFactory::createPrefetcher(prefetcher_type, block_size, prefetch_degree,
+                                                                 prefetch_distance),
+                             prefetch_latency);
+    }
+    if (victim_cache > 0) {
+        cache->setVictimCache(std::make_unique<VictimCache>(victim_cache, VictimCache::Mode::VICTIM));
+    } else if (miss_cache > 0) {
+        cache->setVictimCache(std::make_unique<VictimCache>(miss_cache, VictimCache::Mode::MISS));
+    }
+    return cache;
+}
+
+bool CacheSpec::needsNextUseIndex() const {
+    return ReplacementPolicyFactory::stringToPolicy(replacement_policy) == ReplacementPolicyFactory::PolicyType::OPT;
+}
+
+bool CacheSpec::hasPrefetcher() const {
+    return PrefetcherFactory::stringToPrefetcher(prefetcher) != PrefetcherFactory::PrefetcherType::NONE;
+}
+
+std::string CacheSpec::toString() const {
+    std::ostringstream oss;
+    oss << cache_size << "B/" << block_size << "B/";
+    if (associativity == 0) {
+        oss << "full";
+    } else {
+        oss << associativity << "-way";
+    }
+    oss << "/" << replacement_policy << "/" << write_policy << "/" << write_miss_policy;
+    if (prefetcher != "NONE") {
+        oss << "/" << prefetcher << ":" << prefetch_degree << ":" << prefetch_distance;
+    }
+    if (victim_cache > 0) {
+        oss << "/VC:" << victim_cache;
+    } else if (miss_cache > 0) {
+        oss << "/MC:" << miss_cache;
+    }
+    return oss.str();
+}
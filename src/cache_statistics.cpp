@@ -1,9 +1,13 @@
 #include "cache_statistics.h"
 #include <sstream>
 #include <iomanip>
+#include <algorithm>
+#include <iterator>
 
 CacheStatistics::CacheStatistics()
-    : hits_(0), misses_(0), reads_(0), writes_(0), write_hits_(0), write_misses_(0) {
+    : hits_(0), misses_(0), reads_(0), writes_(0), write_hits_(0), write_misses_(0),
+      prefetches_(0), useful_prefetches_(0), late_prefetches_(0), unused_prefetches_(0), polluting_prefetches_(0),
+      victim_hits_(0), victim_write_hits_(0), transfers_(), transfer_bytes_() {
 }
 
 void CacheStatistics::reset() {
@@ -13,6 +17,15 @@ void CacheStatistics::reset() {
     writes_ = 0;
     write_hits_ = 0;
     write_misses_ = 0;
+    prefetches_ = 0;
+    useful_prefetches_ = 0;
+    late_prefetches_ = 0;
+    unused_prefetches_ = 0;
+    polluting_prefetches_ = 0;
+    victim_hits_ = 0;
+    victim_write_hits_ = 0;
+    std::fill(std::begin(transfers_), std::end(transfers_), 0);
+    std::fill(std::begin(transfer_bytes_), std::end(transfer_bytes_), 0);
 }
 
 void CacheStatistics::recordHit() {
@@ -41,6 +54,67 @@ void CacheStatistics::recordWrite() {
     writes_++;
 }
 
+void CacheStatistics::recordBatch(uint64_t read_hits, uint64_t read_misses, uint64_t write_hits, uint64_t write_misses) {
+    reads_ += read_hits + read_misses;
+    writes_ += write_hits + write_misses;
+    hits_ += read_hits + write_hits;
+    misses_ += read_misses + write_misses;
+    write_hits_ += write_hits;
+    write_misses_ += write_misses;
+}
+
+void CacheStatistics::recordPrefetch() {
+    prefetches_++;
+}
+
+void CacheStatistics::recordPrefetchUse(bool late) {
+    if (late) {
+        late_prefetches_++;
+    } else {
+        useful_prefetches_++;
+    }
+}
+
+void CacheStatistics::recordUnusedPrefetch() {
+    unused_prefetches_++;
+}
+
+void CacheStatistics::recordPollutingPrefetch() {
+    polluting_prefetches_++;
+}
+
+void CacheStatistics::recordVictimHit(bool write) {
+    victim_hits_++;
+    if (write) {
+        victim_write_hits_++;
+    }
+}
+
+void CacheStatistics::recordTransfer(Transfer kind, uint64_t bytes) {
+    transfers_[static_cast<size_t>(kind)]++;
+    transfer_bytes_[static_cast<size_t>(kind)] += bytes;
+}
+
+void CacheStatistics::merge(const CacheStatistics& other) {
+    hits_ += other.hits_;
+    misses_ += other.misses_;
+    reads_ += other.reads_;
+    writes_ += other.writes_;
+    write_hits_ += other.write_hits_;
+    write_misses_ += other.write_misses_;
+    prefetches_ += other.prefetches_;
+    useful_prefetches_ += other.useful_prefetches_;
+    late_prefetches_ += other.late_prefetches_;
+    unused_prefetches_ += other.unused_prefetches_;
+    polluting_prefetches_ += other.polluting_prefetches_;
+    victim_hits_ += other.victim_hits_;
+    victim_write_hits_ += other.victim_write_hits_;
+    for (size_t kind = 0; kind < kTransferKinds; ++kind) {
+        transfers_[kind] += other.transfers_[kind];
+        transfer_bytes_[kind] += other.transfer_bytes_[kind];
+    }
+}
+
 double CacheStatistics::getHitRate() const {
     uint64_t total = hits_ + misses_;
     return total > 0 ? (static_cast<double>(hits_) / total) * 100.0 : 0.0;
@@ -63,6 +137,30 @@ double CacheStatistics::getWriteHitRate() const {
     return total_writes > 0 ? (static_cast<double>(write_hits_) / total_writes) * 100.0 : 0.0;
 }
 
+double CacheStatistics::getPrefetchAccuracy() const {
+    uint64_t used = useful_prefetches_ + late_prefetches_;
+    return prefetches_ > 0 ? (static_cast<double>(used) / prefetches_) * 100.0 : 0.0;
+}
+
+double CacheStatistics::getPrefetchCoverage() const {
+    // Each used prefetch turned a miss into a hit
+    uint64_t used = useful_prefetches_ + late_prefetches_;
+    return used + misses_ > 0 ? (static_cast<double>(used) / (used + misses_)) * 100.0 : 0.0;
+}
+
+double CacheStatistics::getVictimHitRate() const {
+    return misses_ > 0 ? (static_cast<double>(victim_hits_) / misses_) * 100.0 : 0.0;
+}
+
+uint64_t CacheStatistics::getMemoryReadBytes() const {
+    return getTransferBytes(Transfer::FILL) + getTransferBytes(Transfer::PREFETCH_FILL);
+}
+
+uint64_t CacheStatistics::getMemoryWriteBytes() const {
+    return getTransferBytes(Transfer::WRITEBACK) + getTransferBytes(Transfer::WRITE_THROUGH) +
+           getTransferBytes(Transfer::BYPASS);
+}
+
 std::string CacheStatistics::toString() const {
     std::ostringstream oss;
     oss << std::fixed << std::setprecision(2);
@@ -84,6 +182,44 @@ std::string CacheStatistics::toString() const {
     oss << "  Write Hits: " << write_hits_ << "\n";
     oss << "  Write Misses: " << write_misses_ << "\n";
     
+    if (prefetches_ > 0) {
+        oss << "\n";
+        oss << "  Prefetches: " << prefetches_ << "\n";
+        oss << "  Useful Prefetches: " << useful_prefetches_ << "\n";
+        oss << "  Late Prefetches: " << late_prefetches_ << "\n";
+        oss << "  Unused Prefetches: " << unused_prefetches_ << "\n";
+        oss << "  Polluting Prefetches: " << polluting_prefetches_ << "\n";
+        oss << "  Prefetch Accuracy: " << getPrefetchAccuracy() << "%\n";
+        oss << "  Prefetch Coverage: " << getPrefetchCoverage() << "%\n";
+    }
+    
+    if (victim_hits_ > 0) {
+        oss << "\n";
+        oss << "  Victim Cache Hits: " << victim_hits_ << "\n";
+        oss << "  Victim Cache Write Hits: " << victim_write_hits_ << "\n";
+        oss << "  Victim Cache Hit Rate: " << getVictimHitRate() << "%\n";
+        oss << "  Misses to Next Level: " << (misses_ - victim_hits_) << "\n";
+    }
+    
+    uint64_t traffic = getMemoryReadBytes() + getMemoryWriteBytes();
+    if (traffic > 0) {
+        static const char* const kTransferNames[kTransferKinds] = {
+            "Line Fills", "Prefetch Fills", "Writebacks", "Write-Through Stores", "Write Bypasses"
+        };
+        oss << "\n";
+        oss << "  Memory Traffic:\n";
+        for (size_t kind = 0; kind < kTransferKinds; ++kind) {
+            if (transfers_[kind] > 0) {
+                oss << "    " << kTransferNames[kind] << ": " << transfers_[kind]
+                    << " (" << transfer_bytes_[kind] << " bytes)\n";
+            }
+        }
+        oss << "    Bytes Read: " << getMemoryReadBytes() << "\n";
+        oss << "    Bytes Written: " << getMemoryWriteBytes() << "\n";
+        uint64_t accesses = getTotalAccesses();
+        oss << "    Bytes per Access: " << (accesses > 0 ? static_cast<double>(traffic) / accesses : 0.0) << "\n";
+    }
+    
     return oss.str();
 }
 
@@ -0,0 +1,283 @@
+#include "coherence.h"
+#include <algorithm>
+#include <cctype>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+
+CoherenceSimulator::CoherenceSimulator(const CacheSpec& spec, size_t cores, Protocol protocol)
+    : protocol_(protocol), counters_(cores), word_bytes_(8),
+      bus_reads_(0), bus_read_exclusives_(0), upgrades_(0), invalidations_(0),
+      cache_to_cache_(0), memory_reads_(0), memory_writes_(0) {
+    if (cores == 0 || cores > kMaxCores) {
+        throw std::invalid_argument("Core count must be between 1 and " + std::to_string(kMaxCores));
+    }
+    
+    // Prefetch fills would bypass the directory
+    if (spec.hasPrefetcher()) {
+        throw std::invalid_argument("Prefetchers cannot be combined with --cores");
+    }
+    // Blocks parked in a victim or miss cache would be invisible to the directory
+    if (spec.hasVictimCache()) {
+        throw std::invalid_argument("Victim and miss caches cannot be combined with --cores");
+    }
+    
+    // The protocols assume write-back, write-allocate private caches
+    CacheSpec private_spec = spec;
+    private_spec.write_policy = "WRITE_BACK";
+    private_spec.write_miss_policy = "WRITE_ALLOCATE";
+    
+    for (size_t core = 0; core < cores; ++core) {
+        private_spec.seed = spec.seed + core;
+        caches_.push_back(private_spec.createCache());
+        links_.push_back(std::make_unique<CoreLink>(*this, static_cast<uint32_t>(core)));
+        caches_.back()->setLowerLevel(links_.back().get());
+    }
+    
+    // Words are tracked in a 64-bit mask per line
+    word_bytes_ = std::max<size_t>(8, private_spec.block_size / 64);
+}
+
+Cache::AccessResult CoherenceSimulator::access(uint32_t core, uint64_t address, Cache::Operation operation) {
+    if (core >= caches_.size()) {
+        throw std::out_of_range("Core id " + std::to_string(core) + " out of range (" +
+                                std::to_string(caches_.size()) + " cores)");
+    }
+    
+    SetAssociativeCache& cache = *caches_[core];
+    uint64_t offset = address % cache.getBlockSize();
+    uint64_t block_address = address - offset;
+    uint64_t bit = 1ULL << core;
+    uint64_t word_mask = 1ULL << (offset / word_bytes_);
+    
+    Line& line = lines_[block_address];
+    bool present = (line.sharers & bit) != 0;
+    
+    if (operation == Cache::Operation::READ) {
+        if (!present) {
+            classifyMiss(core, line, word_mask);
+            bus_reads_++;
+            if (line.owner >= 0) {
+                // The owner supplies the data
+                cache_to_cache_++;
+                if (line.owner_state == LineState::MODIFIED && protocol_ == Protocol::MOESI) {
+                    line.owner_state = LineState::OWNED;
+                } else if (line.owner_state != LineState::OWNED) {
+                    if (line.owner_state == LineState::MODIFIED) {
+                        memory_writes_++;
+                        counters_[line.owner].writebacks++;
+                    }
+                    line.owner = -1;
+                    line.owner_state = LineState::INVALID;
+                }
+            } else {
+                memory_reads_++;
+                if (line.sharers == 0) {
+                    line.owner = static_cast<int>(core);
+                    line.owner_state = LineState::EXCLUSIVE;
+                }
+            }
+            line.sharers |= bit;
+        }
+    } else {
+        if (present) {
+            if (line.owner != static_cast<int>(core) || line.owner_state == LineState::OWNED) {
+                // Shared or Owned: invalidate the other copies
+                upgrades_++;
+                counters_[core].upgrades++;
+                invalidateOthers(core, line, block_address);
+            }
+        } else {
+            classifyMiss(core, line, word_mask);
+            bus_read_exclusives_++;
+            if (line.owner >= 0) {
+                // Dirty data moves to the writer along with ownership
+                cache_to_cache_++;
+            } else {
+                memory_reads_++;
+            }
+            invalidateOthers(core, line, block_address);
+            line.sharers = bit;
+        }
+        line.owner = static_cast<int>(core);
+        line.owner_state = LineState::MODIFIED;
+        
+        if (line.last_writer >= 0 && line.last_writer != static_cast<int>(core)) {
+            line.ping_pongs++;
+        }
+        line.last_writer = static_cast<int>(core);
+        line.writers |= bit;
+        for (auto& entry : line.invalidated) {
+            if (entry.first != core) {
+                entry.second |= word_mask;
+            }
+        }
+    }
+    
+    // Victims leave the directory through the core's link
+    return cache.access(address, operation);
+}
+
+void CoherenceSimulator::accessBatch(const TraceRecord* records, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        access(records[i].core, records[i].address, records[i].operation);
+    }
+}
+
+void CoherenceSimulator::classifyMiss(uint32_t core, Line& line, uint64_t word_mask) {
+    auto it = std::find_if(line.invalidated.begin(), line.invalidated.end(),
+                           [core](const std::pair<uint32_t, uint64_t>& entry) { return entry.first == core; });
+    if (it == line.invalidated.end()) {
+        return;
+    }
+    
+    CoreCounters& counters = counters_[core];
+    counters.coherence_misses++;
+    if (it->second & word_mask) {
+        counters.true_sharing_misses++;
+        line.true_sharing_misses++;
+    } else {
+        counters.false_sharing_misses++;
+        line.false_sharing_misses++;
+    }
+    line.invalidated.erase(it);
+}
+
+void CoherenceSimulator::invalidateOthers(uint32_t core, Line& line, uint64_t block_address) {
+    uint64_t others = line.sharers & ~(1ULL << core);
+    for (uint32_t other = 0; others != 0; ++other, others >>= 1) {
+        if (!(others & 1)) continue;
+        caches_[other]->invalidateBlock(block_address);
+        counters_[other].invalidations_received++;
+        line.invalidations++;
+        invalidations_++;
+        line.invalidated.emplace_back(other, 0);
+    }
+    line.sharers &= 1ULL << core;
+}
+
+void CoherenceSimulator::evict(uint32_t core, uint64_t block_address) {
+    auto it = lines_.find(block_address);
+    if (it == lines_.end()) {
+        return;
+    }
+    
+    Line& line = it->second;
+    line.sharers &= ~(1ULL << core);
+    if (line.owner == static_cast<int>(core)) {
+        if (line.owner_state == LineState::MODIFIED || line.owner_state == LineState::OWNED) {
+            memory_writes_++;
+            counters_[core].writebacks++;
+        }
+        line.owner = -1;
+        line.owner_state = LineState::INVALID;
+    }
+}
+
+CoherenceSimulator::LineState CoherenceSimulator::getLineState(size_t core, uint64_t address) const {
+    auto it = lines_.find(address - address % caches_.at(core)->getBlockSize());
+    if (it == lines_.end() || !(it->second.sharers & (1ULL << core))) {
+        return LineState::INVALID;
+    }
+    return it->second.owner == static_cast<int>(core) ? it->second.owner_state : LineState::SHARED;
+}
+
+std::vector<CoherenceSimulator::LineReport> CoherenceSimulator::getContendedLines(size_t limit) const {
+    std::vector<LineReport> lines;
+    for (const auto& entry : lines_) {
+        const Line& line = entry.second;
+        if (line.ping_pongs == 0 && line.invalidations == 0) continue;
+        size_t writers = 0;
+        for (uint64_t mask = line.writers; mask != 0; mask &= mask - 1) {
+            ++writers;
+        }
+        lines.push_back(LineReport{entry.first, line.ping_pongs, line.invalidations,
+                                   line.true_sharing_misses, line.false_sharing_misses, writers});
+    }
+    
+    std::sort(lines.begin(), lines.end(), [](const LineReport& a, const LineReport& b) {
+        if (a.ping_pongs != b.ping_pongs) return a.ping_pongs > b.ping_pongs;
+        if (a.invalidations != b.invalidations) return a.invalidations > b.invalidations;
+        return a.address < b.address;
+    });
+    if (limit > 0 && lines.size() > limit) {
+        lines.resize(limit);
+    }
+    return lines;
+}
+
+std::string CoherenceSimulator::getReport(size_t hot_lines) const {
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(2);
+    
+    oss << "Coherence (" << protocolToString(protocol_) << ", " << caches_.size() << " cores):\n";
+    for (size_t core = 0; core < caches_.size(); ++core) {
+        CacheStatistics stats = caches_[core]->getStatistics();
+        const CoreCounters& counters = counters_[core];
+        oss << "\nCore " << core << ":\n";
+        oss << "  Accesses: " << stats.getTotalAccesses()
+            << " (reads " << stats.getReads() << ", writes " << stats.getWrites() << ")\n";
+        oss << "  Hits: " << stats.getHits() << "\n";
+        oss << "  Misses: " << stats.getMisses() << "\n";
+        oss << "  Miss Rate: " << stats.getMissRate() << "%\n";
+        oss << "  Coherence Misses: " << counters.coherence_misses
+            << " (true sharing " << counters.true_sharing_misses
+            << ", false sharing " << counters.false_sharing_misses << ")\n";
+        oss << "  Invalidations Received: " << counters.invalidations_received << "\n";
+        oss << "  Upgrades: " << counters.upgrades << "\n";
+        oss << "  Writebacks: " << counters.writebacks << "\n";
+    }
+    
+    oss << "\nInterconnect:\n";
+    oss << "  Bus Reads: " << bus_reads_ << "\n";
+    oss << "  Bus Read-Exclusives: " << bus_read_exclusives_ << "\n";
+    oss << "  Upgrades: " << upgrades_ << "\n";
+    oss << "  Invalidations: " << invalidations_ << "\n";
+    oss << "  Cache-to-Cache Transfers: " << cache_to_cache_ << "\n";
+    oss << "  Memory Reads: " << memory_reads_ << "\n";
+    oss << "  Memory Writes: " << memory_writes_ << "\n";
+    
+    auto lines = getContendedLines(hot_lines);
+    if (!lines.empty()) {
+        oss << "\nMost Contended Lines:\n";
+        oss << "  " << std::left << std::setw(20) << "Address" << std::right
+            << std::setw(12) << "Ping-Pongs" << std::setw(15) << "Invalidations"
+            << std::setw(10) << "Writers" << std::setw(14) << "True Share"
+            << std::setw(14) << "False Share" << "\n";
+        for (const auto& line : lines) {
+            std::ostringstream address;
+            address << "0x" << std::hex << line.address;
+            oss << "  " << std::left << std::setw(20) << address.str() << std::right
+                << std::setw(12) << line.ping_pongs << std::setw(15) << line.invalidations
+                << std::setw(10) << line.writers << std::setw(14) << line.true_sharing_misses
+                << std::setw(14) << line.false_sharing_misses << "\n";
+        }
+    }
+    
+    return oss.str();
+}
+
+CoherenceSimulator::Protocol CoherenceSimulator::stringToProtocol(const std::string& name) {
+    std::string upper = name;
+    std::transform(upper.begin(), upper.end(), upper.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::toupper(c)); });
+    
+    if (upper == "MESI") return Protocol::MESI;
+    if (upper == "MOESI") return Protocol::MOESI;
+    
+    throw std::invalid_argument("Unknown coherence protocol: " + name);
+}
+
+const char* CoherenceSimulator::protocolToString(Protocol protocol) {
+    return protocol == Protocol::MOESI ? "MOESI" : "MESI";
+}
+
+const char* CoherenceSimulator::stateToString(LineState state) {
+    switch (state) {
+        case LineState::SHARED: return "S";
+        case LineState::EXCLUSIVE: return "E";
+        case LineState::OWNED: return "O";
+        case LineState::MODIFIED: return "M";
+        default: return "I";
+    }
+}
@@ -0,0 +1,119 @@
+#include "gzip_stream.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <zlib.h>
+
+GzipStream::GzipStream(const std::string& filename, size_t chunk_size, size_t chunk_count)
+    : filename_(filename), file_(nullptr), chunks_(std::max<size_t>(chunk_count, 2)),
+      filled_(0), read_index_(0), finished_(false), stop_(false), holding_(false), offset_(0) {
+    file_ = gzopen(filename.c_str(), "rb");
+    if (!file_) {
+        throw std::runtime_error("Cannot open file '" + filename + "'");
+    }
+    gzbuffer(file_, 1 << 17);
+    for (auto& chunk : chunks_) {
+        chunk.data.resize(chunk_size);
+    }
+    producer_ = std::thread(&GzipStream::produce, this);
+}
+
+GzipStream::~GzipStream() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    not_full_.notify_all();
+    producer_.join();
+    gzclose(file_);
+}
+
+void GzipStream::produce() {
+    size_t write_index = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            // One slot stays reserved for the chunk the consumer may be holding
+            not_full_.wait(lock, [this] { return stop_ || filled_ < chunks_.size() - 1; });
+            if (stop_) return;
+        }
+        
+        Chunk& chunk = chunks_[write_index];
+        int bytes = gzread(file_, chunk.data.data(), static_cast<unsigned>(chunk.data.size()));
+        
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (bytes < 0) {
+            int errnum;
+            error_ = "Decompression failed for '" + filename_ + "': " + gzerror(file_, &errnum);
+            finished_ = true;
+        } else if (bytes == 0) {
+            // A truncated stream reads as end of file with Z_BUF_ERROR set
+            int errnum;
+            gzerror(file_, &errnum);
+            if (errnum == Z_BUF_ERROR) {
+                error_ = "Unexpected end of compressed file '" + filename_ + "'";
+            }
+            finished_ = true;
+        } else {
+            chunk.size = static_cast<size_t>(bytes);
+            ++filled_;
+            write_index = (write_index + 1) % chunks_.size();
+        }
+        not_empty_.notify_one();
+        if (finished_) return;
+    }
+}
+
+void GzipStream::release() {
+    holding_ = false;
+    offset_ = 0;
+}
+
+bool GzipStream::next(const char*& data, size_t& size) {
+    release();
+    
+    std::unique_lock<std::mutex> lock(mutex_);
+    not_empty_.wait(lock, [this] { return filled_ > 0 || finished_; });
+    if (filled_ == 0) {
+        if (!error_.empty()) {
+            throw std::runtime_error(error_);
+        }
+        return false;
+    }
+    
+    Chunk& chunk = chunks_[read_index_];
+    read_index_ = (read_index_ + 1) % chunks_.size();
+    --filled_;
+    lock.unlock();
+    not_full_.notify_one();
+    
+    holding_ = true;
+    data = chunk.data.data();
+    size = chunk.size;
+    return true;
+}
+
+size_t GzipStream::read(char* buffer, size_t size) {
+    size_t copied = 0;
+    while (copied < size) {
+        if (holding_) {
+            const Chunk& chunk = chunks_[(read_index_ + chunks_.size() - 1) % chunks_.size()];
+            size_t count = std::min(size - copied, chunk.size - offset_);
+            std::memcpy(buffer + copied, chunk.data.data() + offset_, count);
+            offset_ += count;
+            copied += count;
+            if (offset_ < chunk.size) break;
+        }
+        const char* data;
+        size_t chunk_size;
+        if (!next(data, chunk_size)) break;
+    }
+    return copied;
+}
+
+bool GzipStream::isGzipFile(const std::string& filename) {
+    std::ifstream file(filename, std::ios::binary);
+    unsigned char magic[2];
+    return file.read(reinterpret_cast<char*>(magic), sizeof(magic)) && magic[0] == 0x1f && magic[1] == 0x8b;
+}
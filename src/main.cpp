@@ -1,6 +1,15 @@
 #include "set_associative_cache.h"
 #include "replacement_policy.h"
 #include "cache_statistics.h"
+#include "trace_reader.h"
+#include "cache_spec.h"
+#include "sweep.h"
+#include "stack_distance.h"
+#include "sharded_cache.h"
+#include "cache_hierarchy.h"
+#include "coherence.h"
+#include "nonblocking_cache.h"
+#include "timing.h"
 #include <iostream>
 #include <string>
 #include <vector>
@@ -10,6 +19,8 @@
 #include <fstream>
 #include <iomanip>
 #include <chrono>
+#include <cctype>
+#include <limits>
 
 // Configuration structure
 struct CacheConfig {
@@ -27,6 +38,30 @@ struct CacheConfig {
     bool help = false;                  // Show help
     bool verbose = false;               // Verbose output
     bool quiet = false;                 // Suppress console output
+    bool track_data = false;            // Keep block payloads (tag-only otherwise)
+    std::vector<std::string> sweep_grids; // Sweep grids (--sweep), empty for a single run
+    std::string sweep_format = "csv";   // Sweep output format: csv|json
+    size_t jobs = 0;                    // Sweep worker threads (0 = all cores)
+    bool output_file_set = false;       // -o given explicitly
+    std::string mrc_file = "";          // Miss-ratio curve output (--mrc)
+    size_t mrc_ways = 32;               // Largest associativity in the per-set curve
+    size_t threads = 1;                 // Set-sharded simulation threads
+    std::string hierarchy = "";         // Multi-level hierarchy (--hierarchy), empty for one cache
+    size_t cores = 0;                   // Coherent private caches (--cores), 0 for single-core
+    std::string protocol = "MESI";      // Coherence protocol: MESI|MOESI
+    uint64_t seed = RandomPolicy::kDefaultSeed; // RANDOM replacement seed
+    std::string prefetcher = "NONE";    // Prefetcher: NONE|NEXT_LINE|STRIDE|STREAM
+    size_t prefetch_degree = 1;         // Blocks prefetched per trigger
+    size_t prefetch_distance = 1;       // How far ahead to prefetch
+    uint64_t prefetch_latency = 0;      // Accesses before a prefetch arrives
+    size_t victim_cache = 0;            // Victim cache blocks, 0 for none
+    size_t miss_cache = 0;              // Miss cache blocks, 0 for none
+    std::string bandwidth_file = "";    // Per-interval traffic output (--bandwidth)
+    size_t bandwidth_interval = 100000; // Accesses per bandwidth interval
+    bool bandwidth_interval_set = false;
+    uint64_t hit_latency = 1;           // Cycles of a hit
+    uint64_t miss_penalty = 100;        // Extra cycles of a miss served by memory
+    size_t mshrs = 0;                   // Non-blocking cache MSHRs (--mshrs), 0 for a blocking cache
 };
 
 void printHelp(const char* program_name) {
@@ -36,7 +71,15 @@ void printHelp(const char* program_name) {
     std::cout << "  -s, --cache-size SIZE      Cache size in bytes (default: 1024)\n";
     std::cout << "  -b, --block-size SIZE      Block size in bytes (default: 32)\n";
     std::cout << "  -a, --associativity N      Associativity (1=direct, 0=fully, default: 4)\n";
-    std::cout << "  -r, --replacement POLICY   Replacement policy: LRU|FIFO|RANDOM (default: LRU)\n";
+    std::cout << "  -r, --replacement POLICY   Replacement policy: LRU|FIFO|RANDOM|\n";
+    std::cout << "                             TREE_PLRU|BIT_PLRU|SRRIP|BRRIP|DRRIP|LFU|ARC|\n";
+    std::cout << "                             OPT (offline optimum, needs a trace) (default: LRU)\n";
+    std::cout << "  -p, --prefetcher TYPE      Prefetcher: NONE|NEXT_LINE|STRIDE|STREAM (default: NONE)\n";
+    std::cout << "      --prefetch-degree N    Blocks prefetched per trigger (default: 1)\n";
+    std::cout << "      --prefetch-distance N  Blocks (strides for STRIDE) to prefetch ahead (default: 1)\n";
+    std::cout << "      --prefetch-latency N   Accesses before a prefetch arrives; earlier uses are late (default: 0)\n";
+    std::cout << "      --victim-cache N       Add an N-block victim cache for evicted blocks (default: none)\n";
+    std::cout << "      --miss-cache N         Add an N-block miss cache for fetched blocks (default: none)\n";
     std::cout << "  -w, --write-policy POLICY  Write policy: WRITE_THROUGH|WRITE_BACK (default: WRITE_THROUGH)\n";
     std::cout << "  -m, --write-miss POLICY    Write miss: WRITE_ALLOCATE|NO_WRITE_ALLOCATE (default: WRITE_ALLOCATE)\n";
     std::cout << "  -t, --trace-file FILE      Input trace file with memory accesses\n";
@@ -46,19 +89,56 @@ void printHelp(const char* program_name) {
     std::cout << "  -i, --interactive          Interactive mode\n";
     std::cout << "  -v, --verbose              Verbose output\n";
     std::cout << "  -q, --quiet                Suppress console output (useful with trace files)\n";
+    std::cout << "  -D, --track-data           Store block payloads (default: tag-only simulation)\n";
+    std::cout << "  -T, --threads N            Simulate disjoint set ranges on N threads (default: 1)\n";
+    std::cout << "  -S, --sweep GRID           Simulate a grid of configurations in one pass over the trace\n";
+    std::cout << "                             (repeatable; @FILE reads one grid per line)\n";
+    std::cout << "      --sweep-format FMT     Sweep output format: csv|json (default: csv)\n";
+    std::cout << "  -j, --jobs N               Sweep worker threads (default: all cores)\n";
+    std::cout << "      --mrc FILE             Write exact LRU miss-ratio curves for the trace to FILE\n";
+    std::cout << "      --mrc-ways N           Largest associativity in the per-set curve (default: 32)\n";
+    std::cout << "  -H, --hierarchy SPEC       Simulate a multi-level hierarchy (';'-separated levels, L1 first)\n";
+    std::cout << "      --cores N              Simulate N coherent private caches; the trace's third\n";
+    std::cout << "                             column selects the core (default: single core)\n";
+    std::cout << "      --protocol PROTO       Coherence protocol: MESI|MOESI (default: MESI)\n";
+    std::cout << "      --seed N               Seed of RANDOM replacement; equal seeds repeat a run (default: 1)\n";
+    std::cout << "      --bandwidth FILE       Write the traffic below the cache per interval to FILE (CSV)\n";
+    std::cout << "      --bandwidth-interval N Accesses per bandwidth interval (default: 100000)\n";
+    std::cout << "      --hit-latency N        Cycles of a cache hit, for simulated timing (default: 1)\n";
+    std::cout << "      --miss-penalty N       Extra cycles of a miss served by memory (default: 100)\n";
+    std::cout << "      --mshrs N              Simulate a non-blocking cache with N MSHRs (1-4096), timed\n";
+    std::cout << "                             by the trace's fourth column (default: blocking)\n";
     std::cout << "  -h, --help                 Show this help message\n\n";
     std::cout << "Examples:\n";
     std::cout << "  " << program_name << " --cache-size 2048 --associativity 8 --replacement LRU\n";
     std::cout << "  " << program_name << " -s 512 -b 16 -a 2 -r FIFO --addresses 0x0,0x10,0x20\n";
     std::cout << "  " << program_name << " --interactive\n";
     std::cout << "  " << program_name << " -t trace.txt -o results.txt -q\n";
-    std::cout << "  " << program_name << " --trace-file memory_trace.txt --verbose\n\n";
+    std::cout << "  " << program_name << " --trace-file memory_trace.txt --verbose\n";
+    std::cout << "  " << program_name << " -t trace.txt --sweep \"s=8K,32K,128K;a=1,2,4,8;r=LRU,FIFO\" -o sweep.csv\n";
+    std::cout << "  " << program_name << " -t trace.txt -b 64 -p STREAM --prefetch-degree 2 --prefetch-distance 8\n";
+    std::cout << "  " << program_name << " -t trace.txt -a 1 --sweep \"victim-cache=0,4,8\" -o victim.csv\n";
+    std::cout << "  " << program_name << " -t trace.txt --hierarchy \"s=32K,a=8,w=WRITE_BACK;s=1M,a=16,w=WRITE_BACK,i=INCLUSIVE\"\n\n";
+    std::cout << "Sweep Grid Format:\n";
+    std::cout << "  ';'-separated key=value,value,... entries; all combinations are simulated.\n";
+    std::cout << "  Keys: s|cache-size, b|block-size, a|associativity, r|replacement,\n";
+    std::cout << "        w|write-policy, m|write-miss, p|prefetcher, prefetch-degree,\n";
+    std::cout << "        prefetch-distance, prefetch-latency, victim-cache, miss-cache,\n";
+    std::cout << "        hit-latency, miss-penalty.\n";
+    std::cout << "        Sizes accept K and M suffixes.\n";
+    std::cout << "  Unlisted parameters come from the other options.\n\n";
+    std::cout << "Hierarchy Format:\n";
+    std::cout << "  ';'-separated levels of ','-separated key=value pairs using the sweep keys\n";
+    std::cout << "  plus i|inclusion: NON_INCLUSIVE|INCLUSIVE|EXCLUSIVE (default: NON_INCLUSIVE).\n";
+    std::cout << "  All levels share one block size.\n\n";
     std::cout << "Trace File Format:\n";
-    std::cout << "  Each line: <operation> <address>\n";
+    std::cout << "  Each line: <operation> <address> [core [timestamp]]\n";
     std::cout << "  Example: R 0x400000\n";
     std::cout << "           W 0x400004\n";
     std::cout << "           READ 0x400008\n";
-    std::cout << "           WRITE 0x40000C\n\n";
+    std::cout << "           WRITE 0x40000C\n";
+    std::cout << "  Binary traces written by trace_convert and gzip-compressed traces\n";
+    std::cout << "  are detected automatically.\n\n";
     std::cout << "Note: If no trace file or addresses are specified, default test pattern will be used.\n";
 }
 
@@ -83,71 +163,111 @@ uint64_t parseAddress(const std::string& addr_str) {
     }
 }
 
-// Function to read trace file and populate addresses and operations
-bool readTraceFile(const std::string& filename, std::vector<uint64_t>& addresses, std::vector<std::string>& operations) {
-    std::ifstream file(filename);
-    if (!file.is_open()) {
-        std::cerr << "Error: Cannot open trace file '" << filename << "'" << std::endl;
-        return false;
+// std::stoul accepts a sign and wraps "-1" around, so counts must start with a digit and use every character
+uint64_t parseCount64(const std::string& value, const char* option, int base = 10) {
+    size_t pos = 0;
+    unsigned long long number = 0;
+    if (!value.empty() && std::isdigit(static_cast<unsigned char>(value[0]))) {
+        try {
+            number = std::stoull(value, &pos, base);
+        } catch (const std::out_of_range&) {
+            throw std::invalid_argument(std::string(option) + " is out of range: " + value);
+        }
+    }
+    if (pos == 0 || pos != value.size()) {
+        throw std::invalid_argument(std::string(option) + " expects a non-negative integer, got '" + value + "'");
     }
+    return number;
+}
+
+size_t parseCount(const std::string& value, const char* option) {
+    uint64_t number = parseCount64(value, option);
+    if (number > std::numeric_limits<size_t>::max()) {
+        throw std::invalid_argument(std::string(option) + " is out of range: " + value);
+    }
+    return static_cast<size_t>(number);
+}
+
+const char* operationToString(Cache::Operation operation) {
+    return operation == Cache::Operation::WRITE ? "WRITE" : "READ";
+}
+
+Cache::Operation parseOperation(std::string op_str) {
+    std::transform(op_str.begin(), op_str.end(), op_str.begin(), ::toupper);
+    return (op_str == "WRITE" || op_str == "W") ? Cache::Operation::WRITE : Cache::Operation::READ;
+}
+
+// Stream a trace file through simulate(addresses, operations, count) one chunk at a time, so
+// compressed traces are inflated while the cache runs and no copy of the whole trace is built
+template <typename Simulate>
+bool simulateTraceFile(const std::string& filename, Simulate simulate) {
+    constexpr size_t kReadChunk = 1 << 16;
     
-    std::string line;
-    size_t line_number = 0;
-    addresses.clear();
-    operations.clear();
+    std::unique_ptr<TraceReader> reader;
+    try {
+        reader = openTraceReader(filename);
+    } catch (const std::exception& e) {
+        std::cerr << "Error: Cannot open trace file '" << filename << "': " << e.what() << std::endl;
+        return false;
+    }
     
-    while (std::getline(file, line)) {
-        line_number++;
-        
-        // Skip empty lines and comments
-        if (line.empty() || line[0] == '#') {
-            continue;
-        }
-        
-        std::istringstream iss(line);
-        std::string operation, address_str;
-        
-        if (!(iss >> operation >> address_str)) {
-            std::cerr << "Warning: Invalid format at line " << line_number << ": '" << line << "'" << std::endl;
-            continue;
+    std::vector<TraceRecord> records;
+    std::vector<uint64_t> addresses(kReadChunk);
+    std::vector<Cache::Operation> operations(kReadChunk);
+    records.reserve(kReadChunk);
+    uint64_t total = 0;
+    size_t count;
+    while ((count = reader->read(records, kReadChunk)) > 0) {
+        for (size_t i = 0; i < count; ++i) {
+            addresses[i] = records[i].address;
+            operations[i] = records[i].operation;
         }
-        
-        // Normalize operation
-        std::transform(operation.begin(), operation.end(), operation.begin(), ::toupper);
-        if (operation == "R" || operation == "READ") {
-            operation = "READ";
-        } else if (operation == "W" || operation == "WRITE") {
-            operation = "WRITE";
-        } else {
-            std::cerr << "Warning: Unknown operation '" << operation << "' at line " << line_number << std::endl;
-            continue;
-        }
-        
-        uint64_t address = parseAddress(address_str);
-        if (address == 0 && address_str != "0" && address_str != "0x0") {
-            std::cerr << "Warning: Failed to parse address '" << address_str << "' at line " << line_number << std::endl;
-            continue;
-        }
-        
-        addresses.push_back(address);
-        operations.push_back(operation);
+        simulate(addresses.data(), operations.data(), count);
+        total += count;
+        records.clear();
     }
     
-    file.close();
-    
-    if (addresses.empty()) {
+    if (total == 0) {
         std::cerr << "Error: No valid memory accesses found in trace file '" << filename << "'" << std::endl;
         return false;
     }
     
-    std::cout << "Successfully loaded " << addresses.size() << " memory accesses from '" << filename << "'" << std::endl;
+    std::cout << "Successfully loaded " << total << " memory accesses from '" << filename << "'";
+    if (reader->getInvalidRecords() > 0) {
+        std::cout << " (" << reader->getInvalidRecords() << " invalid lines skipped)";
+    }
+    std::cout << std::endl;
     return true;
 }
 
+// Runs up to this long list every access in the report even without --verbose
+constexpr uint64_t kReportAccesses = 100;
+
+// Addresses of the default test pattern, used without a trace file or --addresses
+const std::vector<uint64_t> kDefaultAddresses = {0x0, 0x20, 0x40, 0x60, 0x80, 0x100, 0x0, 0x0};
+
+// First OPT pass: index the next use of every access in a trace file
+std::shared_ptr<const NextUseIndex> buildNextUseIndex(const std::string& filename, size_t block_size, bool quiet) {
+    if (!quiet) {
+        std::cout << "Building next-use index of '" << filename << "' for OPT (" << block_size << "B blocks)" << std::endl;
+    }
+    auto reader = openTraceReader(filename);
+    return std::make_shared<const NextUseIndex>(*reader, block_size);
+}
+
+// Print replacement policy counters, one per line
+void printPolicyCounters(std::ostream& os, const Cache::PolicyCounters& counters) {
+    for (const auto& counter : counters) {
+        os << "  " << counter.first << ": " << counter.second << "\n";
+    }
+}
+
 // Function to write statistics to file
-bool writeStatsToFile(const std::string& filename, const SetAssociativeCache& cache, const CacheConfig& config, 
-                     const std::vector<uint64_t>& addresses, const std::vector<std::string>& operations,
-                     const std::vector<Cache::AccessResult>& results, double simulation_time) {
+bool writeStatsToFile(const std::string& filename, const Cache& cache, const CacheConfig& config, 
+                     uint64_t total_accesses, const std::vector<uint64_t>& addresses,
+                     const std::vector<Cache::Operation>& operations,
+                     const std::vector<Cache::AccessResult>& results, const AccessTiming& timing,
+                     double simulation_time) {
     std::ofstream file(filename);
     if (!file.is_open()) {
         std::cerr << "Error: Cannot create output file '" << filename << "'" << std::endl;
@@ -170,7 +290,7 @@ bool writeStatsToFile(const std::string& filename, const SetAssociativeCache& ca
     // Simulation details
     file << "SIMULATION DETAILS:\n";
     file << "------------------\n";
-    file << "Total Memory Accesses: " << addresses.size() << "\n";
+    file << "Total Memory Accesses: " << total_accesses << "\n";
     file << "Simulation Time: " << std::fixed << std::setprecision(6) << simulation_time << " seconds\n";
     if (!config.trace_file.empty()) {
         file << "Input Trace File: " << config.trace_file << "\n";
@@ -182,14 +302,26 @@ bool writeStatsToFile(const std::string& filename, const SetAssociativeCache& ca
     file << "-----------------\n";
     file << cache.getStatistics() << "\n";
     
+    Cache::PolicyCounters policy_counters = cache.getPolicyCounters();
+    if (!policy_counters.empty()) {
+        file << "REPLACEMENT POLICY COUNTERS:\n";
+        file << "---------------------------\n";
+        printPolicyCounters(file, policy_counters);
+        file << "\n";
+    }
+    
+    file << "SIMULATED TIMING:\n";
+    file << "----------------\n";
+    file << timing.toString() << "\n";
+    
     // Access details (if verbose or small number of accesses)
-    if (config.verbose || addresses.size() <= 100) {
+    if (config.verbose || total_accesses <= kReportAccesses) {
         file << "ACCESS DETAILS:\n";
         file << "--------------\n";
         for (size_t i = 0; i < addresses.size(); ++i) {
             file << std::setw(6) << i + 1 << ": ";
             file << "0x" << std::hex << std::setw(8) << std::setfill('0') << addresses[i] << std::dec << std::setfill(' ');
-            file << " (" << std::setw(5) << operations[i] << ") -> ";
+            file << " (" << std::setw(5) << operationToString(operations[i]) << ") -> ";
             
             switch (results[i]) {
                 case Cache::AccessResult::HIT: file << "HIT"; break;
@@ -206,8 +338,8 @@ bool writeStatsToFile(const std::string& filename, const SetAssociativeCache& ca
     file << "PERFORMANCE SUMMARY:\n";
     file << "-------------------\n";
     auto stats = cache.getStatistics();
-    file << "Accesses per second: " << std::fixed << std::setprecision(0) << (addresses.size() / simulation_time) << "\n";
-    file << "Average access time: " << std::fixed << std::setprecision(3) << (simulation_time * 1000000 / addresses.size()) << " microseconds\n";
+    file << "Accesses per second: " << std::fixed << std::setprecision(0) << (total_accesses / simulation_time) << "\n";
+    file << "Average access time: " << std::fixed << std::setprecision(3) << (simulation_time * 1000000 / total_accesses) << " microseconds\n";
     file << "\n";
     
     file << "========================================\n";
@@ -235,6 +367,28 @@ CacheConfig parseArguments(int argc, char* argv[]) {
         {"interactive",   no_argument,       0, 'i'},
         {"verbose",       no_argument,       0, 'v'},
         {"quiet",         no_argument,       0, 'q'},
+        {"track-data",    no_argument,       0, 'D'},
+        {"threads",       required_argument, 0, 'T'},
+        {"sweep",         required_argument, 0, 'S'},
+        {"sweep-format",  required_argument, 0, 'F'},
+        {"jobs",          required_argument, 0, 'j'},
+        {"mrc",           required_argument, 0, 'M'},
+        {"mrc-ways",      required_argument, 0, 'W'},
+        {"hierarchy",     required_argument, 0, 'H'},
+        {"cores",         required_argument, 0, 'C'},
+        {"protocol",      required_argument, 0, 'P'},
+        {"seed",          required_argument, 0, 'R'},
+        {"prefetcher",    required_argument, 0, 'p'},
+        {"prefetch-degree",   required_argument, 0, 'G'},
+        {"prefetch-distance", required_argument, 0, 'K'},
+        {"prefetch-latency",  required_argument, 0, 'L'},
+        {"victim-cache",  required_argument, 0, 'V'},
+        {"miss-cache",    required_argument, 0, 'X'},
+        {"bandwidth",     required_argument, 0, 'B'},
+        {"bandwidth-interval", required_argument, 0, 'I'},
+        {"hit-latency",   required_argument, 0, 'Y'},
+        {"miss-penalty",  required_argument, 0, 'Z'},
+        {"mshrs",         required_argument, 0, 'N'},
         {"help",          no_argument,       0, 'h'},
         {0, 0, 0, 0}
     };
@@ -242,16 +396,16 @@ CacheConfig parseArguments(int argc, char* argv[]) {
     int option_index = 0;
     int c;
     
-    while ((c = getopt_long(argc, argv, "s:b:a:r:w:m:t:o:A:O:ivqh", long_options, &option_index)) != -1) {
+    while ((c = getopt_long(argc, argv, "s:b:a:r:p:w:m:t:o:A:O:ivqDT:S:j:H:h", long_options, &option_index)) != -1) {
         switch (c) {
             case 's':
-                config.cache_size = std::stoul(optarg);
+                config.cache_size = parseCount(optarg, "--cache-size");
                 break;
             case 'b':
-                config.block_size = std::stoul(optarg);
+                config.block_size = parseCount(optarg, "--block-size");
                 break;
             case 'a':
-                config.associativity = std::stoul(optarg);
+                config.associativity = parseCount(optarg, "--associativity");
                 break;
             case 'r':
                 config.replacement_policy = optarg;
@@ -276,6 +430,7 @@ CacheConfig parseArguments(int argc, char* argv[]) {
                 break;
             case 'o':
                 config.output_file = optarg;
+                config.output_file_set = true;
                 break;
             case 'A': {
                 auto addr_strs = split(optarg, ',');
@@ -301,6 +456,82 @@ CacheConfig parseArguments(int argc, char* argv[]) {
             case 'q':
                 config.quiet = true;
                 break;
+            case 'D':
+                config.track_data = true;
+                break;
+            case 'T':
+                config.threads = parseCount(optarg, "--threads");
+                break;
+            case 'S':
+                config.sweep_grids.push_back(optarg);
+                break;
+            case 'F':
+                config.sweep_format = optarg;
+                std::transform(config.sweep_format.begin(),
+                             config.sweep_format.end(),
+                             config.sweep_format.begin(), ::tolower);
+                break;
+            case 'j':
+                config.jobs = parseCount(optarg, "--jobs");
+                break;
+            case 'M':
+                config.mrc_file = optarg;
+                break;
+            case 'W':
+                config.mrc_ways = parseCount(optarg, "--mrc-ways");
+                break;
+            case 'H':
+                config.hierarchy = optarg;
+                break;
+            case 'C':
+                config.cores = parseCount(optarg, "--cores");
+                break;
+            case 'P':
+                config.protocol = optarg;
+                break;
+            case 'R':
+                config.seed = parseCount64(optarg, "--seed", 0);
+                break;
+            case 'p':
+                config.prefetcher = optarg;
+                std::transform(config.prefetcher.begin(),
+                             config.prefetcher.end(),
+                             config.prefetcher.begin(), ::toupper);
+                break;
+            case 'G':
+                config.prefetch_degree = parseCount(optarg, "--prefetch-degree");
+                break;
+            case 'K':
+                config.prefetch_distance = parseCount(optarg, "--prefetch-distance");
+                break;
+            case 'L':
+                config.prefetch_latency = parseCount64(optarg, "--prefetch-latency");
+                break;
+            case 'V':
+                config.victim_cache = parseCount(optarg, "--victim-cache");
+                break;
+            case 'X':
+                config.miss_cache = parseCount(optarg, "--miss-cache");
+                break;
+            case 'B':
+                config.bandwidth_file = optarg;
+                break;
+            case 'I':
+                config.bandwidth_interval = parseCount(optarg, "--bandwidth-interval");
+                config.bandwidth_interval_set = true;
+                break;
+            case 'Y':
+                config.hit_latency = parseCount64(optarg, "--hit-latency");
+                break;
+            case 'Z':
+                config.miss_penalty = parseCount64(optarg, "--miss-penalty");
+                break;
+            case 'N':
+                config.mshrs = parseCount(optarg, "--mshrs");
+                if (config.mshrs == 0) {
+                    throw std::invalid_argument("--mshrs needs at least one MSHR");
+                }
+                break;
             case 'h':
                 config.help = true;
                 break;
@@ -314,7 +545,7 @@ CacheConfig parseArguments(int argc, char* argv[]) {
     return config;
 }
 
-void interactiveMode(SetAssociativeCache& cache, bool verbose) {
+void interactiveMode(Cache& cache, bool verbose) {
     std::cout << "\n=== Interactive Mode ===\n";
     std::cout << "Commands:\n";
     std::cout << "  access <address> <READ|WRITE> - Access memory address\n";
@@ -369,20 +600,23 @@ void interactiveMode(SetAssociativeCache& cache, bool verbose) {
                 auto op_strs = split(ops_str, ',');
                 
                 size_t count = std::min(addr_strs.size(), op_strs.size());
+                std::vector<uint64_t> batch_addresses(count);
+                std::vector<Cache::Operation> batch_operations(count);
+                std::vector<Cache::AccessResult> batch_results(count);
                 for (size_t i = 0; i < count; ++i) {
-                    uint64_t address = parseAddress(addr_strs[i]);
-                    std::string op_str = op_strs[i];
-                    std::transform(op_str.begin(), op_str.end(), op_str.begin(), ::toupper);
-                    
-                    Cache::Operation operation = (op_str == "WRITE") ? 
+                    batch_addresses[i] = parseAddress(addr_strs[i]);
+                    std::transform(op_strs[i].begin(), op_strs[i].end(), op_strs[i].begin(), ::toupper);
+                    batch_operations[i] = (op_strs[i] == "WRITE") ? 
                         Cache::Operation::WRITE : Cache::Operation::READ;
+                }
+                
+                cache.accessBatch(batch_addresses.data(), batch_operations.data(), count, batch_results.data());
+                
+                for (size_t i = 0; i < count; ++i) {
+                    std::cout << "Access 0x" << std::hex << batch_addresses[i] << std::dec
+                             << " (" << op_strs[i] << ") -> ";
                     
-                    auto result = cache.access(address, operation);
-                    
-                    std::cout << "Access 0x" << std::hex << address << std::dec
-                             << " (" << op_str << ") -> ";
-                    
-                    switch (result) {
+                    switch (batch_results[i]) {
                         case Cache::AccessResult::HIT: std::cout << "HIT"; break;
                         case Cache::AccessResult::MISS: std::cout << "MISS"; break;
                         case Cache::AccessResult::WRITE_HIT: std::cout << "WRITE HIT"; break;
@@ -410,8 +644,329 @@ void interactiveMode(SetAssociativeCache& cache, bool verbose) {
     }
 }
 
+// Writes the bytes moved below the cache in every config.bandwidth_interval accesses to config.bandwidth_file
+class BandwidthSeries {
+public:
+    BandwidthSeries(const CacheConfig& config, const Cache& cache)
+        : interval_(config.bandwidth_interval), file_(config.bandwidth_file), before_(cache.getStatistics()),
+          index_(0), first_(0), filled_(0) {
+        if (interval_ == 0) {
+            throw std::invalid_argument("Bandwidth interval must be greater than 0");
+        }
+        if (!file_.is_open()) {
+            throw std::runtime_error("Cannot create bandwidth file: " + config.bandwidth_file);
+        }
+        file_ << "interval,first_access,accesses,read_bytes,write_bytes,bytes_per_access\n";
+        file_ << std::fixed << std::setprecision(4);
+    }
+    
+    // Simulate a chunk of accesses, writing a row whenever an interval fills up
+    void accessBatch(Cache& cache, const uint64_t* addresses, const Cache::Operation* operations, size_t count,
+                     Cache::AccessResult* results) {
+        for (size_t done = 0; done < count;) {
+            size_t n = std::min(interval_ - filled_, count - done);
+            cache.accessBatch(addresses + done, operations + done, n, results ? results + done : nullptr);
+            done += n;
+            filled_ += n;
+            if (filled_ == interval_) {
+                writeInterval(cache);
+            }
+        }
+    }
+    
+    // Write the last, partial interval
+    void finish(const Cache& cache) {
+        if (filled_ > 0) {
+            writeInterval(cache);
+        }
+    }
+    
+private:
+    size_t interval_;
+    std::ofstream file_;
+    CacheStatistics before_;
+    uint64_t index_;
+    uint64_t first_;
+    size_t filled_;
+    
+    void writeInterval(const Cache& cache) {
+        CacheStatistics after = cache.getStatistics();
+        uint64_t read_bytes = after.getMemoryReadBytes() - before_.getMemoryReadBytes();
+        uint64_t write_bytes = after.getMemoryWriteBytes() - before_.getMemoryWriteBytes();
+        file_ << index_ << "," << first_ << "," << filled_ << "," << read_bytes << "," << write_bytes << ","
+              << static_cast<double>(read_bytes + write_bytes) / filled_ << "\n";
+        before_ = after;
+        first_ += filled_;
+        filled_ = 0;
+        ++index_;
+    }
+};
+
+// Sweep mode: simulate every grid configuration in one pass over the trace
+void runSweepMode(const CacheConfig& config, const CacheSpec& base) {
+    if (config.trace_file.empty()) {
+        throw std::invalid_argument("Sweep mode requires a trace file (--trace-file)");
+    }
+    if (config.sweep_format != "csv" && config.sweep_format != "json") {
+        throw std::invalid_argument("Unknown sweep format: " + config.sweep_format);
+    }
+    
+    std::vector<CacheSpec> specs;
+    for (const auto& grid : config.sweep_grids) {
+        std::vector<std::string> lines;
+        if (!grid.empty() && grid[0] == '@') {
+            std::ifstream file(grid.substr(1));
+            if (!file.is_open()) {
+                throw std::runtime_error("Cannot open sweep file: " + grid.substr(1));
+            }
+            std::string line;
+            while (std::getline(file, line)) {
+                if (line.find_first_not_of(" \t\r") == std::string::npos || line[0] == '#') continue;
+                lines.push_back(line);
+            }
+        } else {
+            lines.push_back(grid);
+        }
+        for (const auto& line : lines) {
+            auto expanded = parseSweepGrid(line, base);
+            specs.insert(specs.end(), expanded.begin(), expanded.end());
+        }
+    }
+    
+    if (!config.quiet) {
+        std::cout << "Sweeping " << specs.size() << " configurations over " << config.trace_file << std::endl;
+    }
+    
+    // OPT needs one next-use index per block size, built before the sweep pass
+    std::vector<size_t> opt_block_sizes;
+    for (const auto& spec : specs) {
+        try {
+            if (spec.needsNextUseIndex() && spec.block_size > 0 &&
+                std::find(opt_block_sizes.begin(), opt_block_sizes.end(), spec.block_size) == opt_block_sizes.end()) {
+                opt_block_sizes.push_back(spec.block_size);
+            }
+        } catch (const std::invalid_argument&) {
+            // Unknown policies are reported when runSweep builds the caches
+        }
+    }
+    std::vector<std::shared_ptr<const NextUseIndex>> next_use;
+    for (size_t block_size : opt_block_sizes) {
+        next_use.push_back(buildNextUseIndex(config.trace_file, block_size, config.quiet));
+    }
+    
+    auto reader = openTraceReader(config.trace_file);
+    auto start_time = std::chrono::high_resolution_clock::now();
+    auto results = runSweep(*reader, specs, config.jobs, next_use);
+    auto end_time = std::chrono::high_resolution_clock::now();
+    double elapsed = std::chrono::duration<double>(end_time - start_time).count();
+    
+    std::ostringstream output;
+    if (config.sweep_format == "json") {
+        writeSweepJSON(output, results);
+    } else {
+        writeSweepCSV(output, results);
+    }
+    
+    if (config.output_file_set) {
+        std::ofstream file(config.output_file);
+        if (!file.is_open()) {
+            throw std::runtime_error("Failed to write sweep results to file: " + config.output_file);
+        }
+        file << output.str();
+        if (!config.quiet) {
+            std::cout << "Sweep results written to " << config.output_file << std::endl;
+        }
+    } else {
+        std::cout << output.str();
+    }
+    
+    if (!config.quiet) {
+        std::cout << "Simulated " << results.size() << " configurations in " << std::fixed
+                  << std::setprecision(3) << elapsed << " seconds" << std::endl;
+    }
+}
+
+// Miss-ratio curve mode: one stack-distance pass over the trace
+void runMissRatioCurveMode(const CacheConfig& config) {
+    if (config.trace_file.empty()) {
+        throw std::invalid_argument("Miss-ratio curves require a trace file (--trace-file)");
+    }
+    
+    // The per-set curve uses the set count of the configured cache
+    size_t num_sets = 1;
+    if (config.associativity != 0) {
+        num_sets = std::max<size_t>(1, config.cache_size / (config.block_size * config.associativity));
+    }
+    StackDistanceAnalyzer analyzer(config.block_size, num_sets, config.mrc_ways);
+    
+    if (!config.quiet) {
+        std::cout << "Computing LRU miss-ratio curves for " << config.trace_file
+                  << " (" << num_sets << " sets, 1-" << config.mrc_ways << " ways)" << std::endl;
+    }
+    
+    constexpr size_t kReadChunk = 1 << 16;
+    auto reader = openTraceReader(config.trace_file);
+    std::vector<TraceRecord> records;
+    records.reserve(kReadChunk);
+    while (reader->read(records, kReadChunk) > 0) {
+        for (const auto& record : records) {
+            analyzer.access(record.address);
+        }
+        records.clear();
+    }
+    
+    std::ofstream file(config.mrc_file);
+    if (!file.is_open()) {
+        throw std::runtime_error("Failed to write miss-ratio curve to file: " + config.mrc_file);
+    }
+    analyzer.writeCurve(file);
+    
+    if (!config.quiet) {
+        std::cout << "Analyzed " << analyzer.getAccesses() << " accesses (" << analyzer.getColdMisses()
+                  << " distinct blocks); curve written to " << config.mrc_file << std::endl;
+    }
+}
+
+// Hierarchy mode: stream the trace through L1 and the levels below it
+void runHierarchyMode(const CacheConfig& config, const CacheSpec& base) {
+    if (config.trace_file.empty()) {
+        throw std::invalid_argument("Hierarchy mode requires a trace file (--trace-file)");
+    }
+    
+    CacheHierarchy hierarchy(CacheHierarchy::parseSpec(config.hierarchy, base));
+    if (!config.quiet) {
+        std::cout << "Simulating " << hierarchy.getLevelCount() << "-level hierarchy over "
+                  << config.trace_file << std::endl;
+    }
+    
+    constexpr size_t kReadChunk = 1 << 16;
+    auto reader = openTraceReader(config.trace_file);
+    std::vector<TraceRecord> records;
+    std::vector<uint64_t> addresses(kReadChunk);
+    std::vector<Cache::Operation> operations(kReadChunk);
+    records.reserve(kReadChunk);
+    
+    auto start_time = std::chrono::high_resolution_clock::now();
+    size_t count;
+    while ((count = reader->read(records, kReadChunk)) > 0) {
+        for (size_t i = 0; i < count; ++i) {
+            addresses[i] = records[i].address;
+            operations[i] = records[i].operation;
+        }
+        hierarchy.accessBatch(addresses.data(), operations.data(), count);
+        records.clear();
+    }
+    auto end_time = std::chrono::high_resolution_clock::now();
+    double elapsed = std::chrono::duration<double>(end_time - start_time).count();
+    
+    std::string report = hierarchy.getReport();
+    if (!config.quiet) {
+        std::cout << "\n" << report;
+        std::cout << "\nSimulation Time: " << std::fixed << std::setprecision(3) << elapsed << " seconds" << std::endl;
+    }
+    
+    std::ofstream file(config.output_file);
+    if (!file.is_open()) {
+        throw std::runtime_error("Failed to write statistics to file: " + config.output_file);
+    }
+    file << report;
+    if (!config.quiet) {
+        std::cout << "Statistics written to " << config.output_file << std::endl;
+    }
+}
+
+// Non-blocking mode: replay the trace at its timestamps through a cache with MSHRs
+void runNonBlockingMode(const CacheConfig& config, const CacheSpec& spec) {
+    if (config.trace_file.empty()) {
+        throw std::invalid_argument("Non-blocking mode requires a trace file (--trace-file)");
+    }
+    
+    NonBlockingCache cache(spec, config.mshrs);
+    if (!config.quiet) {
+        std::cout << "Simulating a non-blocking cache with " << cache.getMshrCount() << " MSHRs over "
+                  << config.trace_file << std::endl;
+    }
+    
+    constexpr size_t kReadChunk = 1 << 16;
+    auto reader = openTraceReader(config.trace_file);
+    std::vector<TraceRecord> records;
+    records.reserve(kReadChunk);
+    
+    auto start_time = std::chrono::high_resolution_clock::now();
+    while (reader->read(records, kReadChunk) > 0) {
+        cache.accessBatch(records.data(), records.size());
+        records.clear();
+    }
+    auto end_time = std::chrono::high_resolution_clock::now();
+    double elapsed = std::chrono::duration<double>(end_time - start_time).count();
+    
+    std::ostringstream report;
+    report << cache.getCache().getConfig() << "\n" << cache.getStatistics() << "\n" << cache.getReport();
+    if (!config.quiet) {
+        std::cout << "\n" << report.str();
+        std::cout << "\nSimulation Time: " << std::fixed << std::setprecision(3) << elapsed << " seconds" << std::endl;
+    }
+    
+    std::ofstream file(config.output_file);
+    if (!file.is_open()) {
+        throw std::runtime_error("Failed to write statistics to file: " + config.output_file);
+    }
+    file << report.str();
+    if (!config.quiet) {
+        std::cout << "Statistics written to " << config.output_file << std::endl;
+    }
+}
+
+// Coherence mode: one private cache per core, kept coherent by MESI/MOESI
+void runCoherenceMode(const CacheConfig& config, const CacheSpec& spec) {
+    if (config.trace_file.empty()) {
+        throw std::invalid_argument("Coherence mode requires a trace file (--trace-file)");
+    }
+    
+    CoherenceSimulator simulator(spec, config.cores, CoherenceSimulator::stringToProtocol(config.protocol));
+    if (!config.quiet) {
+        std::cout << "Simulating " << config.cores << " cores with "
+                  << CoherenceSimulator::protocolToString(simulator.getProtocol())
+                  << " over " << config.trace_file << std::endl;
+    }
+    
+    constexpr size_t kReadChunk = 1 << 16;
+    auto reader = openTraceReader(config.trace_file);
+    std::vector<TraceRecord> records;
+    records.reserve(kReadChunk);
+    
+    auto start_time = std::chrono::high_resolution_clock::now();
+    while (reader->read(records, kReadChunk) > 0) {
+        simulator.accessBatch(records.data(), records.size());
+        records.clear();
+    }
+    auto end_time = std::chrono::high_resolution_clock::now();
+    double elapsed = std::chrono::duration<double>(end_time - start_time).count();
+    
+    std::string report = simulator.getReport();
+    if (!config.quiet) {
+        std::cout << "\n" << report;
+        std::cout << "\nSimulation Time: " << std::fixed << std::setprecision(3) << elapsed << " seconds" << std::endl;
+    }
+    
+    std::ofstream file(config.output_file);
+    if (!file.is_open()) {
+        throw std::runtime_error("Failed to write statistics to file: " + config.output_file);
+    }
+    file << report;
+    if (!config.quiet) {
+        std::cout << "Statistics written to " << config.output_file << std::endl;
+    }
+}
+
 int main(int argc, char* argv[]) {
-    CacheConfig config = parseArguments(argc, argv);
+    CacheConfig config;
+    try {
+        config = parseArguments(argc, argv);
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
     
     if (config.help) {
         printHelp(argv[0]);
@@ -419,47 +974,91 @@ int main(int argc, char* argv[]) {
     }
     
     try {
-        // Validate configuration
-        if (config.cache_size == 0 || config.block_size == 0) {
-            throw std::invalid_argument("Cache size and block size must be greater than 0");
+        // Cache configuration from the command line
+        CacheSpec spec;
+        spec.cache_size = config.cache_size;
+        spec.block_size = config.block_size;
+        spec.associativity = config.associativity;
+        spec.replacement_policy = config.replacement_policy;
+        spec.write_policy = config.write_policy;
+        spec.write_miss_policy = config.write_miss_policy;
+        spec.track_data = config.track_data;
+        spec.seed = config.seed;
+        spec.prefetcher = config.prefetcher;
+        spec.prefetch_degree = config.prefetch_degree;
+        spec.prefetch_distance = config.prefetch_distance;
+        spec.prefetch_latency = config.prefetch_latency;
+        spec.victim_cache = config.victim_cache;
+        spec.miss_cache = config.miss_cache;
+        spec.hit_latency = config.hit_latency;
+        spec.miss_penalty = config.miss_penalty;
+        
+        // The bandwidth series is only written by the single-cache simulation
+        if ((!config.bandwidth_file.empty() || config.bandwidth_interval_set) &&
+            (!config.sweep_grids.empty() || !config.mrc_file.empty() || !config.hierarchy.empty() ||
+             config.cores > 0 || config.mshrs > 0)) {
+            throw std::invalid_argument("--bandwidth and --bandwidth-interval cannot be combined with --sweep, --mrc, "
+                                        "--hierarchy, --cores or --mshrs");
         }
         
-        if (config.cache_size % config.block_size != 0) {
-            throw std::invalid_argument("Cache size must be a multiple of block size");
+        if (config.mshrs > 0) {
+            if (!config.sweep_grids.empty() || !config.mrc_file.empty() || !config.hierarchy.empty() ||
+                config.cores > 0 || config.threads > 1) {
+                throw std::invalid_argument("--mshrs cannot be combined with --sweep, --mrc, --hierarchy, "
+                                            "--cores or --threads");
+            }
+            if (spec.needsNextUseIndex()) {
+                throw std::invalid_argument("OPT replacement cannot be combined with --mshrs");
+            }
+            runNonBlockingMode(config, spec);
+            return 0;
         }
         
-        // Create replacement policy
-        auto policy_type = ReplacementPolicyFactory::stringToPolicy(config.replacement_policy);
+        if (!config.sweep_grids.empty()) {
+            runSweepMode(config, spec);
+            return 0;
+        }
         
-        size_t num_sets, actual_associativity;
-        if (config.associativity == 0) {
-            // Fully associative
-            num_sets = 1;
-            actual_associativity = config.cache_size / config.block_size;
-        } else {
-            // Direct mapped or set associative
-            actual_associativity = config.associativity;
-            num_sets = config.cache_size / (config.block_size * actual_associativity);
+        if (!config.mrc_file.empty()) {
+            runMissRatioCurveMode(config);
+            return 0;
         }
         
-        auto replacement_policy = ReplacementPolicyFactory::createPolicy(
-            policy_type, num_sets, actual_associativity);
+        if (!config.hierarchy.empty()) {
+            runHierarchyMode(config, spec);
+            return 0;
+        }
         
-        // Parse write policies
-        SetAssociativeCache::WritePolicy write_policy = 
-            (config.write_policy == "WRITE_BACK") ? 
-            SetAssociativeCache::WritePolicy::WRITE_BACK :
-            SetAssociativeCache::WritePolicy::WRITE_THROUGH;
+        if (config.cores > 0) {
+            runCoherenceMode(config, spec);
+            return 0;
+        }
         
-        SetAssociativeCache::WriteMissPolicy write_miss_policy = 
-            (config.write_miss_policy == "NO_WRITE_ALLOCATE") ?
-            SetAssociativeCache::WriteMissPolicy::NO_WRITE_ALLOCATE :
-            SetAssociativeCache::WriteMissPolicy::WRITE_ALLOCATE;
+        // OPT looks ahead, so the whole access sequence is indexed first
+        std::shared_ptr<const NextUseIndex> next_use;
+        if (spec.needsNextUseIndex()) {
+            if (config.interactive) {
+                throw std::invalid_argument("OPT replacement needs the whole trace in advance and cannot run interactively");
+            }
+            if (config.threads > 1) {
+                throw std::invalid_argument("OPT replacement cannot be combined with --threads");
+            }
+            if (!config.trace_file.empty()) {
+                next_use = buildNextUseIndex(config.trace_file, spec.block_size, config.quiet);
+            } else {
+                next_use = std::make_shared<const NextUseIndex>(
+                    config.addresses.empty() ? kDefaultAddresses : config.addresses, spec.block_size);
+            }
+        }
         
         // Create cache
-        SetAssociativeCache cache(config.cache_size, config.block_size, 
-                                 config.associativity, std::move(replacement_policy),
-                                 write_policy, write_miss_policy);
+        std::unique_ptr<Cache> cache_instance;
+        if (config.threads > 1 && !config.interactive) {
+            cache_instance = std::make_unique<ShardedCache>(spec, config.threads);
+        } else {
+            cache_instance = spec.createCache(next_use);
+        }
+        Cache& cache = *cache_instance;
         
         // Display configuration (unless quiet)
         if (!config.quiet) {
@@ -471,60 +1070,89 @@ int main(int argc, char* argv[]) {
         if (config.interactive) {
             interactiveMode(cache, config.verbose);
         } else {
-            // Determine input source
+            // Accesses and their results, kept only for the per-access listings: the console and
+            // --verbose list every access, the report lists short runs
             std::vector<uint64_t> addresses;
-            std::vector<std::string> operations;
+            std::vector<Cache::Operation> operations;
+            std::vector<Cache::AccessResult> results;
+            bool list_all = !config.quiet || config.verbose;
+            bool keep_results = true;
+            uint64_t total_accesses = 0;
+            
+            std::unique_ptr<BandwidthSeries> bandwidth;
+            if (!config.bandwidth_file.empty()) {
+                bandwidth = std::make_unique<BandwidthSeries>(config, cache);
+            }
+            auto simulate = [&](const uint64_t* chunk_addresses, const Cache::Operation* chunk_operations,
+                                size_t count) {
+                total_accesses += count;
+                if (keep_results && !list_all && total_accesses > kReportAccesses) {
+                    keep_results = false;
+                    addresses = {};
+                    operations = {};
+                    results = {};
+                }
+                Cache::AccessResult* chunk_results = nullptr;
+                if (keep_results) {
+                    addresses.insert(addresses.end(), chunk_addresses, chunk_addresses + count);
+                    operations.insert(operations.end(), chunk_operations, chunk_operations + count);
+                    results.resize(results.size() + count);
+                    chunk_results = results.data() + results.size() - count;
+                }
+                if (bandwidth) {
+                    bandwidth->accessBatch(cache, chunk_addresses, chunk_operations, count, chunk_results);
+                } else {
+                    cache.accessBatch(chunk_addresses, chunk_operations, count, chunk_results);
+                }
+            };
+            
+            // Record start time for performance measurement; trace files are read while simulating
+            auto start_time = std::chrono::high_resolution_clock::now();
             
             if (!config.trace_file.empty()) {
-                // Read from trace file
                 if (!config.quiet) {
                     std::cout << "Loading trace file: " << config.trace_file << std::endl;
                 }
-                if (!readTraceFile(config.trace_file, addresses, operations)) {
+                if (!simulateTraceFile(config.trace_file, simulate)) {
                     throw std::runtime_error("Failed to read trace file: " + config.trace_file);
                 }
-            } else if (!config.addresses.empty()) {
-                // Use command line addresses and operations
-                addresses = config.addresses;
-                operations = config.operations;
             } else {
-                // Use default test pattern
-                addresses = {0x0, 0x20, 0x40, 0x60, 0x80, 0x100, 0x0, 0x0};
-                operations = {"READ", "WRITE", "read", "WRITE", "read", "WRITE", "read", "WRITE"};
-                if (!config.quiet) {
-                    std::cout << "Using default test pattern.\n\n";
+                // Command line addresses and operations, or the default test pattern
+                std::vector<uint64_t> input_addresses = config.addresses;
+                std::vector<Cache::Operation> input_operations;
+                if (!config.addresses.empty()) {
+                    for (const auto& op_str : config.operations) {
+                        input_operations.push_back(parseOperation(op_str));
+                    }
+                } else {
+                    input_addresses = kDefaultAddresses;
+                    input_operations = {Cache::Operation::READ, Cache::Operation::WRITE, Cache::Operation::READ,
+                                        Cache::Operation::WRITE, Cache::Operation::READ, Cache::Operation::WRITE,
+                                        Cache::Operation::READ, Cache::Operation::WRITE};
+                    if (!config.quiet) {
+                        std::cout << "Using default test pattern.\n\n";
+                    }
                 }
+                input_operations.resize(input_addresses.size(), Cache::Operation::READ);
+                simulate(input_addresses.data(), input_operations.data(), input_addresses.size());
             }
-            
-            // Ensure operations match addresses
-            while (operations.size() < addresses.size()) {
-                operations.push_back("READ");
+            if (bandwidth) {
+                bandwidth->finish(cache);
             }
             
-            // Record start time for performance measurement
-            auto start_time = std::chrono::high_resolution_clock::now();
-            
-            // Simulate cache accesses
-            std::vector<Cache::AccessResult> results;
-            results.reserve(addresses.size());
+            // Record end time
+            auto end_time = std::chrono::high_resolution_clock::now();
+            auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time);
+            double simulation_time = duration.count() / 1000000.0; // Convert to seconds
+            AccessTiming timing = spec.evaluateTiming(cache.getStatistics());
             
+            // Display per-access results and statistics to console (unless quiet)
             if (!config.quiet) {
                 std::cout << "Memory Access Simulation:\n";
                 std::cout << "========================\n";
-            }
-            
-            for (size_t i = 0; i < addresses.size(); ++i) {
-                std::string op_str = (i < operations.size()) ? operations[i] : "READ";
-                std::transform(op_str.begin(), op_str.end(), op_str.begin(), ::toupper);
                 
-                Cache::Operation operation = (op_str == "WRITE") ? 
-                    Cache::Operation::WRITE : Cache::Operation::READ;
-                
-                Cache::AccessResult result = cache.access(addresses[i], operation);
-                results.push_back(result);
-                
-                // Display progress for console output (unless quiet)
-                if (!config.quiet) {
+                for (size_t i = 0; i < addresses.size(); ++i) {
+                    const char* op_str = operationToString(operations[i]);
                     if (config.verbose) {
                         std::cout << "Accessing address 0x" << std::hex << addresses[i] 
                                  << std::dec << " with operation " << op_str << " -> ";
@@ -532,7 +1160,7 @@ int main(int argc, char* argv[]) {
                         std::cout << "Access 0x" << std::hex << addresses[i] << std::dec << " (" << op_str << ") -> ";
                     }
                     
-                    switch (result) {
+                    switch (results[i]) {
                         case Cache::AccessResult::HIT:
                             std::cout << "HIT";
                             break;
@@ -548,16 +1176,14 @@ int main(int argc, char* argv[]) {
                     }
                     std::cout << std::endl;
                 }
-            }
-            
-            // Record end time
-            auto end_time = std::chrono::high_resolution_clock::now();
-            auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time);
-            double simulation_time = duration.count() / 1000000.0; // Convert to seconds
-            
-            // Display statistics to console (unless quiet)
-            if (!config.quiet) {
+                
                 std::cout << "\n" << cache.getStatistics() << std::endl;
+                Cache::PolicyCounters policy_counters = cache.getPolicyCounters();
+                if (!policy_counters.empty()) {
+                    std::cout << "Replacement Policy Counters:\n";
+                    printPolicyCounters(std::cout, policy_counters);
+                }
+                std::cout << "\n" << timing.toString();
                 
                 if (config.verbose) {
                     // Print final cache contents
@@ -570,12 +1196,16 @@ int main(int argc, char* argv[]) {
                 std::cout << "\nWriting statistics to " << config.output_file << "..." << std::endl;
             }
             
-            if (!writeStatsToFile(config.output_file, cache, config, addresses, operations, results, simulation_time)) {
+            if (!writeStatsToFile(config.output_file, cache, config, total_accesses, addresses, operations, results,
+                                  timing, simulation_time)) {
                 throw std::runtime_error("Failed to write statistics to file: " + config.output_file);
             }
             
             if (!config.quiet) {
                 std::cout << "Statistics successfully written to " << config.output_file << std::endl;
+                if (!config.bandwidth_file.empty()) {
+                    std::cout << "Bandwidth series written to " << config.bandwidth_file << std::endl;
+                }
             }
         }
         
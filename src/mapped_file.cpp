@@ -0,0 +1,57 @@
+#include "mapped_file.h"
+#include <fstream>
+#include <stdexcept>
+
+#ifndef _WIN32
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+MappedFile::MappedFile(const std::string& filename)
+    : data_(nullptr), size_(0), mapped_(false) {
+#ifndef _WIN32
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open file '" + filename + "'");
+    }
+    
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        ::close(fd);
+        throw std::runtime_error("Cannot stat file '" + filename + "'");
+    }
+    size_ = static_cast<size_t>(st.st_size);
+    
+    if (size_ > 0) {
+        void* region = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (region == MAP_FAILED) {
+            ::close(fd);
+            throw std::runtime_error("Cannot map file '" + filename + "'");
+        }
+        madvise(region, size_, MADV_SEQUENTIAL);
+        data_ = static_cast<const char*>(region);
+        mapped_ = true;
+    }
+    ::close(fd);
+#else
+    std::ifstream file(filename, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        throw std::runtime_error("Cannot open file '" + filename + "'");
+    }
+    size_ = static_cast<size_t>(file.tellg());
+    buffer_.resize(size_);
+    file.seekg(0);
+    file.read(buffer_.data(), size_);
+    data_ = buffer_.data();
+#endif
+}
+
+MappedFile::~MappedFile() {
+#ifndef _WIN32
+    if (mapped_) {
+        munmap(const_cast<char*>(data_), size_);
+    }
+#endif
+}
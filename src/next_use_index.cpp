@@ -0,0 +1,160 @@
+#include "next_use_index.h"
+#include "trace_reader.h"
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace {
+
+std::FILE* createTemporaryFile() {
+    std::FILE* file = std::tmpfile();
+    if (!file) {
+        throw std::runtime_error("Cannot create temporary file for the next-use index");
+    }
+    return file;
+}
+
+void seekTo(std::FILE* file, uint64_t offset) {
+#ifdef _WIN32
+    int status = _fseeki64(file, static_cast<__int64>(offset), SEEK_SET);
+#else
+    int status = fseeko(file, static_cast<off_t>(offset), SEEK_SET);
+#endif
+    if (status != 0) {
+        throw std::runtime_error("Cannot seek in next-use index temporary file");
+    }
+}
+
+void writeAll(std::FILE* file, const void* data, size_t size, size_t count) {
+    if (std::fwrite(data, size, count, file) != count) {
+        throw std::runtime_error("Cannot write next-use index temporary file");
+    }
+}
+
+void readAll(std::FILE* file, void* data, size_t size, size_t count) {
+    if (std::fread(data, size, count, file) != count) {
+        throw std::runtime_error("Cannot read next-use index temporary file");
+    }
+}
+
+// Distance from position to next_position, 0 when the block is not used again
+uint32_t distanceTo(uint64_t position, uint64_t next_position) {
+    if (next_position == NextUseIndex::kNever) {
+        return 0;
+    }
+    return static_cast<uint32_t>(std::min<uint64_t>(next_position - position, std::numeric_limits<uint32_t>::max()));
+}
+
+} // namespace
+
+NextUseIndex::NextUseIndex(TraceReader& reader, size_t block_size, size_t memory_records)
+    : block_size_(block_size), size_(0), file_(nullptr, std::fclose) {
+    if (block_size == 0) {
+        throw std::invalid_argument("Block size must be greater than 0");
+    }
+    
+    std::vector<uint64_t> blocks;
+    std::unique_ptr<std::FILE, int (*)(std::FILE*)> spool(nullptr, std::fclose);
+    std::vector<TraceRecord> records;
+    records.reserve(kChunkEntries);
+    while (reader.read(records, kChunkEntries) > 0) {
+        for (const auto& record : records) {
+            blocks.push_back(record.address / block_size_);
+        }
+        size_ += records.size();
+        records.clear();
+        
+        // Past the memory budget, block numbers go to the spool file instead
+        if (!spool && size_ > memory_records) {
+            spool.reset(createTemporaryFile());
+        }
+        if (spool) {
+            writeAll(spool.get(), blocks.data(), sizeof(uint64_t), blocks.size());
+            blocks.clear();
+        }
+    }
+    
+    if (spool) {
+        blocks.shrink_to_fit();
+        buildSpooled(spool.get());
+    } else {
+        build(blocks);
+    }
+}
+
+NextUseIndex::NextUseIndex(const std::vector<uint64_t>& addresses, size_t block_size)
+    : block_size_(block_size), size_(addresses.size()), file_(nullptr, std::fclose) {
+    if (block_size == 0) {
+        throw std::invalid_argument("Block size must be greater than 0");
+    }
+    
+    std::vector<uint64_t> blocks(addresses.size());
+    for (size_t i = 0; i < addresses.size(); ++i) {
+        blocks[i] = addresses[i] / block_size_;
+    }
+    build(blocks);
+}
+
+void NextUseIndex::build(const std::vector<uint64_t>& blocks) {
+    distances_.resize(blocks.size());
+    std::unordered_map<uint64_t, uint64_t> next_seen;
+    for (size_t i = blocks.size(); i-- > 0;) {
+        auto it = next_seen.find(blocks[i]);
+        if (it == next_seen.end()) {
+            distances_[i] = 0;
+            next_seen.emplace(blocks[i], i);
+        } else {
+            distances_[i] = distanceTo(i, it->second);
+            it->second = i;
+        }
+    }
+}
+
+void NextUseIndex::buildSpooled(std::FILE* spool) {
+    file_.reset(createTemporaryFile());
+    
+    std::vector<uint64_t> blocks(kChunkEntries);
+    std::vector<uint32_t> distances(kChunkEntries);
+    std::unordered_map<uint64_t, uint64_t> next_seen;
+    
+    // Walk the spool from its last chunk; each chunk's distances land at the same position in file_
+    uint64_t chunks = (size_ + kChunkEntries - 1) / kChunkEntries;
+    for (uint64_t chunk = chunks; chunk-- > 0;) {
+        uint64_t base = chunk * kChunkEntries;
+        size_t count = static_cast<size_t>(std::min<uint64_t>(kChunkEntries, size_ - base));
+        seekTo(spool, base * sizeof(uint64_t));
+        readAll(spool, blocks.data(), sizeof(uint64_t), count);
+        
+        for (size_t i = count; i-- > 0;) {
+            uint64_t position = base + i;
+            auto it = next_seen.find(blocks[i]);
+            if (it == next_seen.end()) {
+                distances[i] = 0;
+                next_seen.emplace(blocks[i], position);
+            } else {
+                distances[i] = distanceTo(position, it->second);
+                it->second = position;
+            }
+        }
+        
+        seekTo(file_.get(), base * sizeof(uint32_t));
+        writeAll(file_.get(), distances.data(), sizeof(uint32_t), count);
+    }
+    if (std::fflush(file_.get()) != 0) {
+        throw std::runtime_error("Cannot write next-use index temporary file");
+    }
+}
+
+void NextUseIndex::readChunk(uint64_t base, std::vector<uint32_t>& chunk) const {
+    size_t count = static_cast<size_t>(std::min<uint64_t>(kChunkEntries, size_ - base));
+    chunk.resize(count);
+    std::lock_guard<std::mutex> lock(file_mutex_);
+    seekTo(file_.get(), base * sizeof(uint32_t));
+    readAll(file_.get(), chunk.data(), sizeof(uint32_t), count);
+}
+
+void NextUseIndex::Cursor::load(uint64_t position) {
+    chunk_base_ = position - position % kChunkEntries;
+    index_->readChunk(chunk_base_, chunk_);
+}
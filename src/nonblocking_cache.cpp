@@ -0,0 +1,176 @@
+#include "nonblocking_cache.h"
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+
+NonBlockingCache::NonBlockingCache(const CacheSpec& spec, size_t mshrs)
+    : port_(*this), mshrs_(mshrs), hit_latency_(spec.hit_latency),
+      miss_latency_(spec.hit_latency + spec.miss_penalty),
+      write_allocate_(spec.write_miss_policy != "NO_WRITE_ALLOCATE"),
+      started_(false), fetched_(false), delay_(0), last_issue_(0), first_issue_(0),
+      last_completion_(0), clock_(0) {
+    if (mshrs == 0 || mshrs > kMaxMshrs) {
+        throw std::invalid_argument("A non-blocking cache needs between 1 and " + std::to_string(kMaxMshrs) +
+                                    " MSHRs");
+    }
+    // OPT would need the trace indexed in advance, and timing never reorders it
+    if (spec.needsNextUseIndex()) {
+        throw std::invalid_argument("A non-blocking cache does not support OPT replacement");
+    }
+    occupancy_.assign(mshrs + 1, 0);
+    cache_ = spec.createCache();
+    cache_->setLowerLevel(&port_);
+}
+
+Cache::AccessResult NonBlockingCache::access(const TraceRecord& record) {
+    // Accesses keep trace order and issue one per cycle at most
+    uint64_t issue = record.timestamp + delay_;
+    if (started_) {
+        issue = std::max(issue, last_issue_ + 1);
+    } else {
+        started_ = true;
+        first_issue_ = issue;
+        clock_ = issue;
+    }
+    uint64_t start = issue;
+    advance(issue);
+
+    fetched_ = false;
+    Cache::AccessResult result = cache_->access(record.address, record.operation);
+    bool write = record.operation == Cache::Operation::WRITE;
+    uint64_t block = record.address / cache_->getBlockSize();
+    const Mshr* in_flight = findMshr(block);
+
+    uint64_t completion;
+    if (in_flight && (fetched_ || result == Cache::AccessResult::HIT || result == Cache::AccessResult::WRITE_HIT)) {
+        // The block is on its way, possibly refetched after an early eviction
+        counters_.secondary_misses++;
+        completion = in_flight->fill;
+    } else if (fetched_) {
+        if (outstanding_.size() == mshrs_) {
+            // Wait for the oldest fill to free an MSHR
+            uint64_t free_at = outstanding_.front().fill;
+            counters_.stalls++;
+            counters_.stall_cycles += free_at - issue;
+            delay_ += free_at - issue;
+            issue = free_at;
+            advance(issue);
+        }
+        counters_.primary_misses++;
+        completion = issue + miss_latency_;
+        outstanding_.push_back(Mshr{block, completion});
+    } else if (result == Cache::AccessResult::HIT || result == Cache::AccessResult::WRITE_HIT) {
+        if (!outstanding_.empty()) {
+            counters_.hits_under_miss++;
+        }
+        completion = issue + hit_latency_;
+    } else if (!write || write_allocate_) {
+        // Allocated without a fetch: found in the victim or miss cache
+        completion = issue + hit_latency_ + TimingModel::kVictimCacheCycles;
+    } else {
+        // No-write-allocate store, absorbed by the write buffer
+        completion = issue + hit_latency_;
+    }
+
+    (write ? timing_.writes : timing_.reads).record(completion - start);
+    last_issue_ = issue;
+    last_completion_ = std::max(last_completion_, completion);
+    return result;
+}
+
+void NonBlockingCache::accessBatch(const TraceRecord* records, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        access(records[i]);
+    }
+}
+
+void NonBlockingCache::advance(uint64_t cycle) {
+    while (!outstanding_.empty() && outstanding_.front().fill <= cycle) {
+        occupancy_[outstanding_.size()] += outstanding_.front().fill - clock_;
+        clock_ = outstanding_.front().fill;
+        outstanding_.pop_front();
+    }
+    occupancy_[outstanding_.size()] += cycle - clock_;
+    clock_ = cycle;
+}
+
+const NonBlockingCache::Mshr* NonBlockingCache::findMshr(uint64_t block) const {
+    // A handful of MSHRs, so a scan beats any index
+    for (const auto& mshr : outstanding_) {
+        if (mshr.block == block) {
+            return &mshr;
+        }
+    }
+    return nullptr;
+}
+
+uint64_t NonBlockingCache::getElapsedCycles() const {
+    return started_ ? last_completion_ - first_issue_ : 0;
+}
+
+std::vector<uint64_t> NonBlockingCache::getOccupancy() const {
+    // Drain the outstanding fills without changing the simulation state
+    std::vector<uint64_t> occupancy = occupancy_;
+    uint64_t clock = clock_;
+    size_t busy = outstanding_.size();
+    for (const auto& mshr : outstanding_) {
+        occupancy[busy--] += mshr.fill - clock;
+        clock = mshr.fill;
+    }
+    if (last_completion_ > clock) {
+        occupancy[0] += last_completion_ - clock;
+    }
+    return occupancy;
+}
+
+double NonBlockingCache::getMLP() const {
+    std::vector<uint64_t> occupancy = getOccupancy();
+    uint64_t busy_cycles = 0;
+    uint64_t weighted = 0;
+    for (size_t k = 1; k < occupancy.size(); ++k) {
+        busy_cycles += occupancy[k];
+        weighted += k * occupancy[k];
+    }
+    return busy_cycles > 0 ? static_cast<double>(weighted) / busy_cycles : 0.0;
+}
+
+double NonBlockingCache::getAverageOccupancy() const {
+    std::vector<uint64_t> occupancy = getOccupancy();
+    uint64_t cycles = 0;
+    uint64_t weighted = 0;
+    for (size_t k = 0; k < occupancy.size(); ++k) {
+        cycles += occupancy[k];
+        weighted += k * occupancy[k];
+    }
+    return cycles > 0 ? static_cast<double>(weighted) / cycles : 0.0;
+}
+
+std::string NonBlockingCache::getReport() const {
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(2);
+
+    std::vector<uint64_t> occupancy = getOccupancy();
+    uint64_t cycles = getElapsedCycles();
+    auto percent = [cycles](uint64_t part) { return cycles > 0 ? 100.0 * part / cycles : 0.0; };
+
+    oss << "Non-Blocking Cache (" << mshrs_ << " MSHRs):\n";
+    oss << "  Elapsed Cycles: " << cycles << "\n";
+    oss << "  Primary Misses: " << counters_.primary_misses << "\n";
+    oss << "  Secondary Misses (merged): " << counters_.secondary_misses << "\n";
+    oss << "  Hits Under Miss: " << counters_.hits_under_miss << "\n";
+    oss << "  MSHR Stalls: " << counters_.stalls << " (" << counters_.stall_cycles << " cycles, "
+        << percent(counters_.stall_cycles) << "% of elapsed)\n";
+    oss << "  Memory-Level Parallelism: " << getMLP() << "\n";
+    oss << "  Average MSHR Occupancy: " << getAverageOccupancy() << "\n";
+    oss << "  All MSHRs Busy: " << percent(occupancy[mshrs_]) << "% of cycles\n";
+    oss << "  MSHR Occupancy (busy: cycles):\n";
+    for (size_t k = 0; k < occupancy.size(); ++k) {
+        if (occupancy[k] > 0) {
+            oss << "    " << k << ": " << occupancy[k] << " (" << percent(occupancy[k]) << "%)\n";
+        }
+    }
+    oss << "\n" << timing_.toString(false);
+
+    return oss.str();
+}
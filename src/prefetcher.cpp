@@ -0,0 +1,154 @@
+#include "prefetcher.h"
+#include <algorithm>
+#include <stdexcept>
+
+NextLinePrefetcher::NextLinePrefetcher(size_t degree, size_t distance)
+    : degree_(degree), distance_(distance) {
+}
+
+void NextLinePrefetcher::train(uint64_t block, std::vector<uint64_t>& prefetches) {
+    for (size_t i = 0; i < degree_; ++i) {
+        prefetches.push_back(block + distance_ + i);
+    }
+}
+
+StridePrefetcher::StridePrefetcher(size_t block_size, size_t degree, size_t distance)
+    : region_shift_(0), degree_(degree), distance_(distance), table_(kTableEntries) {
+    while (region_shift_ < 63 && (block_size << (region_shift_ + 1)) <= kRegionBytes) {
+        ++region_shift_;
+    }
+}
+
+void StridePrefetcher::reset() {
+    std::fill(table_.begin(), table_.end(), Entry());
+}
+
+void StridePrefetcher::train(uint64_t block, std::vector<uint64_t>& prefetches) {
+    uint64_t region = block >> region_shift_;
+    Entry& entry = table_[region % kTableEntries];
+    if (entry.region != region) {
+        entry = Entry();
+        entry.region = region;
+        entry.last_block = block;
+        return;
+    }
+
+    int64_t stride = static_cast<int64_t>(block - entry.last_block);
+    if (stride == 0) {
+        return;
+    }
+    entry.last_block = block;
+    if (stride == entry.stride) {
+        entry.confidence = std::min<uint8_t>(entry.confidence + 1, kMaxConfidence);
+    } else if (entry.confidence > 0) {
+        entry.confidence--;
+    } else {
+        entry.stride = stride;
+    }
+
+    if (entry.confidence >= kIssueConfidence) {
+        for (size_t i = 0; i < degree_; ++i) {
+            // Unsigned wrap-around past address zero gives blocks no trace touches
+            prefetches.push_back(block + static_cast<uint64_t>(entry.stride) * (distance_ + i));
+        }
+    }
+}
+
+StreamPrefetcher::StreamPrefetcher(size_t degree, size_t distance)
+    : degree_(degree), distance_(distance), streams_(kStreams), time_(0) {
+}
+
+void StreamPrefetcher::reset() {
+    std::fill(streams_.begin(), streams_.end(), Stream());
+    time_ = 0;
+}
+
+void StreamPrefetcher::train(uint64_t block, std::vector<uint64_t>& prefetches) {
+    ++time_;
+
+    Stream* stream = nullptr;
+    for (auto& candidate : streams_) {
+        uint64_t gap = block > candidate.last_block ? block - candidate.last_block : candidate.last_block - block;
+        if (candidate.valid && gap <= kWindow) {
+            stream = &candidate;
+            break;
+        }
+    }
+    if (!stream) {
+        // New stream in the least recently used tracker
+        stream = &*std::min_element(streams_.begin(), streams_.end(), [](const Stream& a, const Stream& b) {
+            return a.valid != b.valid ? !a.valid : a.last_use < b.last_use;
+        });
+        *stream = Stream();
+        stream->valid = true;
+        stream->last_block = block;
+        stream->head = block;
+        stream->last_use = time_;
+        return;
+    }
+    stream->last_use = time_;
+    if (block == stream->last_block) {
+        return;
+    }
+
+    int direction = block > stream->last_block ? 1 : -1;
+    if (stream->direction != direction) {
+        // First step, or the stream turned around: restart from here
+        stream->direction = direction;
+        stream->head = block;
+    }
+    stream->last_block = block;
+
+    // Keep the head ahead of the access, by at most distance blocks
+    int64_t ahead = static_cast<int64_t>(stream->head - block) * direction;
+    if (ahead < 0) {
+        // The demand accesses overtook the prefetches
+        stream->head = block;
+        ahead = 0;
+    }
+    for (size_t i = 0; i < degree_ && static_cast<size_t>(ahead) < distance_; ++i, ++ahead) {
+        if (direction < 0 && stream->head == 0) {
+            break;
+        }
+        stream->head += static_cast<uint64_t>(static_cast<int64_t>(direction));
+        prefetches.push_back(stream->head);
+    }
+}
+
+std::unique_ptr<Prefetcher> PrefetcherFactory::createPrefetcher(
+    PrefetcherType type, size_t block_size, size_t degree, size_t distance) {
+
+    if (type == PrefetcherType::NONE) {
+        return nullptr;
+    }
+    if (degree == 0 || distance == 0) {
+        throw std::invalid_argument("Prefetch degree and distance must be greater than 0");
+    }
+
+    switch (type) {
+        case PrefetcherType::NEXT_LINE:
+            return std::make_unique<NextLinePrefetcher>(degree, distance);
+        case PrefetcherType::STRIDE:
+            return std::make_unique<StridePrefetcher>(block_size, degree, distance);
+        case PrefetcherType::STREAM:
+            return std::make_unique<StreamPrefetcher>(degree, distance);
+        default:
+            throw std::invalid_argument("Unknown prefetcher type");
+    }
+}
+
+PrefetcherFactory::PrefetcherType PrefetcherFactory::stringToPrefetcher(const std::string& prefetcher_str) {
+    std::string name = prefetcher_str;
+    std::transform(name.begin(), name.end(), name.begin(), ::toupper);
+    if (name == "NONE") {
+        return PrefetcherType::NONE;
+    } else if (name == "NEXT_LINE") {
+        return PrefetcherType::NEXT_LINE;
+    } else if (name == "STRIDE") {
+        return PrefetcherType::STRIDE;
+    } else if (name == "STREAM") {
+        return PrefetcherType::STREAM;
+    } else {
+        throw std::invalid_argument("Unknown prefetcher: " + prefetcher_str);
+    }
+}
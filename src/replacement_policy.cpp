@@ -1,102 +1,371 @@
 #include "replacement_policy.h"
 #include <iostream>
-#include <random>
 #include <string>
 #include <algorithm>
 #include <stdexcept>
 
+namespace {
+
+const NextUseIndex& requireIndex(const std::shared_ptr<const NextUseIndex>& next_use) {
+    if (!next_use) {
+        throw std::invalid_argument("OPT replacement needs a next-use index of the trace");
+    }
+    return *next_use;
+}
+
+} // namespace
+
 LRUPolicy::LRUPolicy(size_t num_sets, size_t associativity)
-    : num_sets_(num_sets), associativity_(associativity), access_order_(num_sets, std::vector<uint64_t>(associativity, 0)), global_time_(0) {
+    : num_sets_(num_sets), associativity_(associativity), access_order_(num_sets * associativity, 0), global_time_(0) {
+}
+
+void LRUPolicy::reset() {
+    global_time_ = 0;
+    std::fill(access_order_.begin(), access_order_.end(), 0);
 }
 
-size_t LRUPolicy::selectVictim(size_t set_index, const std::vector<bool>& valid_blocks) {
-    size_t oldest_block_index = 0;
-    uint64_t oldest_time = access_order_[set_index][0];
-    for (size_t i = 1; i < associativity_; ++i) {
-        if (valid_blocks[i] && access_order_[set_index][i] < oldest_time) {
-            oldest_time = access_order_[set_index][i];
-            oldest_block_index = i;
+ListLRUPolicy::ListLRUPolicy(size_t num_sets, size_t associativity)
+    : num_sets_(num_sets), associativity_(associativity), prev_(num_sets * associativity),
+      next_(num_sets * associativity), head_(num_sets), tail_(num_sets) {
+    reset();
+}
+
+void ListLRUPolicy::reset() {
+    // Ways start in index order, way 0 most recent; the ends point at themselves
+    for (size_t set = 0; set < num_sets_; ++set) {
+        uint32_t* prev = &prev_[set * associativity_];
+        uint32_t* next = &next_[set * associativity_];
+        for (size_t way = 0; way < associativity_; ++way) {
+            prev[way] = static_cast<uint32_t>(way == 0 ? 0 : way - 1);
+            next[way] = static_cast<uint32_t>(way + 1 == associativity_ ? way : way + 1);
         }
+        head_[set] = 0;
+        tail_[set] = static_cast<uint32_t>(associativity_ - 1);
     }
-    return oldest_block_index;
 }
 
-void LRUPolicy::updateOnAccess(size_t set_index, size_t block_index, bool hit) {
-    access_order_[set_index][block_index] = ++global_time_;
+FIFOPolicy::FIFOPolicy(size_t num_sets, size_t associativity)
+    : num_sets_(num_sets), associativity_(associativity), insertion_order_(num_sets * associativity, 0), global_time_(0) {
 }
 
-void LRUPolicy::reset() {
+void FIFOPolicy::reset() {
     global_time_ = 0;
-    for (auto& set_order : access_order_) {
-        std::fill(set_order.begin(), set_order.end(), 0);
+    std::fill(insertion_order_.begin(), insertion_order_.end(), 0);
+}
+
+RandomPolicy::RandomPolicy(size_t num_sets, size_t associativity, uint64_t seed)
+    : num_sets_(num_sets), associativity_(associativity), seed_(seed) {
+    reset();
+}
+
+void RandomPolicy::reset() {
+    // splitmix64 expands the seed so that nearby seeds give unrelated streams
+    uint64_t x = seed_;
+    for (auto& word : state_) {
+        x += 0x9E3779B97F4A7C15ULL;
+        uint64_t z = x;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        word = z ^ (z >> 31);
     }
 }
 
-FIFOPolicy::FIFOPolicy(size_t num_sets, size_t associativity)
-    : num_sets_(num_sets), associativity_(associativity), insertion_order_(num_sets, std::vector<uint64_t>(associativity, 0)), global_time_(0) {
+TreePLRUPolicy::TreePLRUPolicy(size_t num_sets, size_t associativity)
+    : num_sets_(num_sets), associativity_(associativity), leaves_(1), levels_(0) {
+    while (leaves_ < associativity_) {
+        leaves_ <<= 1;
+        ++levels_;
+    }
+    // Node bits are indexed 1..leaves_-1; bit 0 is unused
+    words_per_set_ = (leaves_ + 63) / 64;
+    tree_bits_.assign(num_sets_ * words_per_set_, 0);
+}
+
+void TreePLRUPolicy::reset() {
+    std::fill(tree_bits_.begin(), tree_bits_.end(), 0);
+}
+
+BitPLRUPolicy::BitPLRUPolicy(size_t num_sets, size_t associativity)
+    : num_sets_(num_sets), associativity_(associativity), words_per_set_((associativity + 63) / 64),
+      mru_bits_(num_sets * words_per_set_, 0) {
+}
+
+void BitPLRUPolicy::reset() {
+    std::fill(mru_bits_.begin(), mru_bits_.end(), 0);
+}
+
+RRIPPolicy::RRIPPolicy(size_t num_sets, size_t associativity, Mode mode)
+    : num_sets_(num_sets), associativity_(associativity), mode_(mode),
+      dueling_period_(std::max<size_t>(4, num_sets / kLeaderSets)),
+      rrpv_(num_sets * associativity, kMaxRRPV) {
+    reset();
+}
+
+void RRIPPolicy::reset() {
+    std::fill(rrpv_.begin(), rrpv_.end(), kMaxRRPV);
+    bimodal_count_ = 0;
+    psel_ = (kPselMax + 1) / 2;
+    long_fills_ = 0;
+    distant_fills_ = 0;
+    srrip_leader_misses_ = 0;
+    brrip_leader_misses_ = 0;
+    srrip_follower_fills_ = 0;
+    brrip_follower_fills_ = 0;
+}
+
+std::string RRIPPolicy::getName() const {
+    switch (mode_) {
+        case Mode::STATIC: return "SRRIP";
+        case Mode::BIMODAL: return "BRRIP";
+        default: return "DRRIP";
+    }
 }
 
-size_t FIFOPolicy::selectVictim(size_t set_index, const std::vector<bool>& valid_blocks) {
-    size_t first_in_block_index = 0;
-    uint64_t first_in_time = insertion_order_[set_index][0];
-    for (size_t i = 1; i < associativity_; ++i) {
-        if (valid_blocks[i] && insertion_order_[set_index][i] < first_in_time) {
-            first_in_time = insertion_order_[set_index][i];
-            first_in_block_index = i;
+ReplacementPolicy::Counters RRIPPolicy::getCounters() const {
+    Counters counters = {
+        {"Long-Interval Fills", long_fills_},
+        {"Distant-Interval Fills", distant_fills_}
+    };
+    if (mode_ == Mode::DYNAMIC) {
+        counters.emplace_back("SRRIP Leader Misses", srrip_leader_misses_);
+        counters.emplace_back("BRRIP Leader Misses", brrip_leader_misses_);
+        counters.emplace_back("Follower Fills Using SRRIP", srrip_follower_fills_);
+        counters.emplace_back("Follower Fills Using BRRIP", brrip_follower_fills_);
+    }
+    return counters;
+}
+
+BeladyPolicy::BeladyPolicy(size_t num_sets, size_t associativity, std::shared_ptr<const NextUseIndex> next_use)
+    : num_sets_(num_sets), associativity_(associativity), next_use_(std::move(next_use)),
+      cursor_(requireIndex(next_use_)),
+      position_(0), next_use_of_(num_sets * associativity), heap_(num_sets * associativity),
+      heap_slot_(num_sets * associativity) {
+    reset();
+}
+
+void BeladyPolicy::reset() {
+    // Ways never filled are treated as never used again
+    std::fill(next_use_of_.begin(), next_use_of_.end(), NextUseIndex::kNever);
+    for (size_t set = 0; set < num_sets_; ++set) {
+        for (size_t way = 0; way < associativity_; ++way) {
+            heap_[set * associativity_ + way] = static_cast<uint32_t>(way);
+            heap_slot_[set * associativity_ + way] = static_cast<uint32_t>(way);
         }
     }
-    return first_in_block_index;
+    position_ = 0;
 }
 
-void FIFOPolicy::updateOnAccess(size_t set_index, size_t block_index, bool hit) {
-    if (!hit) {
-        insertion_order_[set_index][block_index] = ++global_time_;
+LFUPolicy::LFUPolicy(size_t num_sets, size_t associativity)
+    : num_sets_(num_sets), associativity_(associativity), lists_(num_sets * associativity),
+      buckets_(num_sets * (kMaxFrequency + 1)), occupied_(num_sets), frequency_(num_sets * associativity),
+      set_accesses_(num_sets) {
+    reset();
+}
+
+void LFUPolicy::reset() {
+    lists_.clear();
+    std::fill(buckets_.begin(), buckets_.end(), IndexLists::List());
+    std::fill(occupied_.begin(), occupied_.end(), 0);
+    std::fill(frequency_.begin(), frequency_.end(), 0);
+    std::fill(set_accesses_.begin(), set_accesses_.end(), 0);
+    agings_ = 0;
+}
+
+void LFUPolicy::age(size_t set_index) {
+    // Halve every count, moving buckets from the lowest up so halved blocks
+    // land in front of the blocks that already had the lower count
+    for (uint32_t count = 2; count <= kMaxFrequency; ++count) {
+        IndexLists::List& list = bucket(set_index, count);
+        while (list.size > 0) {
+            uint32_t node = list.back;
+            unplace(set_index, node);
+            place(set_index, node, count / 2);
+        }
     }
+    set_accesses_[set_index] = 0;
+    agings_++;
 }
 
-void FIFOPolicy::reset() {
-    global_time_ = 0;
-    for (auto& set_order : insertion_order_) {
-        std::fill(set_order.begin(), set_order.end(), 0);
+ReplacementPolicy::Counters LFUPolicy::getCounters() const {
+    return {{"Frequency Agings", agings_}};
+}
+
+ARCPolicy::ARCPolicy(size_t num_sets, size_t associativity)
+    : num_sets_(num_sets), associativity_(associativity), sets_(num_sets),
+      way_lists_(num_sets * associativity), ghost_lists_(num_sets * associativity),
+      way_list_(num_sets * associativity), way_tag_(num_sets * associativity),
+      ghost_list_(num_sets * associativity), ghost_tag_(num_sets * associativity),
+      ghost_index_(num_sets * associativity) {
+    reset();
+}
+
+void ARCPolicy::reset() {
+    way_lists_.clear();
+    ghost_lists_.clear();
+    ghost_index_.clear();
+    std::fill(way_list_.begin(), way_list_.end(), NONE);
+    std::fill(ghost_list_.begin(), ghost_list_.end(), NONE);
+    for (size_t set = 0; set < num_sets_; ++set) {
+        SetState& state = sets_[set];
+        state = SetState();
+        for (size_t ghost = 0; ghost < associativity_; ++ghost) {
+            ghost_lists_.pushFront(state.free_ghosts, static_cast<uint32_t>(set * associativity_ + ghost));
+        }
     }
+    pending_ = false;
+    discard_t1_ = false;
+    ghost_hits_b1_ = 0;
+    ghost_hits_b2_ = 0;
+    t1_evictions_ = 0;
+    t2_evictions_ = 0;
 }
 
-RandomPolicy::RandomPolicy(size_t num_sets, size_t associativity)
-    : num_sets_(num_sets), associativity_(associativity) {
+void ARCPolicy::dropGhost(size_t set_index, uint32_t ghost) {
+    SetState& state = sets_[set_index];
+    ghost_lists_.remove(ghost_list_[ghost] == B1 ? state.b1 : state.b2, ghost);
+    ghost_index_.erase(ghostKey(set_index, ghost_tag_[ghost]));
+    ghost_list_[ghost] = NONE;
+    ghost_lists_.pushFront(state.free_ghosts, ghost);
 }
 
-size_t RandomPolicy::selectVictim(size_t set_index, const std::vector<bool>& valid_blocks) {
-    static std::random_device rd;
-    static std::mt19937 gen(rd());
-    std::uniform_int_distribution<> dis(0, associativity_ - 1);
+void ARCPolicy::addGhost(size_t set_index, uint8_t id, uint64_t tag) {
+    SetState& state = sets_[set_index];
+    if (state.free_ghosts.size == 0) {
+        // |B1| + |B2| never exceeds the way count while the set is full; this
+        // only triggers after blocks were invalidated behind the policy's back
+        dropGhost(set_index, state.b2.size > 0 ? state.b2.back : state.b1.back);
+    }
+    uint32_t ghost = state.free_ghosts.front;
+    ghost_lists_.remove(state.free_ghosts, ghost);
+    ghost_lists_.pushFront(id == B1 ? state.b1 : state.b2, ghost);
+    ghost_list_[ghost] = id;
+    ghost_tag_[ghost] = tag;
+    ghost_index_.insert(ghostKey(set_index, tag), ghost);
+}
 
-    size_t victim;
-    do {
-        victim = dis(gen);
-    } while (!valid_blocks[victim]);
+void ARCPolicy::setIncomingBlock(size_t set_index, uint64_t tag) {
+    SetState& state = sets_[set_index];
+    uint32_t ways = static_cast<uint32_t>(associativity_);
+    pending_ = true;
+    pending_set_ = set_index;
+    pending_tag_ = tag;
+    pending_kind_ = Incoming::NEW;
+    discard_t1_ = false;
+    
+    int64_t ghost = ghost_index_.find(ghostKey(set_index, tag));
+    if (ghost >= 0 && ghost_list_[ghost] == B1) {
+        // Recency ghost: T1 deserved more room
+        ghost_hits_b1_++;
+        state.target = std::min(ways, state.target + std::max<uint32_t>(state.b2.size / state.b1.size, 1));
+        pending_kind_ = Incoming::GHOST_B1;
+        dropGhost(set_index, static_cast<uint32_t>(ghost));
+    } else if (ghost >= 0) {
+        // Frequency ghost: T2 deserved more room
+        ghost_hits_b2_++;
+        uint32_t step = std::max<uint32_t>(state.b1.size / state.b2.size, 1);
+        state.target = state.target > step ? state.target - step : 0;
+        pending_kind_ = Incoming::GHOST_B2;
+        dropGhost(set_index, static_cast<uint32_t>(ghost));
+    } else if (state.t1.size + state.b1.size >= ways) {
+        // L1 = T1 + B1 is full: forget its oldest ghost, or the block itself
+        if (state.b1.size > 0) {
+            dropGhost(set_index, state.b1.back);
+        } else {
+            discard_t1_ = true;
+        }
+    } else if (state.t1.size + state.t2.size + state.b1.size + state.b2.size >= 2 * ways && state.b2.size > 0) {
+        dropGhost(set_index, state.b2.back);
+    }
+}
 
-    return victim;
+size_t ARCPolicy::selectVictim(size_t set_index, WayMask /*valid_blocks*/) {
+    SetState& state = sets_[set_index];
+    bool incoming_b2 = pending_ && pending_set_ == set_index && pending_kind_ == Incoming::GHOST_B2;
+    
+    // REPLACE(x, p): shrink T1 while it exceeds its target
+    uint8_t from;
+    if (state.t1.size > 0 && (state.t1.size > state.target || (incoming_b2 && state.t1.size == state.target) ||
+                              state.t2.size == 0 || discard_t1_)) {
+        from = T1;
+        t1_evictions_++;
+    } else {
+        from = T2;
+        t2_evictions_++;
+    }
+    IndexLists::List& list = wayList(state, from);
+    uint32_t node = list.back;
+    if (node == IndexLists::kNil) {
+        return 0;
+    }
+    way_lists_.remove(list, node);
+    way_list_[node] = NONE;
+    if (!(from == T1 && discard_t1_)) {
+        addGhost(set_index, from == T1 ? B1 : B2, way_tag_[node]);
+    }
+    discard_t1_ = false;
+    return node - set_index * associativity_;
 }
 
-void RandomPolicy::updateOnAccess(size_t set_index, size_t block_index, bool hit) {
-    // No state to update for random policy
+void ARCPolicy::updateOnAccess(size_t set_index, size_t block_index, bool hit) {
+    SetState& state = sets_[set_index];
+    uint32_t node = static_cast<uint32_t>(set_index * associativity_ + block_index);
+    if (way_list_[node] != NONE) {
+        way_lists_.remove(wayList(state, way_list_[node]), node);
+    }
+    
+    uint8_t to = T2;
+    if (!hit) {
+        // Ghost hits re-enter as frequent blocks, anything else starts in T1
+        bool announced = pending_ && pending_set_ == set_index;
+        to = (announced && pending_kind_ != Incoming::NEW) ? T2 : T1;
+        way_tag_[node] = announced ? pending_tag_ : 0;
+        pending_ = false;
+        discard_t1_ = false;
+    }
+    way_lists_.pushFront(wayList(state, to), node);
+    way_list_[node] = to;
 }
 
-void RandomPolicy::reset() {
-    // No state to reset for random policy
+ReplacementPolicy::Counters ARCPolicy::getCounters() const {
+    return {
+        {"Ghost Hits in B1 (Recency)", ghost_hits_b1_},
+        {"Ghost Hits in B2 (Frequency)", ghost_hits_b2_},
+        {"Evictions from T1", t1_evictions_},
+        {"Evictions from T2", t2_evictions_}
+    };
 }
 
 // Factory implementations
 std::unique_ptr<ReplacementPolicy> ReplacementPolicyFactory::createPolicy(
-    PolicyType type, size_t num_sets, size_t associativity) {
+    PolicyType type, size_t num_sets, size_t associativity,
+    std::shared_ptr<const NextUseIndex> next_use, uint64_t seed) {
     
     switch (type) {
         case PolicyType::LRU:
+            if (associativity > ListLRUPolicy::kListThreshold) {
+                return std::make_unique<ListLRUPolicy>(num_sets, associativity);
+            }
             return std::make_unique<LRUPolicy>(num_sets, associativity);
         case PolicyType::FIFO:
             return std::make_unique<FIFOPolicy>(num_sets, associativity);
         case PolicyType::RANDOM:
-            return std::make_unique<RandomPolicy>(num_sets, associativity);
+            return std::make_unique<RandomPolicy>(num_sets, associativity, seed);
+        case PolicyType::TREE_PLRU:
+            return std::make_unique<TreePLRUPolicy>(num_sets, associativity);
+        case PolicyType::BIT_PLRU:
+            return std::make_unique<BitPLRUPolicy>(num_sets, associativity);
+        case PolicyType::SRRIP:
+            return std::make_unique<RRIPPolicy>(num_sets, associativity, RRIPPolicy::Mode::STATIC);
+        case PolicyType::BRRIP:
+            return std::make_unique<RRIPPolicy>(num_sets, associativity, RRIPPolicy::Mode::BIMODAL);
+        case PolicyType::DRRIP:
+            return std::make_unique<RRIPPolicy>(num_sets, associativity, RRIPPolicy::Mode::DYNAMIC);
+        case PolicyType::OPT:
+            return std::make_unique<BeladyPolicy>(num_sets, associativity, std::move(next_use));
+        case PolicyType::LFU:
+            return std::make_unique<LFUPolicy>(num_sets, associativity);
+        case PolicyType::ARC:
+            return std::make_unique<ARCPolicy>(num_sets, associativity);
         default:
             throw std::invalid_argument("Unknown replacement policy type");
     }
@@ -109,6 +378,22 @@ ReplacementPolicyFactory::PolicyType ReplacementPolicyFactory::stringToPolicy(co
         return PolicyType::FIFO;
     } else if (policy_str == "RANDOM" || policy_str == "random") {
         return PolicyType::RANDOM;
+    } else if (policy_str == "TREE_PLRU" || policy_str == "tree_plru" || policy_str == "PLRU" || policy_str == "plru") {
+        return PolicyType::TREE_PLRU;
+    } else if (policy_str == "BIT_PLRU" || policy_str == "bit_plru") {
+        return PolicyType::BIT_PLRU;
+    } else if (policy_str == "SRRIP" || policy_str == "srrip") {
+        return PolicyType::SRRIP;
+    } else if (policy_str == "BRRIP" || policy_str == "brrip") {
+        return PolicyType::BRRIP;
+    } else if (policy_str == "DRRIP" || policy_str == "drrip") {
+        return PolicyType::DRRIP;
+    } else if (policy_str == "OPT" || policy_str == "opt" || policy_str == "BELADY" || policy_str == "belady") {
+        return PolicyType::OPT;
+    } else if (policy_str == "LFU" || policy_str == "lfu") {
+        return PolicyType::LFU;
+    } else if (policy_str == "ARC" || policy_str == "arc") {
+        return PolicyType::ARC;
     } else {
         throw std::invalid_argument("Unknown replacement policy: " + policy_str);
     }
@@ -2,8 +2,8 @@
 #include <iostream>
 #include <iomanip>
 #include <sstream>
-#include <cmath>
 #include <algorithm>
+#include <type_traits>
 
 SetAssociativeCache::SetAssociativeCache(
     size_t cache_size,
@@ -11,20 +11,59 @@ SetAssociativeCache::SetAssociativeCache(
     size_t associativity,
     std::unique_ptr<ReplacementPolicy> replacement_policy,
     WritePolicy write_policy,
-    WriteMissPolicy write_miss_policy)
+    WriteMissPolicy write_miss_policy,
+    DataMode data_mode)
     : Cache(cache_size, block_size, associativity),
       replacement_policy_(std::move(replacement_policy)),
       write_policy_(write_policy),
-      write_miss_policy_(write_miss_policy) {
+      write_miss_policy_(write_miss_policy),
+      lower_level_(nullptr),
+      trace_position_(0),
+      prefetch_latency_(0) {
     
-    // Initialize cache structure
-    cache_.resize(num_sets_);
-    for (size_t i = 0; i < num_sets_; ++i) {
-        cache_[i].resize(associativity_, CacheBlock(block_size_));
+    // Initialize tag store
+    words_per_set_ = (associativity_ + 63) / 64;
+    tags_.assign(num_sets_ * associativity_, 0);
+    valid_bits_.assign(num_sets_ * words_per_set_, 0);
+    dirty_bits_.assign(num_sets_ * words_per_set_, 0);
+    valid_counts_.assign(num_sets_, 0);
+    
+    // Scanning very wide sets (e.g. fully associative) costs O(ways) per access
+    if (associativity_ > kIndexedLookupThreshold) {
+        block_index_ = std::make_unique<BlockIndex>(num_blocks_);
+    }
+    
+    if (data_mode == DataMode::TRACK_DATA) {
+        data_store_ = std::make_unique<BlockDataStore>(num_blocks_, block_size_);
     }
+    
+    selectEngine();
 }
 
 Cache::AccessResult SetAssociativeCache::access(uint64_t address, Operation operation) {
+    return (this->*access_fn_)(address, operation);
+}
+
+Cache::BatchResult SetAssociativeCache::accessBatch(const uint64_t* addresses, const Operation* operations,
+                                                    size_t count, AccessResult* results) {
+    return (this->*batch_fn_)(addresses, operations, count, results);
+}
+
+void SetAssociativeCache::selectEngine() {
+    ReplacementPolicyFactory::visit(*replacement_policy_, [this](auto& policy) {
+        using Policy = std::decay_t<decltype(policy)>;
+        if (write_policy_ == WritePolicy::WRITE_BACK) {
+            access_fn_ = &SetAssociativeCache::accessWith<Policy, WritePolicy::WRITE_BACK>;
+            batch_fn_ = &SetAssociativeCache::accessBatchWith<Policy, WritePolicy::WRITE_BACK>;
+        } else {
+            access_fn_ = &SetAssociativeCache::accessWith<Policy, WritePolicy::WRITE_THROUGH>;
+            batch_fn_ = &SetAssociativeCache::accessBatchWith<Policy, WritePolicy::WRITE_THROUGH>;
+        }
+    });
+}
+
+template <typename Policy, SetAssociativeCache::WritePolicy WP>
+Cache::AccessResult SetAssociativeCache::accessWith(uint64_t address, Operation operation) {
     size_t set_index = getSetIndex(address);
     uint64_t tag = getTag(address);
     
@@ -35,130 +74,396 @@ Cache::AccessResult SetAssociativeCache::access(uint64_t address, Operation oper
         statistics_.recordWrite();
     }
     
-    // Check if block exists in cache
-    int block_index = findBlock(set_index, tag);
+    AccessResult result = accessBlock<Policy, WP>(address, set_index, tag, operation);
+    switch (result) {
+        case AccessResult::HIT: statistics_.recordHit(); break;
+        case AccessResult::MISS: statistics_.recordMiss(); break;
+        case AccessResult::WRITE_HIT: statistics_.recordWriteHit(); break;
+        case AccessResult::WRITE_MISS: statistics_.recordWriteMiss(); break;
+    }
+    return result;
+}
+
+template <typename Policy, SetAssociativeCache::WritePolicy WP>
+Cache::BatchResult SetAssociativeCache::accessBatchWith(const uint64_t* addresses, const Operation* operations,
+                                                        size_t count, AccessResult* results) {
+    // Statistics are kept in locals and flushed once at the end of the batch
+    uint64_t counts[4] = {0, 0, 0, 0}; // Indexed by AccessResult
     
-    if (block_index != -1) {
-        // Cache hit
-        return handleHit(set_index, block_index, operation);
-    } else {
-        // Cache miss
-        return handleMiss(address, set_index, tag, operation);
+    size_t set_indices[kBatchChunk];
+    uint64_t tags[kBatchChunk];
+    
+    for (size_t base = 0; base < count; base += kBatchChunk) {
+        size_t n = std::min(kBatchChunk, count - base);
+        
+        // Decode the whole chunk up front
+        for (size_t i = 0; i < n; ++i) {
+            set_indices[i] = getSetIndex(addresses[base + i]);
+            tags[i] = getTag(addresses[base + i]);
+        }
+        
+        for (size_t i = 0; i < n; ++i) {
+            if (i + kPrefetchDistance < n) {
+                __builtin_prefetch(&tags_[blockSlot(set_indices[i + kPrefetchDistance], 0)]);
+            }
+            AccessResult result = accessBlock<Policy, WP>(addresses[base + i], set_indices[i], tags[i], operations[base + i]);
+            counts[static_cast<size_t>(result)]++;
+            if (results) {
+                results[base + i] = result;
+            }
+        }
     }
+    
+    BatchResult batch;
+    batch.read_hits = counts[static_cast<size_t>(AccessResult::HIT)];
+    batch.read_misses = counts[static_cast<size_t>(AccessResult::MISS)];
+    batch.write_hits = counts[static_cast<size_t>(AccessResult::WRITE_HIT)];
+    batch.write_misses = counts[static_cast<size_t>(AccessResult::WRITE_MISS)];
+    statistics_.recordBatch(batch.read_hits, batch.read_misses, batch.write_hits, batch.write_misses);
+    return batch;
 }
 
-int SetAssociativeCache::findBlock(size_t set_index, uint64_t tag) const {
-    for (size_t i = 0; i < associativity_; ++i) {
-        if (cache_[set_index][i].valid && cache_[set_index][i].tag == tag) {
-            return static_cast<int>(i);
+template <typename Policy, SetAssociativeCache::WritePolicy WP>
+Cache::AccessResult SetAssociativeCache::accessBlock(uint64_t address, size_t set_index, uint64_t tag, Operation operation) {
+    // The generic instantiation cannot tell, so it always makes the virtual call
+    if constexpr (Policy::kUsesTracePosition || std::is_same<Policy, ReplacementPolicy>::value) {
+        static_cast<Policy&>(*replacement_policy_).setTracePosition(trace_position_);
+    }
+    ++trace_position_;
+    
+    // Check if block exists in cache
+    TagLookupResult lookup = findBlock(set_index, tag);
+    
+    if (!prefetcher_) {
+        if (lookup.hit_way != -1) {
+            // Cache hit
+            return handleHit<Policy, WP>(set_index, lookup.hit_way, operation);
+        } else {
+            // Cache miss
+            return handleMiss<Policy, WP>(address, set_index, tag, operation, lookup.empty_way);
         }
     }
-    return -1;
+    
+    // With a prefetcher, misses and first uses of prefetched blocks train it
+    AccessResult result;
+    if (lookup.hit_way != -1) {
+        if (!testPrefetched(set_index, lookup.hit_way)) {
+            return handleHit<Policy, WP>(set_index, lookup.hit_way, operation);
+        }
+        setPrefetched(set_index, lookup.hit_way, false);
+        statistics_.recordPrefetchUse(trace_position_ <= prefetch_ready_[blockSlot(set_index, lookup.hit_way)]);
+        result = handleHit<Policy, WP>(set_index, lookup.hit_way, operation);
+    } else {
+        uint64_t block = address >> offset_bits_;
+        uint64_t& victim = pollution_filter_[pollutionSlot(block)];
+        if (victim == block + 1) {
+            statistics_.recordPollutingPrefetch();
+            victim = 0;
+        }
+        result = handleMiss<Policy, WP>(address, set_index, tag, operation, lookup.empty_way);
+    }
+    runPrefetcher<Policy, WP>(address);
+    return result;
 }
 
-int SetAssociativeCache::findEmptyBlock(size_t set_index) const {
-    for (size_t i = 0; i < associativity_; ++i) {
-        if (!cache_[set_index][i].valid) {
-            return static_cast<int>(i);
+template <typename Policy, SetAssociativeCache::WritePolicy WP>
+void SetAssociativeCache::runPrefetcher(uint64_t address) {
+    prefetch_queue_.clear();
+    prefetcher_->train(address >> offset_bits_, prefetch_queue_);
+    for (uint64_t block : prefetch_queue_) {
+        uint64_t block_address = block << offset_bits_;
+        size_t set_index = getSetIndex(block_address);
+        uint64_t tag = getTag(block_address);
+        TagLookupResult lookup = findBlock(set_index, tag);
+        if (lookup.hit_way != -1 ||
+            (victim_cache_ && victim_cache_->getMode() == VictimCache::Mode::VICTIM && victim_cache_->contains(block))) {
+            continue;
         }
+        allocateBlock<Policy, WP>(set_index, tag, false, lookup.empty_way, true, true);
+        statistics_.recordPrefetch();
     }
-    return -1;
 }
 
+template <typename Policy, SetAssociativeCache::WritePolicy WP>
 Cache::AccessResult SetAssociativeCache::handleHit(size_t set_index, size_t block_index, Operation operation) {
     // Update replacement policy
-    replacement_policy_->updateOnAccess(set_index, block_index, true);
+    static_cast<Policy&>(*replacement_policy_).updateOnAccess(set_index, block_index, true);
     
     if (operation == Operation::READ) {
-        statistics_.recordHit();
         return AccessResult::HIT;
     } else {
         // Write hit
-        statistics_.recordWriteHit();
-        
-        if (write_policy_ == WritePolicy::WRITE_BACK) {
-            cache_[set_index][block_index].dirty = true;
+        if (WP == WritePolicy::WRITE_BACK) {
+            setDirty(set_index, block_index, true);
         } else {
             // Write through - write to memory immediately
-            writeToMemory(getTag(cache_[set_index][block_index].tag) << (getNumSets() > 1 ? static_cast<size_t>(std::log2(getNumSets())) : 0) | set_index);
+            writeToMemory(blockAddress(set_index, tags_[blockSlot(set_index, block_index)]),
+                          CacheStatistics::Transfer::WRITE_THROUGH);
         }
         
         return AccessResult::WRITE_HIT;
     }
 }
 
-Cache::AccessResult SetAssociativeCache::handleMiss(uint64_t address, size_t set_index, uint64_t tag, Operation operation) {
+template <typename Policy, SetAssociativeCache::WritePolicy WP>
+Cache::AccessResult SetAssociativeCache::handleMiss(uint64_t address, size_t set_index, uint64_t tag, Operation operation, int empty_block) {
+    // Blocks found in the victim or miss cache are not fetched again
+    bool buffered_dirty = false;
     if (operation == Operation::READ) {
-        statistics_.recordMiss();
         // Always allocate on read miss
-        allocateBlock(set_index, tag, operation);
+        bool buffered = victim_cache_ && probeVictimCache(address, false, buffered_dirty);
+        allocateBlock<Policy, WP>(set_index, tag, buffered_dirty, empty_block, !buffered);
         return AccessResult::MISS;
     } else {
         // Write miss
-        statistics_.recordWriteMiss();
-        
         if (write_miss_policy_ == WriteMissPolicy::WRITE_ALLOCATE) {
             // Allocate block and write to cache
-            allocateBlock(set_index, tag, operation);
+            bool buffered = victim_cache_ && probeVictimCache(address, true, buffered_dirty);
+            allocateBlock<Policy, WP>(set_index, tag, WP == WritePolicy::WRITE_BACK || buffered_dirty, empty_block,
+                                      !buffered);
+            if (WP == WritePolicy::WRITE_THROUGH) {
+                writeToMemory(blockAddress(set_index, tag), CacheStatistics::Transfer::WRITE_THROUGH);
+            }
+        } else if (WP == WritePolicy::WRITE_BACK && victim_cache_ &&
+                   victim_cache_->getMode() == VictimCache::Mode::VICTIM &&
+                   victim_cache_->markDirty(address >> offset_bits_)) {
+            // The victim cache holds the block and absorbs the write
+            statistics_.recordVictimHit(true);
         } else {
             // No write allocate - write directly to memory
-            writeToMemory(address);
+            writeToMemory(blockAddress(set_index, tag), CacheStatistics::Transfer::BYPASS);
         }
         
         return AccessResult::WRITE_MISS;
     }
 }
 
-size_t SetAssociativeCache::allocateBlock(size_t set_index, uint64_t tag, Operation operation) {
-    // First, try to find an empty block
-    int empty_block = findEmptyBlock(set_index);
+template <typename Policy, SetAssociativeCache::WritePolicy WP>
+size_t SetAssociativeCache::allocateBlock(size_t set_index, uint64_t tag, bool dirty, int empty_block, bool fetch,
+                                          bool prefetch) {
+    Policy& policy = static_cast<Policy&>(*replacement_policy_);
+    if constexpr (Policy::kUsesBlockTags || std::is_same<Policy, ReplacementPolicy>::value) {
+        policy.setIncomingBlock(set_index, tag);
+    }
+    
+    // Prefer the empty block found during lookup
     size_t victim_index;
     
     if (empty_block != -1) {
         victim_index = static_cast<size_t>(empty_block);
+        valid_counts_[set_index]++;
     } else {
-        // Need to evict a block
-        std::vector<bool> valid_blocks(associativity_);
-        for (size_t i = 0; i < associativity_; ++i) {
-            valid_blocks[i] = cache_[set_index][i].valid;
-        }
+        // Need to evict a block; lookup found no empty way, so every block is valid
+        victim_index = policy.selectVictim(set_index, WayMask(&valid_bits_[bitWord(set_index, 0)], associativity_));
         
-        victim_index = replacement_policy_->selectVictim(set_index, valid_blocks);
-        
-        // If victim block is dirty (write-back policy), write it to memory
-        if (cache_[set_index][victim_index].dirty) {
-            size_t offset_bits = static_cast<size_t>(std::log2(block_size_));
-            size_t index_bits = static_cast<size_t>(std::log2(num_sets_));
-            uint64_t victim_address = (cache_[set_index][victim_index].tag << (offset_bits + index_bits)) | 
-                                    (set_index << offset_bits);
-            writeToMemory(victim_address);
+        uint64_t victim_tag = tags_[blockSlot(set_index, victim_index)];
+        if (block_index_) {
+            block_index_->erase(indexKey(set_index, victim_tag));
+        }
+        if (prefetcher_) {
+            if (testPrefetched(set_index, victim_index)) {
+                statistics_.recordUnusedPrefetch();
+            }
+            if (prefetch) {
+                uint64_t victim_block = blockAddress(set_index, victim_tag) >> offset_bits_;
+                pollution_filter_[pollutionSlot(victim_block)] = victim_block + 1;
+            }
         }
+        
+        // Hand the victim on; dirty blocks (write-back) are written back
+        evictBlock(blockAddress(set_index, victim_tag), testDirty(set_index, victim_index));
     }
     
     // Load new block
-    cache_[set_index][victim_index].valid = true;
-    cache_[set_index][victim_index].tag = tag;
-    cache_[set_index][victim_index].dirty = (operation == Operation::WRITE && write_policy_ == WritePolicy::WRITE_BACK);
+    valid_bits_[bitWord(set_index, victim_index)] |= bitMask(victim_index);
+    tags_[blockSlot(set_index, victim_index)] = tag;
+    if (block_index_) {
+        block_index_->insert(indexKey(set_index, tag), static_cast<uint32_t>(blockSlot(set_index, victim_index)));
+    }
+    setDirty(set_index, victim_index, dirty);
+    if (prefetcher_) {
+        setPrefetched(set_index, victim_index, prefetch);
+        if (prefetch) {
+            prefetch_ready_[blockSlot(set_index, victim_index)] = trace_position_ + prefetch_latency_;
+        }
+    }
     
-    // Read data from memory (simulated)
-    size_t offset_bits = static_cast<size_t>(std::log2(block_size_));
-    size_t index_bits = static_cast<size_t>(std::log2(num_sets_));
-    readFromMemory((tag << (offset_bits + index_bits)) | (set_index << offset_bits));
+    // Read data from memory (simulated memory holds zeros)
+    if (data_store_) {
+        data_store_->clearBlock(blockSlot(set_index, victim_index));
+    }
+    if (fetch && readFromMemory(blockAddress(set_index, tag), prefetch)) {
+        // Modified data handed over by the lower level stays modified
+        if (WP == WritePolicy::WRITE_BACK) {
+            setDirty(set_index, victim_index, true);
+        } else {
+            writeToMemory(blockAddress(set_index, tag), CacheStatistics::Transfer::WRITEBACK);
+        }
+    }
     
     // Update replacement policy
-    replacement_policy_->updateOnAccess(set_index, victim_index, false);
+    policy.updateOnAccess(set_index, victim_index, false);
     
     return victim_index;
 }
 
-void SetAssociativeCache::writeToMemory(uint64_t address) {
-    // Simulated memory write - in a real implementation, this would access main memory
-    // For simulation purposes, we just track that a memory write occurred
+bool SetAssociativeCache::probeVictimCache(uint64_t address, bool write, bool& dirty) {
+    uint64_t block = address >> offset_bits_;
+    bool hit;
+    if (victim_cache_->getMode() == VictimCache::Mode::VICTIM) {
+        // Swap: the block leaves the buffer and the fill's victim takes its place
+        hit = victim_cache_->remove(block, &dirty);
+    } else {
+        hit = victim_cache_->find(block);
+        if (!hit) {
+            // Miss cache copies are clean, so replaced ones are dropped
+            uint64_t replaced;
+            bool replaced_dirty;
+            victim_cache_->insert(block, false, replaced, replaced_dirty);
+        }
+    }
+    if (hit) {
+        statistics_.recordVictimHit(write);
+    }
+    return hit;
+}
+
+void SetAssociativeCache::evictBlock(uint64_t address, bool dirty) {
+    if (victim_cache_ && victim_cache_->getMode() == VictimCache::Mode::VICTIM) {
+        uint64_t replaced;
+        bool replaced_dirty;
+        if (victim_cache_->insert(address >> offset_bits_, dirty, replaced, replaced_dirty)) {
+            evictToMemory(replaced << offset_bits_, replaced_dirty);
+        }
+        return;
+    }
+    evictToMemory(address, dirty);
+}
+
+void SetAssociativeCache::writeToMemory(uint64_t address, CacheStatistics::Transfer kind) {
+    statistics_.recordTransfer(kind, kind == CacheStatistics::Transfer::WRITEBACK ? block_size_ : kStoreBytes);
+    if (lower_level_) {
+        lower_level_->write(address);
+    }
+}
+
+bool SetAssociativeCache::readFromMemory(uint64_t address, bool prefetch) {
+    statistics_.recordTransfer(prefetch ? CacheStatistics::Transfer::PREFETCH_FILL : CacheStatistics::Transfer::FILL,
+                               block_size_);
+    if (!lower_level_) {
+        return false;
+    }
+    return prefetch ? lower_level_->prefetch(address) : lower_level_->read(address);
+}
+
+void SetAssociativeCache::evictToMemory(uint64_t address, bool dirty) {
+    if (dirty) {
+        statistics_.recordTransfer(CacheStatistics::Transfer::WRITEBACK, block_size_);
+    }
+    if (lower_level_) {
+        lower_level_->evict(address, dirty);
+    }
+}
+
+bool SetAssociativeCache::contains(uint64_t address) const {
+    return findBlock(getSetIndex(address), getTag(address)).hit_way != -1;
 }
 
-void SetAssociativeCache::readFromMemory(uint64_t address) {
-    // Simulated memory read - in a real implementation, this would access main memory
-    // For simulation purposes, we just track that a memory read occurred
+bool SetAssociativeCache::touchBlock(uint64_t address, bool mark_dirty) {
+    size_t set_index = getSetIndex(address);
+    TagLookupResult lookup = findBlock(set_index, getTag(address));
+    if (lookup.hit_way == -1) {
+        return false;
+    }
+    replacement_policy_->updateOnAccess(set_index, lookup.hit_way, true);
+    if (mark_dirty) {
+        setDirty(set_index, lookup.hit_way, true);
+    }
+    return true;
+}
+
+void SetAssociativeCache::insertBlock(uint64_t address, bool dirty) {
+    size_t set_index = getSetIndex(address);
+    uint64_t tag = getTag(address);
+    TagLookupResult lookup = findBlock(set_index, tag);
+    if (lookup.hit_way != -1) {
+        replacement_policy_->updateOnAccess(set_index, lookup.hit_way, true);
+        if (dirty) {
+            setDirty(set_index, lookup.hit_way, true);
+        }
+        return;
+    }
+    
+    // A block coming back from the victim cache must not stay there too
+    bool buffered_dirty = false;
+    if (victim_cache_ && victim_cache_->getMode() == VictimCache::Mode::VICTIM &&
+        victim_cache_->remove(address >> offset_bits_, &buffered_dirty)) {
+        dirty = dirty || buffered_dirty;
+    }
+    
+    // Write-through levels pass modified data on instead of holding it
+    if (write_policy_ == WritePolicy::WRITE_BACK) {
+        allocateBlock<ReplacementPolicy, WritePolicy::WRITE_BACK>(set_index, tag, dirty, lookup.empty_way, false);
+    } else {
+        allocateBlock<ReplacementPolicy, WritePolicy::WRITE_THROUGH>(set_index, tag, false, lookup.empty_way, false);
+        if (dirty) {
+            writeToMemory(blockAddress(set_index, tag), CacheStatistics::Transfer::WRITEBACK);
+        }
+    }
+}
+
+bool SetAssociativeCache::invalidateBlock(uint64_t address, bool* dirty) {
+    size_t set_index = getSetIndex(address);
+    TagLookupResult lookup = findBlock(set_index, getTag(address));
+    if (victim_cache_) {
+        // Victim cache blocks belong to this cache; miss cache copies are dropped silently
+        bool buffered_dirty = false;
+        bool buffered = victim_cache_->remove(address >> offset_bits_, &buffered_dirty);
+        if (lookup.hit_way == -1 && buffered && victim_cache_->getMode() == VictimCache::Mode::VICTIM) {
+            if (dirty) {
+                *dirty = buffered_dirty;
+            }
+            return true;
+        }
+    }
+    if (lookup.hit_way == -1) {
+        return false;
+    }
+    if (dirty) {
+        *dirty = testDirty(set_index, lookup.hit_way);
+    }
+    valid_bits_[bitWord(set_index, lookup.hit_way)] &= ~bitMask(lookup.hit_way);
+    setDirty(set_index, lookup.hit_way, false);
+    if (prefetcher_ && testPrefetched(set_index, lookup.hit_way)) {
+        statistics_.recordUnusedPrefetch();
+        setPrefetched(set_index, lookup.hit_way, false);
+    }
+    valid_counts_[set_index]--;
+    if (block_index_) {
+        block_index_->erase(indexKey(set_index, getTag(address)));
+    }
+    return true;
+}
+
+TagLookupResult SetAssociativeCache::findIndexed(size_t set_index, uint64_t tag) const {
+    TagLookupResult result{-1, -1};
+    int64_t slot = block_index_->find(indexKey(set_index, tag));
+    if (slot >= 0) {
+        result.hit_way = static_cast<int>(static_cast<size_t>(slot) - blockSlot(set_index, 0));
+        return result;
+    }
+    
+    // Empty ways only exist while a set warms up or after invalidations
+    if (valid_counts_[set_index] < associativity_) {
+        const uint64_t* valid = &valid_bits_[bitWord(set_index, 0)];
+        for (size_t word = 0; word < words_per_set_; ++word) {
+            if (~valid[word] != 0) {
+                result.empty_way = static_cast<int>(word * 64 + __builtin_ctzll(~valid[word]));
+                break;
+            }
+        }
+    }
+    return result;
 }
 
 CacheStatistics SetAssociativeCache::getStatistics() const {
@@ -170,16 +475,41 @@ void SetAssociativeCache::resetStatistics() {
 }
 
 void SetAssociativeCache::clear() {
-    for (auto& set : cache_) {
-        for (auto& block : set) {
-            block.valid = false;
-            block.dirty = false;
-            block.tag = 0;
-            std::fill(block.data.begin(), block.data.end(), 0);
-        }
+    std::fill(tags_.begin(), tags_.end(), 0);
+    std::fill(valid_bits_.begin(), valid_bits_.end(), 0);
+    std::fill(dirty_bits_.begin(), dirty_bits_.end(), 0);
+    std::fill(valid_counts_.begin(), valid_counts_.end(), 0);
+    if (block_index_) {
+        block_index_->clear();
+    }
+    if (data_store_) {
+        data_store_->clear();
     }
     replacement_policy_->reset();
+    trace_position_ = 0;
     statistics_.reset();
+    if (victim_cache_) {
+        victim_cache_->clear();
+    }
+    if (prefetcher_) {
+        prefetcher_->reset();
+        std::fill(prefetched_bits_.begin(), prefetched_bits_.end(), 0);
+        std::fill(pollution_filter_.begin(), pollution_filter_.end(), 0);
+    }
+}
+
+void SetAssociativeCache::setPrefetcher(std::unique_ptr<Prefetcher> prefetcher, uint64_t latency) {
+    prefetcher_ = std::move(prefetcher);
+    prefetch_latency_ = latency;
+    if (prefetcher_) {
+        prefetched_bits_.assign(num_sets_ * words_per_set_, 0);
+        prefetch_ready_.assign(num_blocks_, 0);
+        pollution_filter_.assign(kPollutionFilterEntries, 0);
+    } else {
+        prefetched_bits_.clear();
+        prefetch_ready_.clear();
+        pollution_filter_.clear();
+    }
 }
 
 std::string SetAssociativeCache::getConfig() const {
@@ -188,6 +518,13 @@ std::string SetAssociativeCache::getConfig() const {
     oss << "  Replacement Policy: " << replacement_policy_->getName() << "\n";
     oss << "  Write Policy: " << (write_policy_ == WritePolicy::WRITE_THROUGH ? "Write-Through" : "Write-Back") << "\n";
     oss << "  Write Miss Policy: " << (write_miss_policy_ == WriteMissPolicy::WRITE_ALLOCATE ? "Write-Allocate" : "No-Write-Allocate") << "\n";
+    oss << "  Data Mode: " << (data_store_ ? "Track Data" : "Tag Only") << "\n";
+    if (prefetcher_) {
+        oss << "  Prefetcher: " << prefetcher_->getName() << " (latency " << prefetch_latency_ << " accesses)\n";
+    }
+    if (victim_cache_) {
+        oss << "  " << victim_cache_->getName() << ": " << victim_cache_->getCapacity() << " blocks\n";
+    }
     
     return oss.str();
 }
@@ -199,11 +536,10 @@ void SetAssociativeCache::printCacheContents() const {
     for (size_t set = 0; set < num_sets_; ++set) {
         std::cout << "Set " << set << ": ";
         for (size_t way = 0; way < associativity_; ++way) {
-            const auto& block = cache_[set][way];
-            if (block.valid) {
-                std::cout << "[V:" << (block.valid ? "1" : "0") 
-                         << " D:" << (block.dirty ? "1" : "0")
-                         << " Tag:0x" << std::hex << block.tag << std::dec << "] ";
+            if (testValid(set, way)) {
+                std::cout << "[V:1"
+                         << " D:" << (testDirty(set, way) ? "1" : "0")
+                         << " Tag:0x" << std::hex << tags_[blockSlot(set, way)] << std::dec << "] ";
             } else {
                 std::cout << "[Invalid] ";
             }
@@ -213,6 +549,25 @@ void SetAssociativeCache::printCacheContents() const {
     std::cout << "================\n\n";
 }
 
+std::vector<std::vector<CacheBlock>> SetAssociativeCache::getCacheContents() const {
+    std::vector<std::vector<CacheBlock>> contents(num_sets_);
+    for (size_t set = 0; set < num_sets_; ++set) {
+        contents[set].reserve(associativity_);
+        for (size_t way = 0; way < associativity_; ++way) {
+            CacheBlock block;
+            block.valid = testValid(set, way);
+            block.dirty = testDirty(set, way);
+            block.tag = tags_[blockSlot(set, way)];
+            if (data_store_) {
+                const uint8_t* bytes = data_store_->block(blockSlot(set, way));
+                block.data.assign(bytes, bytes + block_size_);
+            }
+            contents[set].push_back(std::move(block));
+        }
+    }
+    return contents;
+}
+
 std::string SetAssociativeCache::getCacheContentsJSON() const {
     std::ostringstream json;
     json << "{";
@@ -226,12 +581,11 @@ std::string SetAssociativeCache::getCacheContentsJSON() const {
         
         for (size_t way = 0; way < associativity_; ++way) {
             if (way > 0) json << ", ";
-            const auto& block = cache_[set][way];
             json << "{";
             json << "\"way\": " << way << ", ";
-            json << "\"valid\": " << (block.valid ? "true" : "false") << ", ";
-            json << "\"dirty\": " << (block.dirty ? "true" : "false") << ", ";
-            json << "\"tag\": \"0x" << std::hex << block.tag << std::dec << "\"";
+            json << "\"valid\": " << (testValid(set, way) ? "true" : "false") << ", ";
+            json << "\"dirty\": " << (testDirty(set, way) ? "true" : "false") << ", ";
+            json << "\"tag\": \"0x" << std::hex << tags_[blockSlot(set, way)] << std::dec << "\"";
             json << "}";
         }
         
@@ -249,19 +603,33 @@ bool SetAssociativeCache::isBlockValid(size_t set_index, size_t block_index) con
     if (set_index >= num_sets_ || block_index >= associativity_) {
         return false;
     }
-    return cache_[set_index][block_index].valid;
+    return testValid(set_index, block_index);
 }
 
 bool SetAssociativeCache::isBlockDirty(size_t set_index, size_t block_index) const {
     if (set_index >= num_sets_ || block_index >= associativity_) {
         return false;
     }
-    return cache_[set_index][block_index].dirty;
+    return testDirty(set_index, block_index);
+}
+
+bool SetAssociativeCache::isBlockPrefetched(size_t set_index, size_t block_index) const {
+    if (!prefetcher_ || set_index >= num_sets_ || block_index >= associativity_) {
+        return false;
+    }
+    return testPrefetched(set_index, block_index);
 }
 
 uint64_t SetAssociativeCache::getBlockTag(size_t set_index, size_t block_index) const {
     if (set_index >= num_sets_ || block_index >= associativity_) {
         return 0;
     }
-    return cache_[set_index][block_index].tag;
+    return tags_[blockSlot(set_index, block_index)];
+}
+
+const uint8_t* SetAssociativeCache::getBlockData(size_t set_index, size_t block_index) const {
+    if (!data_store_ || set_index >= num_sets_ || block_index >= associativity_) {
+        return nullptr;
+    }
+    return data_store_->block(blockSlot(set_index, block_index));
 }
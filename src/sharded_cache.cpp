@@ -0,0 +1,208 @@
+#include "sharded_cache.h"
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+namespace {
+
+// Run fn(0..count-1) with one thread per index; index 0 runs on the caller
+template <typename Fn>
+void parallelFor(size_t count, Fn fn) {
+    std::vector<std::thread> threads;
+    threads.reserve(count > 0 ? count - 1 : 0);
+    for (size_t i = 1; i < count; ++i) {
+        threads.emplace_back(fn, i);
+    }
+    if (count > 0) fn(0);
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+} // namespace
+
+ShardedCache::ShardedCache(const CacheSpec& spec, size_t threads)
+    : Cache(spec.cache_size, spec.block_size, spec.associativity), shard_bits_(0), local_index_bits_(0) {
+    // A shard only sees its own sets, so strides and streams would be cut apart
+    if (spec.hasPrefetcher()) {
+        throw std::invalid_argument("Prefetchers cannot be combined with --threads");
+    }
+    // Nor would a buffer per shard behave like one shared by all sets
+    if (spec.hasVictimCache()) {
+        throw std::invalid_argument("Victim and miss caches cannot be combined with --threads");
+    }
+    // BRRIP's fill counter and DRRIP's leader sets and PSEL counter span the whole cache
+    auto policy = ReplacementPolicyFactory::stringToPolicy(spec.replacement_policy);
+    if (policy == ReplacementPolicyFactory::PolicyType::BRRIP ||
+        policy == ReplacementPolicyFactory::PolicyType::DRRIP) {
+        throw std::invalid_argument("BRRIP and DRRIP replacement cannot be combined with --threads");
+    }
+    
+    // Largest power of two within both the thread count and the set count
+    size_t max_shards = std::min<size_t>(std::max<size_t>(threads, 1), std::min<size_t>(num_sets_, 256));
+    while ((size_t(2) << shard_bits_) <= max_shards) ++shard_bits_;
+    local_index_bits_ = index_bits_ - shard_bits_;
+    
+    CacheSpec shard_spec = spec;
+    shard_spec.cache_size = spec.cache_size >> shard_bits_;
+    for (size_t i = 0; i < (size_t(1) << shard_bits_); ++i) {
+        // Distinct but reproducible random streams per shard
+        shard_spec.seed = spec.seed + i;
+        shards_.push_back(shard_spec.createCache());
+    }
+}
+
+Cache::AccessResult ShardedCache::access(uint64_t address, Operation operation) {
+    return shards_[shardOf(address)]->access(address, operation);
+}
+
+Cache::BatchResult ShardedCache::accessBatch(const uint64_t* addresses, const Operation* operations,
+                                             size_t count, AccessResult* results) {
+    size_t num_shards = shards_.size();
+    if (num_shards == 1) {
+        return shards_[0]->accessBatch(addresses, operations, count, results);
+    }
+    
+    size_t slices = count >= kMinParallelBatch ? num_shards : 1;
+    size_t slice_size = (count + slices - 1) / slices;
+    auto sliceBegin = [&](size_t slice) { return std::min(count, slice * slice_size); };
+    
+    // Pass 1: shard of every access and per-slice shard counts
+    shard_ids_.resize(count);
+    std::vector<size_t> offsets(slices * num_shards, 0); // slice * num_shards + shard
+    parallelFor(slices, [&](size_t slice) {
+        size_t* slice_counts = &offsets[slice * num_shards];
+        for (size_t i = sliceBegin(slice); i < sliceBegin(slice + 1); ++i) {
+            size_t shard = shardOf(addresses[i]);
+            shard_ids_[i] = static_cast<uint8_t>(shard);
+            slice_counts[shard]++;
+        }
+    });
+    
+    // Exclusive prefix sum in shard-major, slice-minor order keeps input order within each shard
+    std::vector<size_t> shard_begin(num_shards + 1, 0);
+    size_t running = 0;
+    for (size_t shard = 0; shard < num_shards; ++shard) {
+        shard_begin[shard] = running;
+        for (size_t slice = 0; slice < slices; ++slice) {
+            size_t n = offsets[slice * num_shards + shard];
+            offsets[slice * num_shards + shard] = running;
+            running += n;
+        }
+    }
+    shard_begin[num_shards] = running;
+    
+    // Pass 2: scatter into per-shard runs
+    part_addresses_.resize(count);
+    part_operations_.resize(count);
+    if (results) {
+        part_positions_.resize(count);
+        part_results_.resize(count);
+    }
+    parallelFor(slices, [&](size_t slice) {
+        size_t* cursor = &offsets[slice * num_shards];
+        for (size_t i = sliceBegin(slice); i < sliceBegin(slice + 1); ++i) {
+            size_t j = cursor[shard_ids_[i]]++;
+            part_addresses_[j] = addresses[i];
+            part_operations_[j] = operations[i];
+            if (results) part_positions_[j] = i;
+        }
+    });
+    
+    // Pass 3: simulate each shard and return results to their original positions
+    std::vector<BatchResult> shard_results(num_shards);
+    parallelFor(slices == 1 ? 1 : num_shards, [&](size_t worker) {
+        size_t first = slices == 1 ? 0 : worker;
+        size_t last = slices == 1 ? num_shards : worker + 1;
+        for (size_t shard = first; shard < last; ++shard) {
+            size_t begin = shard_begin[shard];
+            size_t n = shard_begin[shard + 1] - begin;
+            shard_results[shard] = shards_[shard]->accessBatch(
+                part_addresses_.data() + begin, part_operations_.data() + begin, n,
+                results ? part_results_.data() + begin : nullptr);
+            if (results) {
+                for (size_t j = begin; j < begin + n; ++j) {
+                    results[part_positions_[j]] = part_results_[j];
+                }
+            }
+        }
+    });
+    
+    BatchResult batch;
+    for (const auto& result : shard_results) {
+        batch.read_hits += result.read_hits;
+        batch.read_misses += result.read_misses;
+        batch.write_hits += result.write_hits;
+        batch.write_misses += result.write_misses;
+    }
+    return batch;
+}
+
+CacheStatistics ShardedCache::getStatistics() const {
+    CacheStatistics statistics;
+    for (const auto& shard : shards_) {
+        statistics.merge(shard->getStatistics());
+    }
+    return statistics;
+}
+
+Cache::PolicyCounters ShardedCache::getPolicyCounters() const {
+    PolicyCounters counters = shards_[0]->getPolicyCounters();
+    for (size_t shard = 1; shard < shards_.size(); ++shard) {
+        PolicyCounters shard_counters = shards_[shard]->getPolicyCounters();
+        for (size_t i = 0; i < counters.size() && i < shard_counters.size(); ++i) {
+            counters[i].second += shard_counters[i].second;
+        }
+    }
+    return counters;
+}
+
+void ShardedCache::resetStatistics() {
+    for (auto& shard : shards_) {
+        shard->resetStatistics();
+    }
+}
+
+void ShardedCache::clear() {
+    for (auto& shard : shards_) {
+        shard->clear();
+    }
+}
+
+std::string ShardedCache::getConfig() const {
+    const SetAssociativeCache& shard = *shards_[0];
+    std::ostringstream oss;
+    oss << Cache::getConfig();
+    oss << "  Replacement Policy: " << shard.getReplacementPolicy().getName() << "\n";
+    oss << "  Write Policy: " << (shard.getWritePolicy() == SetAssociativeCache::WritePolicy::WRITE_THROUGH ? "Write-Through" : "Write-Back") << "\n";
+    oss << "  Write Miss Policy: " << (shard.getWriteMissPolicy() == SetAssociativeCache::WriteMissPolicy::WRITE_ALLOCATE ? "Write-Allocate" : "No-Write-Allocate") << "\n";
+    oss << "  Data Mode: " << (shard.getDataMode() == SetAssociativeCache::DataMode::TRACK_DATA ? "Track Data" : "Tag Only") << "\n";
+    oss << "  Set Shards: " << shards_.size() << "\n";
+    
+    return oss.str();
+}
+
+void ShardedCache::printCacheContents() const {
+    std::cout << "\nCache Contents:\n";
+    std::cout << "================\n";
+    
+    // Shard tags carry the shard bits below the real tag
+    size_t local_sets = num_sets_ >> shard_bits_;
+    for (size_t set = 0; set < num_sets_; ++set) {
+        const SetAssociativeCache& shard = *shards_[set / local_sets];
+        size_t local_set = set % local_sets;
+        std::cout << "Set " << set << ": ";
+        for (size_t way = 0; way < associativity_; ++way) {
+            if (shard.isBlockValid(local_set, way)) {
+                std::cout << "[V:1"
+                         << " D:" << (shard.isBlockDirty(local_set, way) ? "1" : "0")
+                         << " Tag:0x" << std::hex << (shard.getBlockTag(local_set, way) >> shard_bits_) << std::dec << "] ";
+            } else {
+                std::cout << "[Invalid] ";
+            }
+        }
+        std::cout << "\n";
+    }
+    std::cout << "================\n\n";
+}
@@ -0,0 +1,175 @@
+#include "stack_distance.h"
+#include <algorithm>
+#include <iomanip>
+#include <stdexcept>
+
+namespace {
+
+bool isPowerOfTwo(size_t value) {
+    return value != 0 && (value & (value - 1)) == 0;
+}
+
+constexpr size_t kInitialCapacity = 1 << 16;
+
+} // namespace
+
+StackDistanceAnalyzer::StackDistanceAnalyzer(size_t block_size, size_t num_sets, size_t max_ways)
+    : block_size_(block_size), offset_bits_(0), num_sets_(num_sets), max_ways_(max_ways),
+      accesses_(0), tree_(kInitialCapacity + 1, 0), time_(0) {
+    if (!isPowerOfTwo(block_size) || !isPowerOfTwo(num_sets)) {
+        throw std::invalid_argument("Block size and set count must be powers of two");
+    }
+    if (max_ways == 0) {
+        throw std::invalid_argument("Maximum associativity must be greater than 0");
+    }
+    while ((size_t(1) << offset_bits_) < block_size_) ++offset_bits_;
+    
+    set_stacks_.assign(num_sets_ * max_ways_, 0);
+    set_depths_.assign(num_sets_, 0);
+    set_histograms_.assign(num_sets_ * (max_ways_ + 1), 0);
+}
+
+void StackDistanceAnalyzer::treeAdd(uint64_t position, int32_t delta) {
+    for (; position < tree_.size(); position += position & (0 - position)) {
+        tree_[position] += delta;
+    }
+}
+
+uint64_t StackDistanceAnalyzer::treePrefix(uint64_t position) const {
+    uint64_t sum = 0;
+    for (; position > 0; position -= position & (0 - position)) {
+        sum += tree_[position];
+    }
+    return sum;
+}
+
+void StackDistanceAnalyzer::compact() {
+    // Renumber live positions 1..n in recency order and rebuild the tree
+    std::vector<std::pair<uint64_t, uint64_t>> live; // (position, block)
+    live.reserve(last_access_.size());
+    for (const auto& entry : last_access_) {
+        live.emplace_back(entry.second, entry.first);
+    }
+    std::sort(live.begin(), live.end());
+    
+    size_t capacity = std::max(kInitialCapacity, 2 * live.size());
+    tree_.assign(capacity + 1, 0);
+    for (size_t i = 0; i < live.size(); ++i) {
+        last_access_[live[i].second] = i + 1;
+        tree_[i + 1] = 1;
+    }
+    // Linear-time Fenwick build from the marks
+    for (size_t i = 1; i <= capacity; ++i) {
+        size_t parent = i + (i & (0 - i));
+        if (parent <= capacity) tree_[parent] += tree_[i];
+    }
+    time_ = live.size();
+}
+
+void StackDistanceAnalyzer::access(uint64_t address) {
+    uint64_t block = address >> offset_bits_;
+    ++accesses_;
+    
+    if (time_ + 1 >= tree_.size()) {
+        compact();
+    }
+    uint64_t now = ++time_;
+    
+    auto it = last_access_.find(block);
+    if (it == last_access_.end()) {
+        last_access_.emplace(block, now);
+    } else {
+        // Live marks after the previous access are the distinct blocks since then
+        uint64_t distance = last_access_.size() - treePrefix(it->second);
+        if (distance >= distance_histogram_.size()) {
+            distance_histogram_.resize(distance + 1, 0);
+        }
+        ++distance_histogram_[distance];
+        treeAdd(it->second, -1);
+        it->second = now;
+    }
+    treeAdd(now, 1);
+    
+    accessSet(block);
+}
+
+void StackDistanceAnalyzer::accessSet(uint64_t block) {
+    size_t set = block & (num_sets_ - 1);
+    uint64_t* stack = &set_stacks_[set * max_ways_];
+    uint32_t& depth = set_depths_[set];
+    
+    size_t position = 0;
+    while (position < depth && stack[position] != block) ++position;
+    
+    bool found = position < depth;
+    set_histograms_[set * (max_ways_ + 1) + (found ? position : max_ways_)]++;
+    
+    // Move to front; a miss pushes the least recent entry out of a full stack
+    if (!found && depth < max_ways_) {
+        ++depth;
+    }
+    size_t shift = std::min<size_t>(position, max_ways_ - 1);
+    std::move_backward(stack, stack + shift, stack + shift + 1);
+    stack[0] = block;
+}
+
+void StackDistanceAnalyzer::accessBatch(const uint64_t* addresses, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        access(addresses[i]);
+    }
+}
+
+uint64_t StackDistanceAnalyzer::getMisses(size_t blocks) const {
+    uint64_t hits = 0;
+    size_t limit = std::min(blocks, distance_histogram_.size());
+    for (size_t d = 0; d < limit; ++d) {
+        hits += distance_histogram_[d];
+    }
+    return accesses_ - hits;
+}
+
+uint64_t StackDistanceAnalyzer::getSetAssociativeMisses(size_t ways) const {
+    if (ways == 0 || ways > max_ways_) {
+        throw std::out_of_range("Associativity outside the tracked range");
+    }
+    uint64_t hits = 0;
+    for (size_t set = 0; set < num_sets_; ++set) {
+        const uint64_t* histogram = &set_histograms_[set * (max_ways_ + 1)];
+        for (size_t d = 0; d < ways; ++d) {
+            hits += histogram[d];
+        }
+    }
+    return accesses_ - hits;
+}
+
+std::vector<uint64_t> StackDistanceAnalyzer::getSetHistogram(size_t set) const {
+    auto begin = set_histograms_.begin() + set * (max_ways_ + 1);
+    return std::vector<uint64_t>(begin, begin + max_ways_ + 1);
+}
+
+void StackDistanceAnalyzer::writeCurve(std::ostream& os) const {
+    auto missRate = [this](uint64_t misses) {
+        return accesses_ > 0 ? 100.0 * misses / accesses_ : 0.0;
+    };
+    
+    os << "# LRU miss-ratio curves: " << accesses_ << " accesses, " << getColdMisses()
+       << " cold misses, block size " << block_size_ << "\n";
+    os << "type,sets,ways,blocks,cache_size,misses,miss_rate\n";
+    os << std::fixed << std::setprecision(4);
+    
+    uint64_t misses = accesses_;
+    for (size_t d = 0; d < distance_histogram_.size(); ++d) {
+        if (distance_histogram_[d] == 0) continue;
+        misses -= distance_histogram_[d];
+        size_t blocks = d + 1;
+        os << "fully_associative,1," << blocks << "," << blocks << "," << blocks * block_size_ << ","
+           << misses << "," << missRate(misses) << "\n";
+    }
+    
+    for (size_t ways = 1; ways <= max_ways_; ++ways) {
+        uint64_t set_misses = getSetAssociativeMisses(ways);
+        size_t blocks = num_sets_ * ways;
+        os << "set_associative," << num_sets_ << "," << ways << "," << blocks << "," << blocks * block_size_ << ","
+           << set_misses << "," << missRate(set_misses) << "\n";
+    }
+}
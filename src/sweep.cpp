@@ -0,0 +1,292 @@
+#include "sweep.h"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+namespace {
+
+// A chunk of decoded trace shared by all configurations
+struct TraceChunk {
+    std::vector<uint64_t> addresses;
+    std::vector<Cache::Operation> operations;
+};
+
+// Per-configuration progress through the chunk window
+struct SweepJob {
+    std::unique_ptr<SetAssociativeCache> cache;
+    size_t next_chunk = 0;    // Absolute index of the next chunk to simulate
+    bool busy = false;        // Claimed by a worker
+    double seconds = 0.0;
+};
+
+} // namespace
+
+std::vector<CacheSpec> parseSweepGrid(const std::string& grid, const CacheSpec& base) {
+    std::vector<CacheSpec> specs{base};
+    
+    for (const auto& entry : CacheSpec::splitList(grid, ';')) {
+        size_t eq = entry.find('=');
+        if (eq == std::string::npos) {
+            throw std::invalid_argument("Expected key=values in sweep grid: " + entry);
+        }
+        std::string key = CacheSpec::trim(entry.substr(0, eq));
+        std::vector<std::string> values = CacheSpec::splitList(entry.substr(eq + 1), ',');
+        if (values.empty()) {
+            throw std::invalid_argument("No values for '" + key + "' in sweep grid");
+        }
+        
+        std::vector<CacheSpec> expanded;
+        for (const auto& spec : specs) {
+            for (const auto& value : values) {
+                CacheSpec next = spec;
+                if (!next.setParameter(key, value)) {
+                    throw std::invalid_argument("Unknown sweep parameter: " + key);
+                }
+                expanded.push_back(next);
+            }
+        }
+        specs = std::move(expanded);
+    }
+    
+    return specs;
+}
+
+std::vector<SweepResult> runSweep(TraceReader& reader, const std::vector<CacheSpec>& specs, size_t threads,
+                                  const std::vector<std::shared_ptr<const NextUseIndex>>& next_use) {
+    constexpr size_t kChunkRecords = 1 << 16;
+    
+    // Build caches up front; invalid grid points are skipped
+    std::vector<CacheSpec> valid_specs;
+    std::vector<SweepJob> jobs;
+    for (const auto& spec : specs) {
+        try {
+            std::shared_ptr<const NextUseIndex> index;
+            if (spec.needsNextUseIndex()) {
+                for (const auto& candidate : next_use) {
+                    if (candidate->getBlockSize() == spec.block_size) {
+                        index = candidate;
+                    }
+                }
+            }
+            SweepJob job;
+            job.cache = spec.createCache(index);
+            jobs.push_back(std::move(job));
+            valid_specs.push_back(spec);
+        } catch (const std::exception& e) {
+            std::cerr << "Warning: skipping " << spec.toString() << ": " << e.what() << std::endl;
+        }
+    }
+    
+    if (jobs.empty()) {
+        return {};
+    }
+    
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    threads = std::max<size_t>(1, std::min(threads, jobs.size()));
+    const size_t max_window = 2 * threads + 2;
+    
+    // Shared window of decoded chunks, guarded by mutex
+    std::mutex mutex;
+    std::condition_variable chunk_ready;     // Workers: new chunk or job released
+    std::condition_variable window_space;    // Decoder: a chunk was retired
+    std::deque<std::shared_ptr<const TraceChunk>> window;
+    size_t window_base = 0;                  // Absolute index of window.front()
+    bool end_of_trace = false;
+    
+    // Drop chunks every job has consumed; caller holds the lock
+    auto retire = [&]() {
+        size_t min_next = window_base + window.size();
+        for (const auto& job : jobs) {
+            min_next = std::min(min_next, job.next_chunk);
+        }
+        bool retired = false;
+        while (window_base < min_next) {
+            window.pop_front();
+            ++window_base;
+            retired = true;
+        }
+        if (retired) window_space.notify_one();
+    };
+    
+    auto worker = [&]() {
+        std::vector<std::shared_ptr<const TraceChunk>> pending;
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            // Pick the idle job that is furthest behind so the window drains
+            SweepJob* job = nullptr;
+            bool all_done = true;
+            size_t available = window_base + window.size();
+            for (auto& candidate : jobs) {
+                if (candidate.next_chunk < available || candidate.busy) all_done = false;
+                if (!candidate.busy && candidate.next_chunk < available &&
+                    (!job || candidate.next_chunk < job->next_chunk)) {
+                    job = &candidate;
+                }
+            }
+            if (!job) {
+                if (end_of_trace && all_done) return;
+                chunk_ready.wait(lock);
+                continue;
+            }
+            
+            job->busy = true;
+            pending.assign(window.begin() + (job->next_chunk - window_base), window.end());
+            lock.unlock();
+            
+            auto start = std::chrono::steady_clock::now();
+            for (const auto& chunk : pending) {
+                job->cache->accessBatch(chunk->addresses.data(), chunk->operations.data(),
+                                        chunk->addresses.size());
+            }
+            job->seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            
+            lock.lock();
+            job->next_chunk += pending.size();
+            job->busy = false;
+            pending.clear();
+            retire();
+            chunk_ready.notify_all();
+        }
+    };
+    
+    std::vector<std::thread> workers;
+    for (size_t i = 0; i < threads; ++i) {
+        workers.emplace_back(worker);
+    }
+    
+    // Decode on the calling thread
+    auto finish = [&]() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            end_of_trace = true;
+        }
+        chunk_ready.notify_all();
+        for (auto& thread : workers) {
+            thread.join();
+        }
+    };
+    
+    try {
+        std::vector<TraceRecord> records;
+        records.reserve(kChunkRecords);
+        while (reader.read(records, kChunkRecords) > 0) {
+            auto chunk = std::make_shared<TraceChunk>();
+            chunk->addresses.reserve(records.size());
+            chunk->operations.reserve(records.size());
+            for (const auto& record : records) {
+                chunk->addresses.push_back(record.address);
+                chunk->operations.push_back(record.operation);
+            }
+            records.clear();
+            
+            std::unique_lock<std::mutex> lock(mutex);
+            window_space.wait(lock, [&] { return window.size() < max_window; });
+            window.push_back(std::move(chunk));
+            lock.unlock();
+            chunk_ready.notify_all();
+        }
+    } catch (...) {
+        finish();
+        throw;
+    }
+    finish();
+    
+    std::vector<SweepResult> results;
+    for (size_t i = 0; i < jobs.size(); ++i) {
+        results.push_back(SweepResult{valid_specs[i], jobs[i].cache->getStatistics(), jobs[i].seconds});
+    }
+    return results;
+}
+
+void writeSweepCSV(std::ostream& os, const std::vector<SweepResult>& results) {
+    os << "cache_size,block_size,associativity,replacement_policy,write_policy,write_miss_policy,"
+       << "prefetcher,prefetch_degree,prefetch_distance,prefetch_latency,victim_cache,miss_cache,"
+       << "hit_latency,miss_penalty,accesses,hits,misses,hit_rate,miss_rate,reads,writes,read_hits,read_misses,"
+       << "write_hits,write_misses,prefetches,useful_prefetches,late_prefetches,unused_prefetches,"
+       << "polluting_prefetches,victim_hits,memory_read_bytes,memory_write_bytes,"
+       << "total_cycles,amat,read_p50,read_p99,write_p50,write_p99,simulation_time\n";
+    for (const auto& result : results) {
+        const CacheSpec& spec = result.spec;
+        const CacheStatistics& stats = result.statistics;
+        AccessTiming timing = spec.evaluateTiming(stats);
+        os << spec.cache_size << "," << spec.block_size << "," << spec.associativity << ","
+           << spec.replacement_policy << "," << spec.write_policy << "," << spec.write_miss_policy << ","
+           << spec.prefetcher << "," << spec.prefetch_degree << "," << spec.prefetch_distance << ","
+           << spec.prefetch_latency << "," << spec.victim_cache << "," << spec.miss_cache << ","
+           << spec.hit_latency << "," << spec.miss_penalty << ","
+           << stats.getTotalAccesses() << "," << stats.getHits() << "," << stats.getMisses() << ","
+           << std::fixed << std::setprecision(4) << stats.getHitRate() << "," << stats.getMissRate() << ","
+           << stats.getReads() << "," << stats.getWrites() << ","
+           << (stats.getHits() - stats.getWriteHits()) << "," << (stats.getMisses() - stats.getWriteMisses()) << ","
+           << stats.getWriteHits() << "," << stats.getWriteMisses() << ","
+           << stats.getPrefetches() << "," << stats.getUsefulPrefetches() << "," << stats.getLatePrefetches() << ","
+           << stats.getUnusedPrefetches() << "," << stats.getPollutingPrefetches() << "," << stats.getVictimHits() << ","
+           << stats.getMemoryReadBytes() << "," << stats.getMemoryWriteBytes() << ","
+           << timing.getTotalCycles() << "," << timing.getAMAT() << ","
+           << timing.reads.getPercentile(50) << "," << timing.reads.getPercentile(99) << ","
+           << timing.writes.getPercentile(50) << "," << timing.writes.getPercentile(99) << ","
+           << std::setprecision(6) << result.simulation_time << "\n";
+    }
+}
+
+void writeSweepJSON(std::ostream& os, const std::vector<SweepResult>& results) {
+    os << "[\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const CacheSpec& spec = results[i].spec;
+        const CacheStatistics& stats = results[i].statistics;
+        AccessTiming timing = spec.evaluateTiming(stats);
+        os << "  {\"cache_size\": " << spec.cache_size
+           << ", \"block_size\": " << spec.block_size
+           << ", \"associativity\": " << spec.associativity
+           << ", \"replacement_policy\": \"" << spec.replacement_policy << "\""
+           << ", \"write_policy\": \"" << spec.write_policy << "\""
+           << ", \"write_miss_policy\": \"" << spec.write_miss_policy << "\""
+           << ", \"prefetcher\": \"" << spec.prefetcher << "\""
+           << ", \"prefetch_degree\": " << spec.prefetch_degree
+           << ", \"prefetch_distance\": " << spec.prefetch_distance
+           << ", \"prefetch_latency\": " << spec.prefetch_latency
+           << ", \"victim_cache\": " << spec.victim_cache
+           << ", \"miss_cache\": " << spec.miss_cache
+           << ", \"hit_latency\": " << spec.hit_latency
+           << ", \"miss_penalty\": " << spec.miss_penalty
+           << ", \"accesses\": " << stats.getTotalAccesses()
+           << ", \"hits\": " << stats.getHits()
+           << ", \"misses\": " << stats.getMisses()
+           << std::fixed << std::setprecision(4)
+           << ", \"hit_rate\": " << stats.getHitRate()
+           << ", \"miss_rate\": " << stats.getMissRate()
+           << ", \"reads\": " << stats.getReads()
+           << ", \"writes\": " << stats.getWrites()
+           << ", \"read_hits\": " << (stats.getHits() - stats.getWriteHits())
+           << ", \"read_misses\": " << (stats.getMisses() - stats.getWriteMisses())
+           << ", \"write_hits\": " << stats.getWriteHits()
+           << ", \"write_misses\": " << stats.getWriteMisses()
+           << ", \"prefetches\": " << stats.getPrefetches()
+           << ", \"useful_prefetches\": " << stats.getUsefulPrefetches()
+           << ", \"late_prefetches\": " << stats.getLatePrefetches()
+           << ", \"unused_prefetches\": " << stats.getUnusedPrefetches()
+           << ", \"polluting_prefetches\": " << stats.getPollutingPrefetches()
+           << ", \"victim_hits\": " << stats.getVictimHits()
+           << ", \"memory_read_bytes\": " << stats.getMemoryReadBytes()
+           << ", \"memory_write_bytes\": " << stats.getMemoryWriteBytes()
+           << ", \"total_cycles\": " << timing.getTotalCycles()
+           << ", \"amat\": " << timing.getAMAT()
+           << ", \"read_p50\": " << timing.reads.getPercentile(50)
+           << ", \"read_p99\": " << timing.reads.getPercentile(99)
+           << ", \"write_p50\": " << timing.writes.getPercentile(50)
+           << ", \"write_p99\": " << timing.writes.getPercentile(99)
+           << std::setprecision(6)
+           << ", \"simulation_time\": " << results[i].simulation_time << "}"
+           << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    os << "]\n";
+}
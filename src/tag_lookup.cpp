@@ -0,0 +1,186 @@
+#include "tag_lookup.h"
+
+#if defined(__GNUC__) && defined(__x86_64__)
+    #include <immintrin.h>
+    #define TAG_LOOKUP_X86 1
+#endif
+
+namespace {
+
+// Valid bits of the ways covered by word w, with bits past the last way cleared
+inline uint64_t wordWayMask(size_t ways, size_t w) {
+    size_t ways_in_word = ways - w * 64;
+    return ways_in_word >= 64 ? ~0ULL : ((1ULL << ways_in_word) - 1);
+}
+
+TagLookupResult lookupScalar(const uint64_t* tags, const uint64_t* valid_words, size_t ways, uint64_t tag) {
+    TagLookupResult result{-1, -1};
+    size_t num_words = (ways + 63) / 64;
+    for (size_t w = 0; w < num_words; ++w) {
+        uint64_t way_mask = wordWayMask(ways, w);
+        uint64_t valid = valid_words[w] & way_mask;
+        if (result.empty_way < 0 && (~valid & way_mask)) {
+            result.empty_way = static_cast<int>(w * 64 + __builtin_ctzll(~valid & way_mask));
+        }
+        const uint64_t* word_tags = tags + w * 64;
+        for (uint64_t bits = valid; bits; bits &= bits - 1) {
+            size_t i = __builtin_ctzll(bits);
+            if (word_tags[i] == tag) {
+                result.hit_way = static_cast<int>(w * 64 + i);
+                return result;
+            }
+        }
+    }
+    return result;
+}
+
+#ifdef TAG_LOOKUP_X86
+
+TagLookupResult lookupSSE2(const uint64_t* tags, const uint64_t* valid_words, size_t ways, uint64_t tag) {
+    TagLookupResult result{-1, -1};
+    const __m128i probe = _mm_set1_epi64x(static_cast<long long>(tag));
+    size_t num_words = (ways + 63) / 64;
+    for (size_t w = 0; w < num_words; ++w) {
+        uint64_t way_mask = wordWayMask(ways, w);
+        uint64_t valid = valid_words[w] & way_mask;
+        if (result.empty_way < 0 && (~valid & way_mask)) {
+            result.empty_way = static_cast<int>(w * 64 + __builtin_ctzll(~valid & way_mask));
+        }
+        if (!valid) {
+            continue;
+        }
+        const uint64_t* word_tags = tags + w * 64;
+        size_t n = ways - w * 64 < 64 ? ways - w * 64 : 64;
+        size_t i = 0;
+        for (; i + 2 <= n; i += 2) {
+            // SSE2 has no 64-bit equality: compare 32-bit halves and require both to match
+            __m128i t = _mm_loadu_si128(reinterpret_cast<const __m128i*>(word_tags + i));
+            __m128i eq32 = _mm_cmpeq_epi32(t, probe);
+            __m128i eq64 = _mm_and_si128(eq32, _mm_shuffle_epi32(eq32, _MM_SHUFFLE(2, 3, 0, 1)));
+            uint64_t match = static_cast<uint64_t>(_mm_movemask_pd(_mm_castsi128_pd(eq64))) & (valid >> i);
+            if (match) {
+                result.hit_way = static_cast<int>(w * 64 + i + __builtin_ctzll(match));
+                return result;
+            }
+        }
+        if (i < n && ((valid >> i) & 1) && word_tags[i] == tag) {
+            result.hit_way = static_cast<int>(w * 64 + i);
+            return result;
+        }
+    }
+    return result;
+}
+
+__attribute__((target("avx2")))
+TagLookupResult lookupAVX2(const uint64_t* tags, const uint64_t* valid_words, size_t ways, uint64_t tag) {
+    TagLookupResult result{-1, -1};
+    const __m256i probe = _mm256_set1_epi64x(static_cast<long long>(tag));
+    size_t num_words = (ways + 63) / 64;
+    for (size_t w = 0; w < num_words; ++w) {
+        uint64_t way_mask = wordWayMask(ways, w);
+        uint64_t valid = valid_words[w] & way_mask;
+        if (result.empty_way < 0 && (~valid & way_mask)) {
+            result.empty_way = static_cast<int>(w * 64 + __builtin_ctzll(~valid & way_mask));
+        }
+        if (!valid) {
+            continue;
+        }
+        const uint64_t* word_tags = tags + w * 64;
+        size_t n = ways - w * 64 < 64 ? ways - w * 64 : 64;
+        size_t i = 0;
+        for (; i + 8 <= n; i += 8) {
+            __m256i lo = _mm256_cmpeq_epi64(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(word_tags + i)), probe);
+            __m256i hi = _mm256_cmpeq_epi64(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(word_tags + i + 4)), probe);
+            uint64_t match = static_cast<uint64_t>(_mm256_movemask_pd(_mm256_castsi256_pd(lo)))
+                           | (static_cast<uint64_t>(_mm256_movemask_pd(_mm256_castsi256_pd(hi))) << 4);
+            match &= valid >> i;
+            if (match) {
+                result.hit_way = static_cast<int>(w * 64 + i + __builtin_ctzll(match));
+                return result;
+            }
+        }
+        if (i + 4 <= n) {
+            __m256i eq = _mm256_cmpeq_epi64(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(word_tags + i)), probe);
+            uint64_t match = static_cast<uint64_t>(_mm256_movemask_pd(_mm256_castsi256_pd(eq))) & (valid >> i);
+            if (match) {
+                result.hit_way = static_cast<int>(w * 64 + i + __builtin_ctzll(match));
+                return result;
+            }
+            i += 4;
+        }
+        for (; i < n; ++i) {
+            if (((valid >> i) & 1) && word_tags[i] == tag) {
+                result.hit_way = static_cast<int>(w * 64 + i);
+                return result;
+            }
+        }
+    }
+    return result;
+}
+
+#endif // TAG_LOOKUP_X86
+
+using LookupFunction = TagLookupResult (*)(const uint64_t*, const uint64_t*, size_t, uint64_t);
+
+bool kernelSupported(TagLookupKernel kernel) {
+    switch (kernel) {
+        case TagLookupKernel::SCALAR:
+            return true;
+#ifdef TAG_LOOKUP_X86
+        case TagLookupKernel::SSE2:
+            return true;
+        case TagLookupKernel::AVX2:
+            __builtin_cpu_init(); // May run from a static initializer
+            return __builtin_cpu_supports("avx2");
+#endif
+        default:
+            return false;
+    }
+}
+
+LookupFunction kernelFunction(TagLookupKernel kernel) {
+    switch (kernel) {
+#ifdef TAG_LOOKUP_X86
+        case TagLookupKernel::SSE2: return lookupSSE2;
+        case TagLookupKernel::AVX2: return lookupAVX2;
+#endif
+        default: return lookupScalar;
+    }
+}
+
+TagLookupKernel detectKernel() {
+    if (kernelSupported(TagLookupKernel::AVX2)) return TagLookupKernel::AVX2;
+    if (kernelSupported(TagLookupKernel::SSE2)) return TagLookupKernel::SSE2;
+    return TagLookupKernel::SCALAR;
+}
+
+TagLookupKernel active_kernel = detectKernel();
+LookupFunction active_lookup = kernelFunction(active_kernel);
+
+} // namespace
+
+TagLookupResult lookupTag(const uint64_t* tags, const uint64_t* valid_words, size_t ways, uint64_t tag) {
+    return active_lookup(tags, valid_words, ways, tag);
+}
+
+TagLookupKernel getTagLookupKernel() {
+    return active_kernel;
+}
+
+bool setTagLookupKernel(TagLookupKernel kernel) {
+    if (!kernelSupported(kernel)) {
+        return false;
+    }
+    active_kernel = kernel;
+    active_lookup = kernelFunction(kernel);
+    return true;
+}
+
+const char* tagLookupKernelName(TagLookupKernel kernel) {
+    switch (kernel) {
+        case TagLookupKernel::SCALAR: return "Scalar";
+        case TagLookupKernel::SSE2: return "SSE2";
+        case TagLookupKernel::AVX2: return "AVX2";
+        default: return "Unknown";
+    }
+}
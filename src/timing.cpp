@@ -0,0 +1,108 @@
+#include "timing.h"
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+
+void LatencyHistogram::record(uint64_t cycles, uint64_t count) {
+    if (count == 0) {
+        return;
+    }
+    buckets_[cycles] += count;
+    count_ += count;
+    total_cycles_ += cycles * count;
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other) {
+    for (const auto& bucket : other.buckets_) {
+        record(bucket.first, bucket.second);
+    }
+}
+
+double LatencyHistogram::getMean() const {
+    return count_ > 0 ? static_cast<double>(total_cycles_) / count_ : 0.0;
+}
+
+uint64_t LatencyHistogram::getPercentile(double percentile) const {
+    if (count_ == 0) {
+        return 0;
+    }
+    // Nearest rank: the first latency whose cumulative count reaches the rank
+    uint64_t rank = static_cast<uint64_t>(std::ceil(percentile / 100.0 * count_));
+    if (rank == 0) {
+        rank = 1;
+    }
+    uint64_t seen = 0;
+    for (const auto& bucket : buckets_) {
+        seen += bucket.second;
+        if (seen >= rank) {
+            return bucket.first;
+        }
+    }
+    return buckets_.rbegin()->first;
+}
+
+double AccessTiming::getAMAT() const {
+    uint64_t accesses = reads.getCount() + writes.getCount();
+    return accesses > 0 ? static_cast<double>(getTotalCycles()) / accesses : 0.0;
+}
+
+LatencyHistogram AccessTiming::getCombined() const {
+    LatencyHistogram combined = reads;
+    combined.merge(writes);
+    return combined;
+}
+
+std::string AccessTiming::toString(bool histogram) const {
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(2);
+
+    oss << "Simulated Timing:\n";
+    oss << "  Total Cycles: " << getTotalCycles() << "\n";
+    oss << "  AMAT: " << getAMAT() << " cycles\n";
+
+    auto line = [&oss](const char* name, const LatencyHistogram& histogram) {
+        oss << "  " << name << " Latency: mean " << histogram.getMean()
+            << ", p50 " << histogram.getPercentile(50) << ", p99 " << histogram.getPercentile(99) << " cycles\n";
+    };
+    line("Read", reads);
+    line("Write", writes);
+    if (!histogram) {
+        return oss.str();
+    }
+
+    oss << "  Latency Histogram (cycles: reads, writes):\n";
+    LatencyHistogram combined = getCombined();
+    for (const auto& bucket : combined.getBuckets()) {
+        auto count = [&bucket](const LatencyHistogram& histogram) -> uint64_t {
+            auto it = histogram.getBuckets().find(bucket.first);
+            return it == histogram.getBuckets().end() ? 0 : it->second;
+        };
+        oss << "    " << bucket.first << ": " << count(reads) << ", " << count(writes) << "\n";
+    }
+
+    return oss.str();
+}
+
+AccessTiming TimingModel::evaluate(const CacheStatistics& stats, bool write_allocate) const {
+    AccessTiming timing;
+    uint64_t miss_latency = hit_latency + miss_penalty;
+    uint64_t victim_latency = hit_latency + kVictimCacheCycles;
+
+    uint64_t read_hits = stats.getHits() - stats.getWriteHits();
+    uint64_t read_misses = stats.getMisses() - stats.getWriteMisses();
+    uint64_t victim_read_hits = stats.getVictimHits() - stats.getVictimWriteHits();
+    timing.reads.record(hit_latency, read_hits);
+    timing.reads.record(victim_latency, victim_read_hits);
+    timing.reads.record(miss_latency, read_misses - victim_read_hits);
+
+    timing.writes.record(hit_latency, stats.getWriteHits());
+    if (write_allocate) {
+        timing.writes.record(victim_latency, stats.getVictimWriteHits());
+        timing.writes.record(miss_latency, stats.getWriteMisses() - stats.getVictimWriteHits());
+    } else {
+        // The store goes to the write buffer without waiting for the block
+        timing.writes.record(hit_latency, stats.getWriteMisses());
+    }
+
+    return timing;
+}
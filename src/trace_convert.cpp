@@ -0,0 +1,144 @@
+#include "binary_trace.h"
+#include "trace_reader.h"
+#include <algorithm>
+#include <cstdio>
+#include <getopt.h>
+#include <iostream>
+#include <string>
+#include <vector>
+
+void printHelp(const char* program_name) {
+    std::cout << "Trace Converter - convert between text and binary trace formats\n";
+    std::cout << "Usage: " << program_name << " [OPTIONS] INPUT OUTPUT\n\n";
+    std::cout << "The direction is chosen from the input: text traces are written as binary,\n";
+    std::cout << "binary traces are written back as text.\n\n";
+    std::cout << "Options:\n";
+    std::cout << "  -B, --to-binary            Always write a binary trace\n";
+    std::cout << "  -T, --to-text              Always write a text trace\n";
+    std::cout << "  -n, --block-records N      Records per binary block (default: "
+              << binary_trace::kDefaultRecordsPerBlock << ")\n";
+    std::cout << "  -c, --core-ids             Store core ids in the binary trace (default: only if\n";
+    std::cout << "                             the first records carry a non-zero core id)\n";
+    std::cout << "  -s, --timestamps           Store timestamps in the binary trace (default: only if\n";
+    std::cout << "                             the first records carry a non-zero timestamp)\n";
+    std::cout << "  -h, --help                 Show this help message\n\n";
+    std::cout << "Examples:\n";
+    std::cout << "  " << program_name << " trace.txt trace.bin\n";
+    std::cout << "  " << program_name << " trace.bin trace.txt\n";
+}
+
+int main(int argc, char* argv[]) {
+    enum class Target { AUTO, BINARY, TEXT } target = Target::AUTO;
+    uint32_t block_records = binary_trace::kDefaultRecordsPerBlock;
+    bool core_ids = false;
+    bool timestamps = false;
+    
+    static struct option long_options[] = {
+        {"to-binary", no_argument, 0, 'B'},
+        {"to-text", no_argument, 0, 'T'},
+        {"block-records", required_argument, 0, 'n'},
+        {"core-ids", no_argument, 0, 'c'},
+        {"timestamps", no_argument, 0, 's'},
+        {"help", no_argument, 0, 'h'},
+        {0, 0, 0, 0}
+    };
+    
+    int opt;
+    while ((opt = getopt_long(argc, argv, "BTn:csh", long_options, nullptr)) != -1) {
+        switch (opt) {
+            case 'B':
+                target = Target::BINARY;
+                break;
+            case 'T':
+                target = Target::TEXT;
+                break;
+            case 'n':
+                block_records = static_cast<uint32_t>(std::stoul(optarg));
+                break;
+            case 'c':
+                core_ids = true;
+                break;
+            case 's':
+                timestamps = true;
+                break;
+            case 'h':
+                printHelp(argv[0]);
+                return 0;
+            default:
+                printHelp(argv[0]);
+                return 1;
+        }
+    }
+    
+    if (argc - optind != 2) {
+        printHelp(argv[0]);
+        return 1;
+    }
+    std::string input = argv[optind];
+    std::string output = argv[optind + 1];
+    
+    try {
+        if (target == Target::AUTO) {
+            target = binary_trace::isBinaryTrace(input) ? Target::TEXT : Target::BINARY;
+        }
+        
+        constexpr size_t kReadChunk = 1 << 16;
+        auto reader = openTraceReader(input);
+        std::vector<TraceRecord> records;
+        records.reserve(kReadChunk);
+        uint64_t converted = 0;
+        
+        if (target == Target::BINARY) {
+            // Multi-core and timed traces are recognized from their first chunk
+            reader->read(records, kReadChunk);
+            core_ids = core_ids || std::any_of(records.begin(), records.end(),
+                                               [](const TraceRecord& record) { return record.core != 0; });
+            timestamps = timestamps || std::any_of(records.begin(), records.end(),
+                                                   [](const TraceRecord& record) { return record.timestamp != 0; });
+            BinaryTraceWriter writer(output, block_records, core_ids, timestamps);
+            do {
+                for (const auto& record : records) {
+                    writer.write(record);
+                }
+                records.clear();
+            } while (reader->read(records, kReadChunk) > 0);
+            writer.finish();
+            converted = writer.getRecordCount();
+        } else {
+            FILE* file = std::fopen(output.c_str(), "w");
+            if (!file) {
+                throw std::runtime_error("Cannot create trace file: " + output);
+            }
+            while (reader->read(records, kReadChunk) > 0) {
+                for (const auto& record : records) {
+                    char op = record.operation == Cache::Operation::WRITE ? 'W' : 'R';
+                    unsigned long long address = record.address;
+                    if (record.timestamp != 0) {
+                        std::fprintf(file, "%c 0x%llx %u %llu\n", op, address, record.core,
+                                     static_cast<unsigned long long>(record.timestamp));
+                    } else if (record.core != 0) {
+                        std::fprintf(file, "%c 0x%llx %u\n", op, address, record.core);
+                    } else {
+                        std::fprintf(file, "%c 0x%llx\n", op, address);
+                    }
+                }
+                converted += records.size();
+                records.clear();
+            }
+            if (std::fclose(file) != 0) {
+                throw std::runtime_error("Failed to write trace file: " + output);
+            }
+        }
+        
+        std::cout << "Converted " << converted << " records from " << input << " to "
+                  << (target == Target::BINARY ? "binary" : "text") << " trace " << output << std::endl;
+        if (reader->getInvalidRecords() > 0) {
+            std::cout << "Skipped " << reader->getInvalidRecords() << " invalid lines" << std::endl;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    
+    return 0;
+}
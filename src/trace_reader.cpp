@@ -0,0 +1,246 @@
+#include "trace_reader.h"
+#include "binary_trace.h"
+#include <cstring>
+#include <iostream>
+
+namespace {
+
+inline bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+inline const char* skipSpaces(const char* p, const char* end) {
+    while (p < end && isSpace(*p)) ++p;
+    return p;
+}
+
+inline const char* skipToken(const char* p, const char* end) {
+    while (p < end && !isSpace(*p)) ++p;
+    return p;
+}
+
+// Case-insensitive match of [begin, end) against an upper-case keyword
+inline bool matchKeyword(const char* begin, const char* end, const char* keyword) {
+    size_t length = static_cast<size_t>(end - begin);
+    if (length != std::strlen(keyword)) return false;
+    for (size_t i = 0; i < length; ++i) {
+        if ((begin[i] & ~0x20) != keyword[i]) return false;
+    }
+    return true;
+}
+
+} // namespace
+
+TextTraceParser::TextTraceParser(std::string source_name)
+    : source_name_(std::move(source_name)), line_number_(0), invalid_lines_(0) {
+}
+
+const char* TextTraceParser::parse(const char* begin, const char* end, bool final,
+                                   std::vector<TraceRecord>& out, size_t max_records) {
+    const char* p = begin;
+    size_t target = out.size() + max_records;
+    while (p < end && out.size() < target) {
+        const char* line_end = static_cast<const char*>(std::memchr(p, '\n', end - p));
+        if (!line_end) {
+            if (!final) break;
+            line_end = end;
+        }
+        ++line_number_;
+        parseLine(p, line_end, out);
+        p = (line_end < end) ? line_end + 1 : end;
+    }
+    return p;
+}
+
+void TextTraceParser::parseLine(const char* begin, const char* end, std::vector<TraceRecord>& out) {
+    const char* p = skipSpaces(begin, end);
+    
+    // Skip empty lines and comments
+    if (p == end || *p == '#') {
+        return;
+    }
+    
+    const char* op_begin = p;
+    const char* op_end = skipToken(p, end);
+    const char* addr_begin = skipSpaces(op_end, end);
+    const char* addr_end = skipToken(addr_begin, end);
+    
+    if (addr_begin == addr_end) {
+        warn("Invalid format", begin, end);
+        return;
+    }
+    
+    Cache::Operation operation;
+    if (matchKeyword(op_begin, op_end, "R") || matchKeyword(op_begin, op_end, "READ")) {
+        operation = Cache::Operation::READ;
+    } else if (matchKeyword(op_begin, op_end, "W") || matchKeyword(op_begin, op_end, "WRITE")) {
+        operation = Cache::Operation::WRITE;
+    } else {
+        warn("Unknown operation", op_begin, op_end);
+        return;
+    }
+    
+    uint64_t address;
+    if (!parseAddress(addr_begin, addr_end, address)) {
+        warn("Failed to parse address", addr_begin, addr_end);
+        return;
+    }
+    
+    uint64_t core = 0;
+    const char* core_begin = skipSpaces(addr_end, end);
+    const char* core_end = skipToken(core_begin, end);
+    if (core_begin != core_end && *core_begin != '#' &&
+        (!parseAddress(core_begin, core_end, core) || core > UINT32_MAX)) {
+        warn("Failed to parse core id", core_begin, core_end);
+        return;
+    }
+    
+    uint64_t timestamp = 0;
+    const char* time_begin = skipSpaces(core_end, end);
+    const char* time_end = skipToken(time_begin, end);
+    if (core_begin != core_end && *core_begin != '#' && time_begin != time_end && *time_begin != '#' &&
+        !parseTimestamp(time_begin, time_end, timestamp)) {
+        warn("Failed to parse timestamp", time_begin, time_end);
+        return;
+    }
+    
+    out.push_back(TraceRecord{address, operation, static_cast<uint32_t>(core), timestamp});
+}
+
+bool TextTraceParser::parseAddress(const char* begin, const char* end, uint64_t& address) {
+    if (begin == end) {
+        return false;
+    }
+    
+    unsigned base = 10;
+    if (end - begin > 2 && begin[0] == '0' && (begin[1] | 0x20) == 'x') {
+        base = 16;
+        begin += 2;
+    } else if (end - begin > 1 && begin[0] == '0') {
+        base = 8;
+        begin += 1;
+    }
+    return parseDigits(begin, end, base, address);
+}
+
+bool TextTraceParser::parseTimestamp(const char* begin, const char* end, uint64_t& timestamp) {
+    if (begin == end) {
+        return false;
+    }
+    
+    // Cycle counts are often zero-padded, so a leading 0 does not mean octal
+    if (end - begin > 2 && begin[0] == '0' && (begin[1] | 0x20) == 'x') {
+        return parseDigits(begin + 2, end, 16, timestamp);
+    }
+    return parseDigits(begin, end, 10, timestamp);
+}
+
+bool TextTraceParser::parseDigits(const char* begin, const char* end, unsigned base, uint64_t& result) {
+    uint64_t value = 0;
+    for (const char* p = begin; p < end; ++p) {
+        unsigned digit;
+        char c = *p;
+        if (c >= '0' && c <= '9') {
+            digit = static_cast<unsigned>(c - '0');
+        } else if ((c | 0x20) >= 'a' && (c | 0x20) <= 'f') {
+            digit = static_cast<unsigned>((c | 0x20) - 'a' + 10);
+        } else {
+            return false;
+        }
+        if (digit >= base || value > (UINT64_MAX - digit) / base) {
+            return false;
+        }
+        value = value * base + digit;
+    }
+    
+    result = value;
+    return true;
+}
+
+void TextTraceParser::warn(const char* message, const char* begin, const char* end) {
+    ++invalid_lines_;
+    if (invalid_lines_ <= kMaxWarnings) {
+        std::cerr << "Warning: " << message << " '" << std::string(begin, end)
+                  << "' at line " << line_number_ << " of " << source_name_ << std::endl;
+    } else if (invalid_lines_ == kMaxWarnings + 1) {
+        std::cerr << "Warning: further invalid lines in " << source_name_ << " are not reported" << std::endl;
+    }
+}
+
+TextTraceReader::TextTraceReader(const std::string& filename)
+    : file_(filename), parser_(filename), cursor_(file_.data()) {
+}
+
+size_t TextTraceReader::read(std::vector<TraceRecord>& out, size_t max_records) {
+    size_t before = out.size();
+    const char* end = file_.data() + file_.size();
+    cursor_ = parser_.parse(cursor_, end, true, out, max_records);
+    return out.size() - before;
+}
+
+GzipTextTraceReader::GzipTextTraceReader(const std::string& filename)
+    : stream_(filename), parser_(filename), cursor_(nullptr), chunk_end_(nullptr) {
+}
+
+size_t GzipTextTraceReader::read(std::vector<TraceRecord>& out, size_t max_records) {
+    size_t before = out.size();
+    size_t target = before + max_records;
+    while (out.size() < target) {
+        if (cursor_ == chunk_end_) {
+            size_t size;
+            if (!stream_.next(cursor_, size)) {
+                cursor_ = chunk_end_ = nullptr;
+                if (!carry_.empty()) {
+                    parser_.parse(carry_.data(), carry_.data() + carry_.size(), true, out, target - out.size());
+                    carry_.clear();
+                }
+                break;
+            }
+            chunk_end_ = cursor_ + size;
+        }
+        
+        if (!carry_.empty()) {
+            // Complete the line that straddles the chunk boundary
+            const char* newline = static_cast<const char*>(std::memchr(cursor_, '\n', chunk_end_ - cursor_));
+            const char* line_end = newline ? newline + 1 : chunk_end_;
+            carry_.append(cursor_, line_end);
+            cursor_ = line_end;
+            if (newline) {
+                parser_.parse(carry_.data(), carry_.data() + carry_.size(), true, out, target - out.size());
+                carry_.clear();
+            }
+            continue;
+        }
+        
+        const char* p = parser_.parse(cursor_, chunk_end_, false, out, target - out.size());
+        if (out.size() < target) {
+            // Parser stopped at an incomplete last line
+            carry_.assign(p, chunk_end_);
+            p = chunk_end_;
+        }
+        cursor_ = p;
+    }
+    return out.size() - before;
+}
+
+std::unique_ptr<TraceReader> openTraceReader(const std::string& filename) {
+    if (GzipStream::isGzipFile(filename)) {
+        if (binary_trace::isBinaryTrace(filename)) {
+            return std::make_unique<GzipBinaryTraceReader>(filename);
+        }
+        return std::make_unique<GzipTextTraceReader>(filename);
+    }
+    if (binary_trace::isBinaryTrace(filename)) {
+        return std::make_unique<BinaryTraceReader>(filename);
+    }
+    return std::make_unique<TextTraceReader>(filename);
+}
+
+uint64_t readTrace(const std::string& filename, std::vector<TraceRecord>& records) {
+    constexpr size_t kReadChunk = 1 << 16;
+    auto reader = openTraceReader(filename);
+    records.clear();
+    while (reader->read(records, kReadChunk) > 0) {
+    }
+    return reader->getInvalidRecords();
+}
@@ -0,0 +1,63 @@
+#include "victim_cache.h"
+#include <algorithm>
+#include <stdexcept>
+
+VictimCache::VictimCache(size_t entries, Mode mode)
+    : capacity_(entries), mode_(mode) {
+    if (entries == 0) {
+        throw std::invalid_argument("Victim and miss caches need at least one entry");
+    }
+    entries_.reserve(entries);
+}
+
+size_t VictimCache::position(uint64_t block) const {
+    // Buffers hold a handful of blocks, so a scan beats any index
+    for (size_t i = 0; i < entries_.size(); ++i) {
+        if (entries_[i].block == block) {
+            return i;
+        }
+    }
+    return entries_.size();
+}
+
+bool VictimCache::find(uint64_t block) {
+    size_t pos = position(block);
+    if (pos == entries_.size()) {
+        return false;
+    }
+    std::rotate(entries_.begin(), entries_.begin() + pos, entries_.begin() + pos + 1);
+    return true;
+}
+
+bool VictimCache::remove(uint64_t block, bool* dirty) {
+    size_t pos = position(block);
+    if (pos == entries_.size()) {
+        return false;
+    }
+    if (dirty) {
+        *dirty = entries_[pos].dirty;
+    }
+    entries_.erase(entries_.begin() + pos);
+    return true;
+}
+
+bool VictimCache::insert(uint64_t block, bool dirty, uint64_t& evicted, bool& evicted_dirty) {
+    bool replaced = false;
+    if (entries_.size() == capacity_) {
+        evicted = entries_.back().block;
+        evicted_dirty = entries_.back().dirty;
+        entries_.pop_back();
+        replaced = true;
+    }
+    entries_.insert(entries_.begin(), Entry{block, dirty});
+    return replaced;
+}
+
+bool VictimCache::markDirty(uint64_t block) {
+    size_t pos = position(block);
+    if (pos == entries_.size()) {
+        return false;
+    }
+    entries_[pos].dirty = true;
+    return true;
+}
@@ -1,8 +1,27 @@
 #include "set_associative_cache.h"
 #include "replacement_policy.h"
+#include "tag_lookup.h"
+#include "trace_reader.h"
+#include "binary_trace.h"
+#include "gzip_stream.h"
+#include "sweep.h"
+#include "stack_distance.h"
+#include "sharded_cache.h"
+#include "cache_hierarchy.h"
+#include "coherence.h"
+#include "prefetcher.h"
+#include "victim_cache.h"
+#include "nonblocking_cache.h"
+#include "timing.h"
 #include <iostream>
+#include <sstream>
 #include <vector>
+#include <algorithm>
+#include <map>
 #include <cassert>
+#include <cstdio>
+#include <cstring>
+#include <zlib.h>
 
 void testDirectMappedCache() {
     std::cout << "\n=== Testing Direct-Mapped Cache ===\n";
@@ -102,10 +121,12 @@ void testReplacementPolicies() {
     std::vector<ReplacementPolicyFactory::PolicyType> policies = {
         ReplacementPolicyFactory::PolicyType::LRU,
         ReplacementPolicyFactory::PolicyType::FIFO,
-        ReplacementPolicyFactory::PolicyType::RANDOM
+        ReplacementPolicyFactory::PolicyType::RANDOM,
+        ReplacementPolicyFactory::PolicyType::TREE_PLRU,
+        ReplacementPolicyFactory::PolicyType::BIT_PLRU
     };
     
-    std::vector<std::string> policy_names = {"LRU", "FIFO", "RANDOM"};
+    std::vector<std::string> policy_names = {"LRU", "FIFO", "RANDOM", "TREE_PLRU", "BIT_PLRU"};
     
     // Access pattern that will cause evictions
     std::vector<uint64_t> addresses = {0x0, 0x10, 0x80, 0x0, 0x10, 0x90};
@@ -131,6 +152,313 @@ void testReplacementPolicies() {
     }
 }
 
+void testPseudoLRUPolicies() {
+    std::cout << "\n=== Testing Pseudo-LRU Policies ===\n";
+    
+    uint64_t full_bits = 0xF;
+    WayMask full(&full_bits, 4);
+    
+    // Tree-PLRU: after 0,1,2,3 the tree points at 0; touching 0 moves it to 2
+    TreePLRUPolicy tree(1, 4);
+    for (size_t way = 0; way < 4; ++way) {
+        tree.updateOnAccess(0, way, false);
+    }
+    assert(tree.selectVictim(0, full) == 0);
+    tree.updateOnAccess(0, 0, true);
+    assert(tree.selectVictim(0, full) == 2);
+    
+    // Bit-PLRU: the first way without its MRU bit; a full set starts a new epoch
+    BitPLRUPolicy bits(1, 4);
+    for (size_t way = 0; way < 3; ++way) {
+        bits.updateOnAccess(0, way, false);
+    }
+    assert(bits.selectVictim(0, full) == 3);
+    bits.updateOnAccess(0, 3, false);
+    assert(bits.selectVictim(0, full) == 0);
+    
+    // Non-power-of-two and wide sets only ever pick real ways
+    for (size_t ways : {3, 6, 100}) {
+        TreePLRUPolicy wide_tree(2, ways);
+        BitPLRUPolicy wide_bits(2, ways);
+        std::vector<uint64_t> valid_bits((ways + 63) / 64, ~0ULL);
+        WayMask valid(valid_bits.data(), ways);
+        for (size_t i = 0; i < 1000; ++i) {
+            size_t way = (i * 7919) % ways;
+            wide_tree.updateOnAccess(1, way, false);
+            wide_bits.updateOnAccess(1, way, false);
+            assert(wide_tree.selectVictim(1, valid) < ways);
+            assert(wide_bits.selectVictim(1, valid) < ways);
+            assert(wide_tree.selectVictim(1, valid) != way);
+            assert(ways == 1 || wide_bits.selectVictim(1, valid) != way);
+        }
+    }
+    
+    // With two ways tree-PLRU is exact LRU
+    CacheSpec spec;
+    spec.cache_size = 4096;
+    spec.block_size = 64;
+    spec.associativity = 2;
+    auto lru = spec.createCache();
+    spec.replacement_policy = "TREE_PLRU";
+    auto plru = spec.createCache();
+    assert(plru->getReplacementPolicy().getName() == "Tree-PLRU");
+    for (size_t i = 0; i < 50000; ++i) {
+        uint64_t address = (i * 2654435761ULL) % (1 << 14);
+        assert(lru->access(address, Cache::Operation::READ) == plru->access(address, Cache::Operation::READ));
+    }
+    
+    std::cout << "Tree-PLRU and bit-PLRU victims verified\n";
+}
+
+void testRRIPPolicies() {
+    std::cout << "\n=== Testing RRIP Policies ===\n";
+    
+    // Fills enter at 2, a hit promotes to 0, the victim is the first block aged to 3
+    uint64_t full_bits = 0xF;
+    WayMask full(&full_bits, 4);
+    RRIPPolicy srrip(1, 4, RRIPPolicy::Mode::STATIC);
+    for (size_t way = 0; way < 4; ++way) {
+        srrip.updateOnAccess(0, way, false);
+    }
+    srrip.updateOnAccess(0, 1, true);
+    assert(srrip.getRRPV(0, 1) == 0);
+    assert(srrip.selectVictim(0, full) == 0);
+    assert(srrip.getRRPV(0, 1) == 1);
+    srrip.updateOnAccess(0, 0, false);
+    assert(srrip.selectVictim(0, full) == 2);
+    
+    // A reused working set survives scans under SRRIP but not under LRU
+    CacheSpec spec;
+    spec.cache_size = 8 * 64;
+    spec.block_size = 64;
+    spec.associativity = 8;
+    auto lru = spec.createCache();
+    spec.replacement_policy = "SRRIP";
+    auto scan_resistant = spec.createCache();
+    assert(scan_resistant->getReplacementPolicy().getName() == "SRRIP");
+    uint64_t scan = 0x100000;
+    for (size_t round = 0; round < 100; ++round) {
+        for (size_t pass = 0; pass < 2; ++pass) {
+            for (uint64_t block = 0; block < 4; ++block) {
+                lru->access(block * 64, Cache::Operation::READ);
+                scan_resistant->access(block * 64, Cache::Operation::READ);
+            }
+        }
+        for (size_t i = 0; i < 8; ++i, scan += 64) {
+            lru->access(scan, Cache::Operation::READ);
+            scan_resistant->access(scan, Cache::Operation::READ);
+        }
+    }
+    assert(scan_resistant->getStatistics().getMisses() < lru->getStatistics().getMisses());
+    
+    // DRRIP: a loop larger than the cache thrashes the SRRIP leaders, so followers pick BRRIP
+    spec.cache_size = 256 * 4 * 64;
+    spec.associativity = 4;
+    spec.replacement_policy = "DRRIP";
+    auto dueling = spec.createCache();
+    for (size_t round = 0; round < 20; ++round) {
+        for (uint64_t block = 0; block < 1536; ++block) {
+            dueling->access(block * 64, Cache::Operation::READ);
+        }
+    }
+    std::map<std::string, uint64_t> counters;
+    for (const auto& counter : dueling->getPolicyCounters()) {
+        counters[counter.first] = counter.second;
+    }
+    assert(counters.size() == 6);
+    uint64_t misses = dueling->getStatistics().getMisses();
+    assert(counters["Long-Interval Fills"] + counters["Distant-Interval Fills"] == misses);
+    assert(counters["SRRIP Leader Misses"] + counters["BRRIP Leader Misses"] +
+           counters["Follower Fills Using SRRIP"] + counters["Follower Fills Using BRRIP"] == misses);
+    assert(counters["SRRIP Leader Misses"] > counters["BRRIP Leader Misses"]);
+    assert(counters["Follower Fills Using BRRIP"] > counters["Follower Fills Using SRRIP"]);
+    
+    dueling->clear();
+    assert(dueling->getPolicyCounters()[0].second == 0);
+    assert(lru->getPolicyCounters().empty());
+    
+    std::cout << "RRIP insertion, aging and set dueling verified\n";
+}
+
+void testFrequencyPolicies() {
+    std::cout << "\n=== Testing LFU and ARC Policies ===\n";
+    
+    // LFU evicts the least recently used block of the lowest count
+    uint64_t full_bits = 0xF;
+    WayMask full(&full_bits, 4);
+    LFUPolicy lfu(1, 4);
+    for (size_t way = 0; way < 4; ++way) {
+        lfu.updateOnAccess(0, way, false);
+    }
+    for (size_t i = 0; i < 3; ++i) {
+        lfu.updateOnAccess(0, 2, true);
+    }
+    lfu.updateOnAccess(0, 0, true);
+    assert(lfu.getFrequency(0, 2) == 4);
+    assert(lfu.selectVictim(0, full) == 1);
+    lfu.updateOnAccess(0, 1, false);
+    assert(lfu.selectVictim(0, full) == 3);
+    
+    // Aging halves the counts once per kAgingPeriod * ways accesses
+    for (size_t i = 0; i < LFUPolicy::kAgingPeriod * 4 - 10; ++i) {
+        lfu.updateOnAccess(0, 2, true);
+    }
+    assert(lfu.getFrequency(0, 2) == LFUPolicy::kMaxFrequency);
+    lfu.updateOnAccess(0, 2, true);
+    assert(lfu.getFrequency(0, 2) == LFUPolicy::kMaxFrequency / 2);
+    assert(lfu.getCounters()[0].second == 1);
+    
+    // Hot blocks plus a stream of cold ones: the reuse distance of the hot
+    // blocks exceeds the set, so LRU misses on them while LFU and ARC keep them
+    CacheSpec spec;
+    spec.cache_size = 8 * 64;
+    spec.block_size = 64;
+    spec.associativity = 0;
+    auto lru = spec.createCache();
+    spec.replacement_policy = "LFU";
+    auto frequency = spec.createCache();
+    spec.replacement_policy = "ARC";
+    auto adaptive = spec.createCache();
+    assert(frequency->getReplacementPolicy().getName() == "LFU");
+    assert(adaptive->getReplacementPolicy().getName() == "ARC");
+    uint64_t cold = 0x100000;
+    for (size_t round = 0; round < 200; ++round) {
+        for (size_t pass = 0; pass < 2; ++pass) {
+            for (uint64_t block = 0; block < 4; ++block) {
+                lru->access(block * 64, Cache::Operation::READ);
+                frequency->access(block * 64, Cache::Operation::READ);
+                adaptive->access(block * 64, Cache::Operation::READ);
+            }
+        }
+        for (size_t i = 0; i < 6; ++i, cold += 64) {
+            lru->access(cold, Cache::Operation::READ);
+            frequency->access(cold, Cache::Operation::READ);
+            adaptive->access(cold, Cache::Operation::READ);
+        }
+    }
+    assert(frequency->getStatistics().getMisses() < lru->getStatistics().getMisses());
+    assert(adaptive->getStatistics().getMisses() < lru->getStatistics().getMisses());
+    
+    // Blocks touched twice per lap of a loop larger than the cache come back as
+    // ghosts of both lists; the lists stay within their bounds
+    spec.cache_size = 4 * 128 * 64;
+    spec.associativity = 128;
+    auto wide = spec.createCache();
+    const auto& arc = dynamic_cast<const ARCPolicy&>(wide->getReplacementPolicy());
+    for (size_t i = 0; i < 100000; ++i) {
+        uint64_t block = (i % 4 == 0) ? (i * 2654435761ULL) % 4096 : (i / 2) % 600;
+        wide->access(block * 64, (i % 7 == 0) ? Cache::Operation::WRITE : Cache::Operation::READ);
+        if (i % 997 == 0) {
+            for (size_t set = 0; set < 4; ++set) {
+                auto sizes = arc.getListSizes(set);
+                assert(sizes[0] + sizes[1] <= 128);
+                assert(sizes[0] + sizes[2] <= 128);
+                assert(sizes[0] + sizes[1] + sizes[2] + sizes[3] <= 256);
+                assert(arc.getTarget(set) <= 128);
+            }
+        }
+    }
+    Cache::PolicyCounters counters = wide->getPolicyCounters();
+    assert(counters.size() == 4);
+    assert(counters[0].second > 0 && counters[1].second > 0);
+    assert(counters[2].second + counters[3].second + 4 * 128 == wide->getStatistics().getMisses());
+    
+    wide->clear();
+    assert(wide->getPolicyCounters()[0].second == 0);
+    assert(arc.getListSizes(0)[2] == 0);
+    
+    std::cout << "LFU buckets, aging and ARC ghost lists verified\n";
+}
+
+void testRandomSeed() {
+    std::cout << "\n=== Testing Random Replacement Seeds ===\n";
+    
+    // Equal seeds repeat a run, also after clear(); other seeds diverge
+    CacheSpec spec;
+    spec.cache_size = 4096;
+    spec.block_size = 64;
+    spec.associativity = 8;
+    spec.replacement_policy = "RANDOM";
+    auto first = spec.createCache();
+    auto second = spec.createCache();
+    spec.seed = 42;
+    auto other = spec.createCache();
+    std::vector<Cache::AccessResult> results;
+    bool diverged = false;
+    for (size_t i = 0; i < 20000; ++i) {
+        uint64_t address = ((i * 2654435761ULL) % 256) * 64;
+        auto result = first->access(address, Cache::Operation::READ);
+        assert(second->access(address, Cache::Operation::READ) == result);
+        diverged |= other->access(address, Cache::Operation::READ) != result;
+        results.push_back(result);
+    }
+    assert(diverged);
+    first->clear();
+    for (size_t i = 0; i < results.size(); ++i) {
+        assert(first->access(((i * 2654435761ULL) % 256) * 64, Cache::Operation::READ) == results[i]);
+    }
+    
+    // Rank and hole queries of a mask spanning several words
+    std::vector<uint64_t> wide_bits = {~0ULL, 0x5};
+    WayMask wide(wide_bits.data(), 70);
+    assert(wide.count() == 66 && wide.firstInvalid() == 65);
+    assert(wide.nthValid(64) == 64 && wide.nthValid(65) == 66 && wide.nthValid(66) == 70);
+    wide_bits[1] = ~0ULL;
+    assert(wide.count() == 70 && wide.firstInvalid() == 70);
+    
+    // Victims are always valid ways, and every valid way gets chosen
+    RandomPolicy random(1, 8, 7);
+    uint64_t hole_bits = 0x32;    // Ways 1, 4 and 5
+    WayMask holes(&hole_bits, 8);
+    std::vector<size_t> picks(8, 0);
+    for (size_t i = 0; i < 3000; ++i) {
+        ++picks[random.selectVictim(0, holes)];
+    }
+    for (size_t way = 0; way < 8; ++way) {
+        assert((picks[way] > 0) == holes[way]);
+    }
+}
+
+void testWideSetLRU() {
+    std::cout << "\n=== Testing O(1) LRU for Wide Sets ===\n";
+    
+    // 512 ways in one set: indexed lookup with the recency-list LRU
+    CacheSpec spec;
+    spec.cache_size = 512 * 64;
+    spec.block_size = 64;
+    spec.associativity = 0;
+    auto fast = spec.createCache();
+    assert(dynamic_cast<const ListLRUPolicy*>(&fast->getReplacementPolicy()) != nullptr);
+    
+    // Reference: the timestamp LRU scan
+    SetAssociativeCache reference(spec.cache_size, spec.block_size, 512,
+                                  std::make_unique<LRUPolicy>(1, 512));
+    StackDistanceAnalyzer analyzer(64, 1, 1);
+    
+    for (size_t i = 0; i < 100000; ++i) {
+        uint64_t address = ((i * 2654435761ULL) % 900) * 64 + (i % 64);
+        auto operation = (i % 5 == 0) ? Cache::Operation::WRITE : Cache::Operation::READ;
+        assert(fast->access(address, operation) == reference.access(address, operation));
+        analyzer.access(address);
+    }
+    assert(fast->getStatistics().getMisses() == analyzer.getMisses(512));
+    
+    // Invalidated blocks leave the index and their way is reused
+    uint64_t resident = ((99999 * 2654435761ULL) % 900) * 64;
+    assert(fast->contains(resident));
+    assert(fast->invalidateBlock(resident));
+    assert(!fast->contains(resident));
+    fast->insertBlock(0x100000, false);
+    assert(fast->contains(0x100000));
+    
+    fast->clear();
+    assert(!fast->contains(0x100000));
+    assert(fast->access(0x100000, Cache::Operation::READ) == Cache::AccessResult::MISS);
+    assert(fast->access(0x100000, Cache::Operation::READ) == Cache::AccessResult::HIT);
+    
+    std::cout << "Indexed lookup and list LRU match the linear-scan engine\n";
+}
+
 void testWritePolicies() {
     std::cout << "\n=== Testing Write Policies ===\n";
     
@@ -178,6 +506,1267 @@ void testWritePolicies() {
     }
 }
 
+void testCacheInspection() {
+    std::cout << "\n=== Testing Cache Inspection APIs ===\n";
+    
+    size_t cache_size = 256;
+    size_t block_size = 32;
+    size_t associativity = 2;
+    
+    auto policy = ReplacementPolicyFactory::createPolicy(
+        ReplacementPolicyFactory::PolicyType::LRU,
+        cache_size / (block_size * associativity),
+        associativity
+    );
+    
+    SetAssociativeCache cache(cache_size, block_size, associativity, std::move(policy),
+                             SetAssociativeCache::WritePolicy::WRITE_BACK);
+    
+    cache.access(0x0, Cache::Operation::READ);    // Set 0, tag 0
+    cache.access(0x80, Cache::Operation::WRITE);  // Set 0, tag 1, dirty
+    cache.access(0x20, Cache::Operation::READ);   // Set 1, tag 0
+    
+    auto contents = cache.getCacheContents();
+    assert(contents.size() == cache.getNumSets());
+    for (size_t set = 0; set < contents.size(); ++set) {
+        assert(contents[set].size() == associativity);
+        for (size_t way = 0; way < associativity; ++way) {
+            assert(contents[set][way].valid == cache.isBlockValid(set, way));
+            assert(contents[set][way].dirty == cache.isBlockDirty(set, way));
+            assert(contents[set][way].tag == cache.getBlockTag(set, way));
+        }
+    }
+    assert(cache.isBlockValid(0, 0) && cache.isBlockValid(0, 1) && cache.isBlockValid(1, 0));
+    assert(!cache.isBlockValid(1, 1));
+    assert(cache.isBlockDirty(0, 1) && cache.getBlockTag(0, 1) == 1);
+    
+    std::cout << cache.getCacheContentsJSON() << std::endl;
+}
+
+void testDataTracking() {
+    std::cout << "\n=== Testing Data Tracking Mode ===\n";
+    
+    size_t cache_size = 256;
+    size_t block_size = 32;
+    size_t associativity = 2;
+    size_t num_sets = cache_size / (block_size * associativity);
+    
+    // Default mode keeps tags only
+    SetAssociativeCache tag_only(cache_size, block_size, associativity,
+        ReplacementPolicyFactory::createPolicy(ReplacementPolicyFactory::PolicyType::LRU, num_sets, associativity));
+    tag_only.access(0x0, Cache::Operation::READ);
+    assert(tag_only.getDataMode() == SetAssociativeCache::DataMode::TAG_ONLY);
+    assert(tag_only.getBlockData(0, 0) == nullptr);
+    assert(tag_only.getCacheContents()[0][0].data.empty());
+    
+    // Data-carrying mode exposes a zero-filled payload per block
+    SetAssociativeCache with_data(cache_size, block_size, associativity,
+        ReplacementPolicyFactory::createPolicy(ReplacementPolicyFactory::PolicyType::LRU, num_sets, associativity),
+        SetAssociativeCache::WritePolicy::WRITE_THROUGH,
+        SetAssociativeCache::WriteMissPolicy::WRITE_ALLOCATE,
+        SetAssociativeCache::DataMode::TRACK_DATA);
+    with_data.access(0x0, Cache::Operation::READ);
+    assert(with_data.getBlockData(0, 0) != nullptr);
+    assert(with_data.getCacheContents()[0][0].data.size() == block_size);
+    
+    std::cout << with_data.getConfig() << std::endl;
+}
+
+void testTagLookupKernels() {
+    std::cout << "\n=== Testing Tag Lookup Kernels ===\n";
+    
+    TagLookupKernel detected = getTagLookupKernel();
+    std::cout << "Detected kernel: " << tagLookupKernelName(detected) << "\n";
+    
+    std::vector<TagLookupKernel> kernels = {
+        TagLookupKernel::SCALAR, TagLookupKernel::SSE2, TagLookupKernel::AVX2
+    };
+    
+    // Compare every supported kernel against the scalar one on pseudo-random sets
+    uint64_t seed = 12345;
+    auto next = [&seed]() {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        return seed >> 33;
+    };
+    
+    for (size_t ways : {1, 2, 3, 4, 7, 8, 16, 33, 64, 100, 256}) {
+        std::vector<uint64_t> tags(ways);
+        std::vector<uint64_t> valid((ways + 63) / 64);
+        for (int trial = 0; trial < 50; ++trial) {
+            for (auto& t : tags) t = next() % 16;
+            for (auto& v : valid) v = (static_cast<uint64_t>(next()) << 32) ^ next() ^ (trial % 3 == 0 ? ~0ULL : 0);
+            uint64_t probe = next() % 16;
+            
+            setTagLookupKernel(TagLookupKernel::SCALAR);
+            TagLookupResult expected = lookupTag(tags.data(), valid.data(), ways, probe);
+            for (auto kernel : kernels) {
+                if (!setTagLookupKernel(kernel)) continue;
+                TagLookupResult actual = lookupTag(tags.data(), valid.data(), ways, probe);
+                assert(actual.hit_way == expected.hit_way);
+                if (expected.hit_way == -1) {
+                    assert(actual.empty_way == expected.empty_way);
+                }
+            }
+        }
+    }
+    
+    setTagLookupKernel(detected);
+    std::cout << "All supported kernels agree\n";
+}
+
+// Policy unknown to ReplacementPolicyFactory: always runs through virtual dispatch
+class EvictFirstPolicy : public ReplacementPolicy {
+public:
+    size_t selectVictim(size_t, WayMask valid_blocks) override {
+        // The cache only evicts from full sets and passes their valid bits
+        assert(valid_blocks.size() == 2 && valid_blocks.count() == 2);
+        return 0;
+    }
+    void updateOnAccess(size_t, size_t, bool) override { updates++; }
+    void reset() override { updates = 0; }
+    std::string getName() const override { return "EvictFirst"; }
+    
+    size_t updates = 0;
+};
+
+void testCustomPolicy() {
+    std::cout << "\n=== Testing Custom Policy Through Virtual Interface ===\n";
+    
+    auto policy = std::make_unique<EvictFirstPolicy>();
+    EvictFirstPolicy* raw_policy = policy.get();
+    
+    // 2-way, 2 sets
+    SetAssociativeCache cache(128, 32, 2, std::move(policy));
+    
+    std::vector<uint64_t> addresses = {0x0, 0x40, 0x80, 0x40, 0x0};
+    std::vector<Cache::AccessResult> expected = {
+        Cache::AccessResult::MISS, Cache::AccessResult::MISS,
+        Cache::AccessResult::MISS,  // Evicts way 0 (0x0)
+        Cache::AccessResult::HIT,
+        Cache::AccessResult::MISS
+    };
+    
+    Cache& base = cache;
+    for (size_t i = 0; i < addresses.size(); ++i) {
+        assert(base.access(addresses[i], Cache::Operation::READ) == expected[i]);
+    }
+    assert(raw_policy->updates == addresses.size());
+    
+    std::cout << cache.getConfig() << std::endl;
+}
+
+void testBatchAccess() {
+    std::cout << "\n=== Testing Batch Access ===\n";
+    
+    size_t cache_size = 1024;
+    size_t block_size = 32;
+    size_t associativity = 4;
+    size_t num_sets = cache_size / (block_size * associativity);
+    
+    // Mixed read/write stream longer than one internal batch chunk
+    std::vector<uint64_t> addresses;
+    std::vector<Cache::Operation> operations;
+    for (uint64_t i = 0; i < 1000; ++i) {
+        addresses.push_back(((i * 7919) % 97) * block_size);
+        operations.push_back(i % 3 == 0 ? Cache::Operation::WRITE : Cache::Operation::READ);
+    }
+    
+    for (auto write_policy : {SetAssociativeCache::WritePolicy::WRITE_THROUGH,
+                              SetAssociativeCache::WritePolicy::WRITE_BACK}) {
+        SetAssociativeCache single(cache_size, block_size, associativity,
+            ReplacementPolicyFactory::createPolicy(ReplacementPolicyFactory::PolicyType::LRU, num_sets, associativity),
+            write_policy);
+        SetAssociativeCache batched(cache_size, block_size, associativity,
+            ReplacementPolicyFactory::createPolicy(ReplacementPolicyFactory::PolicyType::LRU, num_sets, associativity),
+            write_policy);
+        
+        std::vector<Cache::AccessResult> results(addresses.size());
+        auto batch = batched.accessBatch(addresses.data(), operations.data(), addresses.size(), results.data());
+        
+        for (size_t i = 0; i < addresses.size(); ++i) {
+            assert(single.access(addresses[i], operations[i]) == results[i]);
+        }
+        
+        auto expected = single.getStatistics();
+        auto actual = batched.getStatistics();
+        assert(actual.getHits() == expected.getHits() && batch.hits() == expected.getHits());
+        assert(actual.getMisses() == expected.getMisses() && batch.misses() == expected.getMisses());
+        assert(actual.getWriteHits() == expected.getWriteHits() && batch.write_hits == expected.getWriteHits());
+        assert(actual.getReads() == expected.getReads());
+        assert(actual.getWrites() == expected.getWrites());
+        
+        // Counts-only batches update statistics the same way
+        batched.clear();
+        batched.accessBatch(addresses.data(), operations.data(), addresses.size());
+        assert(batched.getStatistics().getHits() == expected.getHits());
+    }
+    
+    std::cout << "Batch results match single accesses\n";
+}
+
+void testPrefetchers() {
+    std::cout << "\n=== Testing Prefetchers ===\n";
+    
+    std::vector<uint64_t> prefetches;
+    
+    // Stride: issues once the stride has repeated twice within a region
+    StridePrefetcher stride(64, 1, 1);
+    for (uint64_t block : {0, 3, 6}) {
+        stride.train(block, prefetches);
+    }
+    assert(prefetches.empty());
+    stride.train(9, prefetches);
+    assert(prefetches == std::vector<uint64_t>({12}));
+    
+    // Stream: the second access sets the direction, the head stays within distance
+    StreamPrefetcher stream(2, 4);
+    prefetches.clear();
+    stream.train(100, prefetches);
+    assert(prefetches.empty());
+    stream.train(101, prefetches);
+    assert(prefetches == std::vector<uint64_t>({102, 103}));
+    prefetches.clear();
+    stream.train(1000, prefetches);
+    stream.train(999, prefetches);
+    assert(prefetches == std::vector<uint64_t>({998, 997}));
+    
+    assert(PrefetcherFactory::stringToPrefetcher("next_line") == PrefetcherFactory::PrefetcherType::NEXT_LINE);
+    assert(!PrefetcherFactory::createPrefetcher(PrefetcherFactory::PrefetcherType::NONE, 64, 1, 1));
+    bool threw = false;
+    try {
+        PrefetcherFactory::createPrefetcher(PrefetcherFactory::PrefetcherType::STREAM, 64, 0, 1);
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    assert(threw);
+    
+    // A sequential read stream: every prefetcher removes most misses
+    CacheSpec spec;
+    spec.cache_size = 32768;
+    spec.block_size = 64;
+    spec.associativity = 8;
+    spec.prefetch_degree = 2;
+    spec.prefetch_distance = 4;
+    spec.prefetch_latency = 16;
+    uint64_t baseline = 0;
+    for (const char* type : {"NONE", "NEXT_LINE", "STRIDE", "STREAM"}) {
+        spec.prefetcher = type;
+        auto cache = spec.createCache();
+        for (uint64_t address = 0; address < (1 << 20); address += 8) {
+            cache->access(address, Cache::Operation::READ);
+        }
+        const CacheStatistics& stats = cache->getStatistics();
+        assert(stats.getUsefulPrefetches() + stats.getLatePrefetches() + stats.getUnusedPrefetches() <= stats.getPrefetches());
+        if (!spec.hasPrefetcher()) {
+            baseline = stats.getMisses();
+            assert(stats.getPrefetches() == 0);
+        } else {
+            assert(stats.getMisses() < baseline / 4);
+            assert(stats.getPrefetchAccuracy() > 90.0);
+        }
+    }
+    
+    // A prefetch latency longer than the reuse distance makes prefetches late
+    spec.prefetcher = "NEXT_LINE";
+    spec.prefetch_degree = 1;
+    spec.prefetch_distance = 1;
+    spec.prefetch_latency = 100;
+    auto late = spec.createCache();
+    for (uint64_t address = 0; address < 64 * 64; address += 8) {
+        late->access(address, Cache::Operation::READ);
+    }
+    assert(late->getStatistics().getMisses() == 1);
+    assert(late->getStatistics().getLatePrefetches() == 63);
+    assert(late->getStatistics().getUsefulPrefetches() == 0);
+    
+    // Direct-mapped, 4 sets: prefetching block 1 evicts block 5, which is used again
+    auto polluted = std::make_unique<SetAssociativeCache>(128, 32, 1,
+        ReplacementPolicyFactory::createPolicy(ReplacementPolicyFactory::PolicyType::LRU, 4, 1));
+    polluted->setPrefetcher(PrefetcherFactory::createPrefetcher(
+        PrefetcherFactory::PrefetcherType::NEXT_LINE, 32, 1, 1));
+    polluted->access(5 * 32, Cache::Operation::READ);   // Prefetches block 6
+    polluted->access(0, Cache::Operation::READ);        // Prefetches block 1 over block 5
+    assert(polluted->isBlockPrefetched(1, 0) && polluted->isBlockPrefetched(2, 0));
+    polluted->access(5 * 32, Cache::Operation::READ);   // Evicts unused block 1
+    CacheStatistics pollution = polluted->getStatistics();
+    assert(pollution.getPrefetches() == 2);
+    assert(pollution.getPollutingPrefetches() == 1);
+    assert(pollution.getUnusedPrefetches() == 1);
+    assert(pollution.getUsefulPrefetches() == 0);
+    assert(polluted->access(6 * 32, Cache::Operation::READ) == Cache::AccessResult::HIT);
+    assert(!polluted->isBlockPrefetched(2, 0));
+    assert(polluted->getStatistics().getUsefulPrefetches() == 1);
+    
+    // Configurations that cannot model prefetching are rejected
+    CacheSpec offline;
+    offline.replacement_policy = "OPT";
+    offline.prefetcher = "STREAM";
+    threw = false;
+    try {
+        offline.createCache();
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    assert(threw);
+    threw = false;
+    try {
+        ShardedCache sharded(spec, 2);
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    assert(threw);
+    
+    auto grid = parseSweepGrid("prefetcher=none,stride; prefetch-degree=1,4", CacheSpec());
+    assert(grid.size() == 4);
+    assert(grid[3].prefetcher == "STRIDE" && grid[3].prefetch_degree == 4);
+    
+    std::cout << "Prefetch accounting verified\n";
+}
+
+// Counts the traffic a cache sends to the level below it
+struct CountingMemory : LowerLevel {
+    uint64_t reads = 0;
+    uint64_t writes = 0;
+    uint64_t evictions = 0;
+    uint64_t writebacks = 0;
+    
+    bool read(uint64_t) override { reads++; return false; }
+    void write(uint64_t) override { writes++; }
+    void evict(uint64_t, bool dirty) override {
+        evictions++;
+        if (dirty) writebacks++;
+    }
+};
+
+void testVictimCache() {
+    std::cout << "\n=== Testing Victim and Miss Caches ===\n";
+    
+    auto makeCache = [](SetAssociativeCache::WriteMissPolicy write_miss) {
+        // 16 sets, direct-mapped: 0x0, 0x200 and 0x400 share set 0
+        return std::make_unique<SetAssociativeCache>(512, 32, 1,
+            ReplacementPolicyFactory::createPolicy(ReplacementPolicyFactory::PolicyType::LRU, 16, 1),
+            SetAssociativeCache::WritePolicy::WRITE_BACK, write_miss);
+    };
+    std::vector<uint64_t> ping_pong = {0x0, 0x200, 0x0, 0x200};
+    
+    // Victim cache: conflict misses swap blocks instead of going to memory
+    CountingMemory memory;
+    auto cache = makeCache(SetAssociativeCache::WriteMissPolicy::WRITE_ALLOCATE);
+    cache->setLowerLevel(&memory);
+    cache->setVictimCache(std::make_unique<VictimCache>(1, VictimCache::Mode::VICTIM));
+    for (uint64_t address : ping_pong) {
+        assert(cache->access(address, Cache::Operation::READ) == Cache::AccessResult::MISS);
+    }
+    assert(cache->getStatistics().getVictimHits() == 2);
+    assert(memory.reads == 2 && memory.evictions == 0);
+    
+    // A third block pushes the oldest victim out to memory
+    cache->access(0x400, Cache::Operation::WRITE);
+    assert(memory.reads == 3 && memory.evictions == 1 && memory.writebacks == 0);
+    cache->access(0x200, Cache::Operation::READ);
+    assert(cache->getStatistics().getVictimHits() == 3);
+    assert(cache->getVictimCache()->contains(0x400 >> 5));
+    bool dirty = false;
+    assert(cache->invalidateBlock(0x400, &dirty) && dirty);
+    assert(!cache->getVictimCache()->contains(0x400 >> 5));
+    
+    // No-write-allocate writes to a buffered block stay in the victim cache
+    CountingMemory nwa_memory;
+    auto nwa = makeCache(SetAssociativeCache::WriteMissPolicy::NO_WRITE_ALLOCATE);
+    nwa->setLowerLevel(&nwa_memory);
+    nwa->setVictimCache(std::make_unique<VictimCache>(2, VictimCache::Mode::VICTIM));
+    nwa->access(0x0, Cache::Operation::READ);
+    nwa->access(0x200, Cache::Operation::READ);
+    assert(nwa->access(0x0, Cache::Operation::WRITE) == Cache::AccessResult::WRITE_MISS);
+    assert(nwa_memory.writes == 0 && nwa->getStatistics().getVictimWriteHits() == 1);
+    nwa->access(0x0, Cache::Operation::READ);
+    nwa->access(0x400, Cache::Operation::READ);
+    nwa->access(0x600, Cache::Operation::READ);
+    assert(nwa_memory.evictions == 1 && nwa_memory.writebacks == 0);
+    nwa->access(0x800, Cache::Operation::READ);
+    assert(nwa_memory.writebacks == 1);   // Block 0x0 kept its dirty state through the swaps
+    
+    // Miss cache: copies of fetched blocks, evictions still go to memory
+    CountingMemory miss_memory;
+    auto miss = makeCache(SetAssociativeCache::WriteMissPolicy::WRITE_ALLOCATE);
+    miss->setLowerLevel(&miss_memory);
+    miss->setVictimCache(std::make_unique<VictimCache>(2, VictimCache::Mode::MISS));
+    for (uint64_t address : ping_pong) {
+        miss->access(address, Cache::Operation::READ);
+    }
+    assert(miss->getStatistics().getVictimHits() == 2);
+    assert(miss_memory.reads == 2 && miss_memory.evictions == 3);
+    
+    // clear() empties the buffer too
+    miss->clear();
+    assert(miss->access(0x0, Cache::Operation::READ) == Cache::AccessResult::MISS);
+    assert(miss->getStatistics().getVictimHits() == 0);
+    
+    CacheSpec spec;
+    spec.associativity = 1;
+    spec.victim_cache = 4;
+    assert(spec.toString() == "1024B/32B/1-way/LRU/WRITE_THROUGH/WRITE_ALLOCATE/VC:4");
+    assert(spec.createCache()->getVictimCache()->getMode() == VictimCache::Mode::VICTIM);
+    
+    bool threw = false;
+    try {
+        ShardedCache sharded(spec, 2);
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    assert(threw);
+    spec.miss_cache = 4;
+    threw = false;
+    try {
+        spec.createCache();
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    assert(threw);
+    
+    // Only L1 inherits a buffer from the base configuration
+    CacheSpec base;
+    base.victim_cache = 8;
+    auto levels = CacheHierarchy::parseSpec("s=1K;s=8K", base);
+    assert(levels[0].cache.victim_cache == 8 && levels[1].cache.victim_cache == 0);
+    
+    auto grid = parseSweepGrid("a=1,2; victim-cache=0,8", CacheSpec());
+    assert(grid.size() == 4 && grid[3].victim_cache == 8);
+    
+    std::cout << "Victim and miss cache behavior verified\n";
+}
+
+void testMemoryTraffic() {
+    std::cout << "\n=== Testing Memory Traffic Accounting ===\n";
+    
+    using Transfer = CacheStatistics::Transfer;
+    auto run = [](SetAssociativeCache::WritePolicy write, SetAssociativeCache::WriteMissPolicy write_miss) {
+        // 16 sets, direct-mapped: 0x0 and 0x200 share set 0
+        SetAssociativeCache cache(512, 32, 1,
+            ReplacementPolicyFactory::createPolicy(ReplacementPolicyFactory::PolicyType::LRU, 16, 1),
+            write, write_miss);
+        cache.access(0x0, Cache::Operation::READ);
+        cache.access(0x0, Cache::Operation::WRITE);
+        cache.access(0x200, Cache::Operation::READ);
+        cache.access(0x400, Cache::Operation::WRITE);
+        return cache.getStatistics();
+    };
+    
+    // Write-back: the dirty block is written back whole when 0x200 evicts it
+    CacheStatistics back = run(SetAssociativeCache::WritePolicy::WRITE_BACK,
+                               SetAssociativeCache::WriteMissPolicy::WRITE_ALLOCATE);
+    assert(back.getTransfers(Transfer::FILL) == 3 && back.getTransferBytes(Transfer::FILL) == 96);
+    assert(back.getTransfers(Transfer::WRITEBACK) == 1 && back.getTransferBytes(Transfer::WRITEBACK) == 32);
+    assert(back.getTransfers(Transfer::WRITE_THROUGH) == 0);
+    assert(back.getMemoryReadBytes() == 96 && back.getMemoryWriteBytes() == 32);
+    
+    // Write-through: each store goes down as one word, evictions are free
+    CacheStatistics through = run(SetAssociativeCache::WritePolicy::WRITE_THROUGH,
+                                  SetAssociativeCache::WriteMissPolicy::WRITE_ALLOCATE);
+    assert(through.getTransfers(Transfer::FILL) == 3);
+    assert(through.getTransfers(Transfer::WRITE_THROUGH) == 2 && through.getTransferBytes(Transfer::WRITE_THROUGH) == 16);
+    assert(through.getTransfers(Transfer::WRITEBACK) == 0);
+    
+    // No-write-allocate: the write miss bypasses the cache without a fill
+    CacheStatistics bypass = run(SetAssociativeCache::WritePolicy::WRITE_BACK,
+                                 SetAssociativeCache::WriteMissPolicy::NO_WRITE_ALLOCATE);
+    assert(bypass.getTransfers(Transfer::FILL) == 2);
+    assert(bypass.getTransfers(Transfer::BYPASS) == 1 && bypass.getTransferBytes(Transfer::BYPASS) == 8);
+    assert(bypass.getMemoryWriteBytes() == 40);
+    
+    // Prefetch fills are counted apart from demand fills
+    CacheSpec spec;
+    spec.prefetcher = "NEXT_LINE";
+    auto prefetching = spec.createCache();
+    prefetching->access(0x0, Cache::Operation::READ);
+    CacheStatistics prefetched = prefetching->getStatistics();
+    assert(prefetched.getTransfers(Transfer::FILL) == 1 && prefetched.getTransfers(Transfer::PREFETCH_FILL) == 1);
+    assert(prefetched.getMemoryReadBytes() == 64);
+    
+    // Shards account the same traffic as one cache
+    std::vector<uint64_t> addresses;
+    std::vector<Cache::Operation> operations;
+    for (size_t i = 0; i < 50000; ++i) {
+        addresses.push_back((i * 2654435761ULL) % (1 << 16));
+        operations.push_back((i % 3 == 0) ? Cache::Operation::WRITE : Cache::Operation::READ);
+    }
+    CacheSpec shared;
+    shared.cache_size = 8192;
+    shared.block_size = 64;
+    shared.write_policy = "WRITE_BACK";
+    auto serial = shared.createCache();
+    ShardedCache sharded(shared, 4);
+    serial->accessBatch(addresses.data(), operations.data(), addresses.size());
+    sharded.accessBatch(addresses.data(), operations.data(), addresses.size());
+    assert(sharded.getStatistics().getMemoryReadBytes() == serial->getStatistics().getMemoryReadBytes());
+    assert(sharded.getStatistics().getMemoryWriteBytes() == serial->getStatistics().getMemoryWriteBytes());
+    
+    std::cout << "Write-back moved " << back.getMemoryWriteBytes() << " bytes, write-through "
+              << through.getMemoryWriteBytes() << "\n";
+}
+
+void testTiming() {
+    std::cout << "\n=== Testing Simulated Timing ===\n";
+    
+    // Percentiles use the nearest rank
+    LatencyHistogram histogram;
+    assert(histogram.getPercentile(50) == 0 && histogram.getMean() == 0.0);
+    histogram.record(1, 98);
+    histogram.record(100, 2);
+    assert(histogram.getCount() == 100 && histogram.getTotalCycles() == 298);
+    assert(histogram.getPercentile(50) == 1);
+    assert(histogram.getPercentile(98) == 1);
+    assert(histogram.getPercentile(99) == 100);
+    assert(histogram.getPercentile(100) == 100);
+    
+    // Single cache: 512B direct-mapped, 0x0 and 0x200 share set 0
+    CacheSpec spec;
+    spec.cache_size = 512;
+    spec.block_size = 32;
+    spec.associativity = 1;
+    spec.write_policy = "WRITE_BACK";
+    spec.hit_latency = 2;
+    spec.miss_penalty = 20;
+    auto run = [](const CacheSpec& config) {
+        auto cache = config.createCache();
+        cache->access(0x0, Cache::Operation::READ);     // Miss
+        cache->access(0x0, Cache::Operation::READ);     // Hit
+        cache->access(0x0, Cache::Operation::WRITE);    // Hit
+        cache->access(0x200, Cache::Operation::WRITE);  // Miss
+        cache->access(0x0, Cache::Operation::READ);     // Miss, or victim cache hit
+        return config.evaluateTiming(cache->getStatistics());
+    };
+    
+    AccessTiming allocate = run(spec);
+    assert(allocate.reads.getTotalCycles() == 22 + 2 + 22);
+    assert(allocate.writes.getTotalCycles() == 2 + 22);
+    assert(allocate.getTotalCycles() == 70 && allocate.getAMAT() == 14.0);
+    assert(allocate.reads.getPercentile(50) == 22 && allocate.writes.getPercentile(50) == 2);
+    
+    // No-write-allocate stores are buffered and cost a hit
+    spec.write_miss_policy = "NO_WRITE_ALLOCATE";
+    AccessTiming buffered = run(spec);
+    assert(buffered.writes.getTotalCycles() == 4);
+    assert(buffered.reads.getTotalCycles() == 22 + 2 + 2);   // 0x0 stayed cached
+    
+    // A victim cache hit costs one cycle more than a hit
+    spec.write_miss_policy = "WRITE_ALLOCATE";
+    spec.victim_cache = 2;
+    AccessTiming victim = run(spec);
+    assert(victim.reads.getTotalCycles() == 22 + 2 + 3);
+    assert(victim.getCombined().getCount() == 5);
+    
+    // Hierarchy: a hit in L2 costs both hit latencies, memory adds the last miss penalty
+    CacheSpec base;
+    base.block_size = 64;
+    auto levels = CacheHierarchy::parseSpec(
+        "s=128,a=0,m=NO_WRITE_ALLOCATE;s=1K,a=0,hit-latency=10,miss-penalty=100", base);
+    CacheHierarchy hierarchy(levels);
+    std::vector<uint64_t> addresses = {0x0, 0x0, 0x40, 0x80, 0x0, 0x1000};
+    std::vector<Cache::Operation> operations(addresses.size(), Cache::Operation::READ);
+    operations.back() = Cache::Operation::WRITE;
+    hierarchy.accessBatch(addresses.data(), operations.data(), addresses.size());
+    AccessTiming timing = hierarchy.getTiming();
+    const auto& reads = timing.reads.getBuckets();
+    assert(reads.size() == 3 && reads.at(1) == 1 && reads.at(11) == 1 && reads.at(111) == 3);
+    // The write-through to L2 allocates there but the store itself does not wait
+    assert(timing.writes.getCount() == 1 && timing.writes.getTotalCycles() == 1);
+    assert(hierarchy.getLevel(1).contains(0x1000));
+    
+    // Single accesses are attributed like batches
+    CacheHierarchy single(levels);
+    for (size_t i = 0; i < addresses.size(); ++i) {
+        single.access(addresses[i], operations[i]);
+    }
+    assert(single.getTiming().getTotalCycles() == timing.getTotalCycles());
+    single.resetStatistics();
+    assert(single.getTiming().getTotalCycles() == 0);
+    
+    std::cout << "Hierarchy AMAT: " << timing.getAMAT() << " cycles\n";
+}
+
+void testNonBlockingCache() {
+    std::cout << "\n=== Testing Non-Blocking Cache ===\n";
+    
+    // 512B direct-mapped, misses take 1 + 10 cycles, two MSHRs
+    CacheSpec spec;
+    spec.cache_size = 512;
+    spec.block_size = 32;
+    spec.associativity = 1;
+    spec.miss_penalty = 10;
+    NonBlockingCache cache(spec, 2);
+    
+    auto read = [](uint64_t address, uint64_t timestamp) {
+        TraceRecord record{address, Cache::Operation::READ};
+        record.timestamp = timestamp;
+        return record;
+    };
+    std::vector<TraceRecord> records = {
+        read(0x0, 0),     // Primary miss, fills at 11
+        read(0x20, 1),    // Primary miss, fills at 12
+        read(0x0, 2),     // Merges into the first MSHR, done at 11
+        read(0x40, 3),    // Both MSHRs busy: stalls until 11, fills at 22
+        read(0x100, 4),   // Delayed to 12 by the stall, fills at 23
+        read(0x20, 5),    // Hit under miss at 13
+    };
+    cache.accessBatch(records.data(), records.size());
+    
+    const auto& counters = cache.getCounters();
+    assert(counters.primary_misses == 4 && counters.secondary_misses == 1);
+    assert(counters.hits_under_miss == 1);
+    assert(counters.stalls == 1 && counters.stall_cycles == 8);
+    assert(cache.getElapsedCycles() == 23);
+    assert(cache.getOccupancy() == std::vector<uint64_t>({0, 2, 21}));
+    assert(cache.getMLP() > 1.9 && cache.getMLP() < 1.92);
+    
+    const auto& reads = cache.getTiming().reads.getBuckets();
+    assert(reads.at(1) == 1 && reads.at(9) == 1 && reads.at(11) == 3 && reads.at(19) == 1);
+    assert(cache.getTiming().getTotalCycles() == 62);
+    
+    // Hit and miss counts match a blocking cache; more MSHRs only shorten the run
+    std::vector<TraceRecord> trace;
+    for (size_t i = 0; i < 20000; ++i) {
+        uint64_t address = (i * 2654435761ULL) % (1 << 14);
+        trace.push_back(TraceRecord{address, (i % 4 == 0) ? Cache::Operation::WRITE : Cache::Operation::READ});
+    }
+    NonBlockingCache narrow(spec, 1);
+    NonBlockingCache wide(spec, 16);
+    auto blocking = spec.createCache();
+    narrow.accessBatch(trace.data(), trace.size());
+    wide.accessBatch(trace.data(), trace.size());
+    for (const auto& record : trace) {
+        blocking->access(record.address, record.operation);
+    }
+    assert(wide.getStatistics().getMisses() == blocking->getStatistics().getMisses());
+    assert(narrow.getStatistics().getHits() == blocking->getStatistics().getHits());
+    assert(narrow.getMLP() == 1.0);
+    assert(wide.getMLP() > 1.0);
+    assert(wide.getElapsedCycles() < narrow.getElapsedCycles());
+    assert(wide.getCounters().stall_cycles < narrow.getCounters().stall_cycles);
+    
+    // No MSHRs, too many, and "-1" wrapped to SIZE_MAX are all refused before any allocation
+    for (size_t mshrs : {size_t(0), NonBlockingCache::kMaxMshrs + 1, SIZE_MAX}) {
+        bool threw = false;
+        try {
+            NonBlockingCache invalid(spec, mshrs);
+        } catch (const std::invalid_argument&) {
+            threw = true;
+        }
+        assert(threw);
+    }
+    CacheSpec opt = spec;
+    opt.replacement_policy = "OPT";
+    bool threw = false;
+    try {
+        NonBlockingCache offline(opt, 4);
+    } catch (const std::invalid_argument& e) {
+        threw = std::string(e.what()).find("OPT") != std::string::npos;
+    }
+    assert(threw);
+    assert(NonBlockingCache(spec, NonBlockingCache::kMaxMshrs).getOccupancy().size() == NonBlockingCache::kMaxMshrs + 1);
+    
+    std::cout << "MLP with 16 MSHRs: " << wide.getMLP() << "\n";
+}
+
+void testTraceParser() {
+    std::cout << "\n=== Testing Text Trace Parser ===\n";
+    
+    const char* text =
+        "# comment\n"
+        "R 0x400000\n"
+        "  write 0x1F  \r\n"
+        "\n"
+        "READ 64\n"
+        "X 0x10\n"          // Unknown operation
+        "W 0xZZ\n"          // Bad address
+        "w 0xffffffffffffffff";  // Last line without newline
+    const char* end = text + std::strlen(text);
+    
+    // Split the input mid-line: the first call must stop at the last complete line
+    const char* split = std::strstr(text, "READ 64") + 3;
+    TextTraceParser parser("inline");
+    std::vector<TraceRecord> records;
+    const char* rest = parser.parse(text, split, false, records, 100);
+    assert(records.size() == 2);
+    assert(rest == std::strstr(text, "READ 64"));
+    parser.parse(rest, end, true, records, 100);
+    
+    assert(records.size() == 4);
+    assert(records[0].address == 0x400000 && records[0].operation == Cache::Operation::READ);
+    assert(records[1].address == 0x1F && records[1].operation == Cache::Operation::WRITE);
+    assert(records[2].address == 64 && records[2].operation == Cache::Operation::READ);
+    assert(records[3].address == 0xffffffffffffffffULL && records[3].operation == Cache::Operation::WRITE);
+    assert(parser.getInvalidLines() == 2);
+    
+    // max_records bounds each call
+    TextTraceParser limited("inline");
+    std::vector<TraceRecord> first;
+    const char* next = limited.parse(text, end, true, first, 1);
+    assert(first.size() == 1);
+    limited.parse(next, end, true, first, 100);
+    assert(first.size() == 4);
+    
+    // Timed traces carry a timestamp after the core id
+    const char* timed = "R 0x40 0 1000\nW 0x80 1 0x7d2 # comment\nR 0xc0 2\n";
+    TextTraceParser timed_parser("inline");
+    std::vector<TraceRecord> stamped;
+    timed_parser.parse(timed, timed + std::strlen(timed), true, stamped, 100);
+    assert(stamped.size() == 3 && timed_parser.getInvalidLines() == 0);
+    assert(stamped[0].timestamp == 1000 && stamped[1].timestamp == 2002 && stamped[1].core == 1);
+    assert(stamped[2].timestamp == 0 && stamped[2].core == 2);
+    
+    // Zero-padded timestamps are decimal, not octal
+    const char* padded = "R 0x40 0 0100\nR 0x80 0 09\nR 0xc0 0 0x0100\n";
+    TextTraceParser padded_parser("inline");
+    std::vector<TraceRecord> padded_records;
+    padded_parser.parse(padded, padded + std::strlen(padded), true, padded_records, 100);
+    assert(padded_records.size() == 3 && padded_parser.getInvalidLines() == 0);
+    assert(padded_records[0].timestamp == 100 && padded_records[1].timestamp == 9);
+    assert(padded_records[2].timestamp == 0x100);
+    
+    std::cout << "Parsed " << records.size() << " records, skipped " << parser.getInvalidLines() << " lines\n";
+}
+
+void testBinaryTrace() {
+    std::cout << "\n=== Testing Binary Trace Format ===\n";
+    
+    // Forward, backward and wrap-around deltas across several small blocks
+    std::vector<TraceRecord> records;
+    uint64_t addresses[] = {0x400000, 0x400040, 0x3fffc0, 0, 0xffffffffffffffffULL, 0x10, 0x10};
+    for (size_t i = 0; i < 20; ++i) {
+        Cache::Operation op = (i % 3 == 0) ? Cache::Operation::WRITE : Cache::Operation::READ;
+        records.push_back(TraceRecord{addresses[i % 7] + i * 8, op});
+    }
+    
+    std::string filename = "cache_test_trace.bin";
+    {
+        BinaryTraceWriter writer(filename, 6);
+        for (const auto& record : records) {
+            writer.write(record);
+        }
+    }
+    
+    assert(binary_trace::isBinaryTrace(filename));
+    BinaryTraceReader reader(filename);
+    assert(reader.getRecordCount() == records.size());
+    assert(reader.getBlocks().size() == 4);
+    
+    // Blocks decode independently
+    std::vector<TraceRecord> last_block;
+    reader.decodeBlock(3, last_block);
+    assert(last_block.size() == 2);
+    assert(last_block[0].address == records[18].address);
+    
+    // openTraceReader detects the format; small reads span block boundaries
+    auto detected = openTraceReader(filename);
+    std::vector<TraceRecord> decoded;
+    while (detected->read(decoded, 4) > 0) {
+    }
+    assert(decoded.size() == records.size());
+    for (size_t i = 0; i < records.size(); ++i) {
+        assert(decoded[i].address == records[i].address);
+        assert(decoded[i].operation == records[i].operation);
+    }
+    
+    // Timestamps are stored as deltas and may go backwards
+    {
+        BinaryTraceWriter writer(filename, 6, false, true);
+        for (size_t i = 0; i < records.size(); ++i) {
+            TraceRecord record = records[i];
+            record.timestamp = (i == 9) ? 5 : 1000 + i * 37;
+            writer.write(record);
+        }
+    }
+    BinaryTraceReader timed(filename);
+    assert(timed.hasTimestamps() && !timed.hasCoreIds());
+    std::vector<TraceRecord> stamped;
+    while (timed.read(stamped, 7) > 0) {
+    }
+    assert(stamped.size() == records.size());
+    assert(stamped[9].timestamp == 5 && stamped[10].timestamp == 1370 && stamped[19].address == records[19].address);
+    
+    bool threw = false;
+    try {
+        BinaryTraceWriter writer(filename);
+        writer.write(stamped[0]);
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    assert(threw);
+    
+    std::remove(filename.c_str());
+    std::cout << "Round-tripped " << decoded.size() << " records in " << reader.getBlocks().size() << " blocks\n";
+}
+
+void testGzipTrace() {
+    std::cout << "\n=== Testing Gzip Trace Input ===\n";
+    
+    // Enough lines to span several 1MB decompressed chunks
+    const size_t count = 200000;
+    std::string filename = "cache_test_trace.txt.gz";
+    gzFile file = gzopen(filename.c_str(), "wb");
+    assert(file);
+    for (size_t i = 0; i < count; ++i) {
+        gzprintf(file, "%s 0x%zx\n", (i % 5 == 0) ? "WRITE" : "R", i * 24);
+    }
+    gzclose(file);
+    
+    assert(GzipStream::isGzipFile(filename));
+    assert(!binary_trace::isBinaryTrace(filename));
+    
+    std::vector<TraceRecord> records;
+    auto reader = openTraceReader(filename);
+    while (reader->read(records, 1000) > 0) {
+    }
+    assert(records.size() == count);
+    assert(reader->getInvalidRecords() == 0);
+    for (size_t i = 0; i < count; ++i) {
+        assert(records[i].address == i * 24);
+        assert(records[i].operation == ((i % 5 == 0) ? Cache::Operation::WRITE : Cache::Operation::READ));
+    }
+    
+    // Small chunks exercise the ring wrap-around and split reads
+    GzipStream stream(filename, 4096, 2);
+    std::string text;
+    char buffer[1000];
+    size_t got;
+    while ((got = stream.read(buffer, sizeof(buffer))) > 0) {
+        text.append(buffer, got);
+    }
+    assert(text.compare(0, 10, "WRITE 0x0\n") == 0);
+    assert(static_cast<size_t>(std::count(text.begin(), text.end(), '\n')) == count);
+    
+    std::remove(filename.c_str());
+    std::cout << "Decompressed " << records.size() << " records\n";
+}
+
+// Trace reader over records held in memory
+class VectorTraceReader : public TraceReader {
+public:
+    explicit VectorTraceReader(const std::vector<TraceRecord>& records) : records_(records), pos_(0) {}
+    
+    size_t read(std::vector<TraceRecord>& out, size_t max_records) override {
+        size_t count = std::min(max_records, records_.size() - pos_);
+        out.insert(out.end(), records_.begin() + pos_, records_.begin() + pos_ + count);
+        pos_ += count;
+        return count;
+    }
+    
+    uint64_t getInvalidRecords() const override { return 0; }
+    
+private:
+    const std::vector<TraceRecord>& records_;
+    size_t pos_;
+};
+
+void testSweep() {
+    std::cout << "\n=== Testing Configuration Sweep ===\n";
+    
+    CacheSpec base;
+    base.block_size = 64;
+    auto specs = parseSweepGrid("s=1K,4K; a=1,2,0; r=lru,FIFO", base);
+    assert(specs.size() == 12);
+    assert(specs[0].cache_size == 1024 && specs[0].associativity == 1 && specs[0].replacement_policy == "LRU");
+    assert(specs[11].cache_size == 4096 && specs[11].associativity == 0 && specs[11].replacement_policy == "FIFO");
+    assert(specs[5].block_size == 64);
+    
+    // One invalid point is skipped
+    CacheSpec invalid;
+    invalid.cache_size = 1000;
+    specs.push_back(invalid);
+    
+    // Several chunks worth of accesses with reuse at different distances
+    std::vector<TraceRecord> records;
+    for (size_t i = 0; i < 200000; ++i) {
+        uint64_t address = ((i * 2654435761ULL) % 8192) & ~7ULL;
+        records.push_back(TraceRecord{address, (i % 4 == 0) ? Cache::Operation::WRITE : Cache::Operation::READ});
+    }
+    
+    VectorTraceReader reader(records);
+    auto results = runSweep(reader, specs, 3);
+    assert(results.size() == 12);
+    
+    // Each result matches a standalone simulation of the same configuration
+    for (const auto& result : results) {
+        auto cache = result.spec.createCache();
+        for (const auto& record : records) {
+            cache->access(record.address, record.operation);
+        }
+        const CacheStatistics& expected = cache->getStatistics();
+        assert(result.statistics.getHits() == expected.getHits());
+        assert(result.statistics.getMisses() == expected.getMisses());
+        assert(result.statistics.getWriteHits() == expected.getWriteHits());
+        assert(result.statistics.getTotalAccesses() == records.size());
+    }
+    
+    std::ostringstream csv;
+    writeSweepCSV(csv, results);
+    std::string rows = csv.str();
+    assert(std::count(rows.begin(), rows.end(), '\n') == 13);
+    
+    std::cout << "Simulated " << results.size() << " configurations in one pass\n";
+}
+
+void testStackDistance() {
+    std::cout << "\n=== Testing Stack-Distance Analyzer ===\n";
+    
+    // Long enough to force the Fenwick tree to compact several times
+    std::vector<uint64_t> addresses;
+    for (size_t i = 0; i < 300000; ++i) {
+        uint64_t hot = (i * 7919) % 96;
+        uint64_t cold = (i * 2654435761ULL) % 4096;
+        addresses.push_back(((i % 3 == 0) ? cold : hot) * 32);
+    }
+    
+    StackDistanceAnalyzer analyzer(32, 16, 8);
+    analyzer.accessBatch(addresses.data(), addresses.size());
+    assert(analyzer.getAccesses() == addresses.size());
+    assert(analyzer.getColdMisses() == 4096);
+    
+    auto simulate = [&](size_t cache_size, size_t associativity) {
+        auto policy = ReplacementPolicyFactory::createPolicy(
+            ReplacementPolicyFactory::PolicyType::LRU,
+            associativity == 0 ? 1 : cache_size / (32 * associativity),
+            associativity == 0 ? cache_size / 32 : associativity);
+        SetAssociativeCache cache(cache_size, 32, associativity, std::move(policy));
+        for (uint64_t address : addresses) {
+            cache.access(address, Cache::Operation::READ);
+        }
+        return cache.getStatistics().getMisses();
+    };
+    
+    // Fully associative curve matches the simulator at every size tried
+    for (size_t blocks : {1, 8, 64, 96, 100, 512}) {
+        assert(analyzer.getMisses(blocks) == simulate(blocks * 32, 0));
+    }
+    
+    // Per-set curve matches a 16-set cache for each associativity
+    for (size_t ways : {1, 2, 4, 8}) {
+        assert(analyzer.getSetAssociativeMisses(ways) == simulate(16 * ways * 32, ways));
+    }
+    
+    std::cout << "Misses at 64 blocks: " << analyzer.getMisses(64) << " of " << analyzer.getAccesses() << "\n";
+}
+
+void testBeladyPolicy() {
+    std::cout << "\n=== Testing Belady OPT Replacement ===\n";
+    
+    // Next use of each access at block granularity
+    NextUseIndex small({0x0, 0x40, 0x8, 0x80, 0x44}, 64);
+    NextUseIndex::Cursor cursor(small);
+    assert(cursor.nextUse(0) == 2);
+    assert(cursor.nextUse(1) == 4);
+    assert(cursor.nextUse(2) == NextUseIndex::kNever);
+    assert(cursor.nextUse(3) == NextUseIndex::kNever);
+    assert(cursor.nextUse(5) == NextUseIndex::kNever);
+    
+    // Textbook reference string: 3 frames, 9 faults under OPT
+    std::vector<uint64_t> pages = {7, 0, 1, 2, 0, 3, 0, 4, 2, 3, 0, 3, 2, 1, 2, 0, 1, 7, 0, 1};
+    std::vector<uint64_t> addresses;
+    for (uint64_t page : pages) {
+        addresses.push_back(page * 64);
+    }
+    CacheSpec spec;
+    spec.cache_size = 3 * 64;
+    spec.block_size = 64;
+    spec.associativity = 0;
+    spec.replacement_policy = "OPT";
+    assert(spec.needsNextUseIndex());
+    bool threw = false;
+    try {
+        spec.createCache();
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    assert(threw);
+    auto textbook = spec.createCache(std::make_shared<const NextUseIndex>(addresses, 64));
+    assert(textbook->getReplacementPolicy().getName() == "OPT");
+    for (uint64_t address : addresses) {
+        textbook->access(address, Cache::Operation::READ);
+    }
+    assert(textbook->getStatistics().getMisses() == 9);
+    
+    // A spooled index matches the in-memory one
+    std::vector<TraceRecord> records;
+    addresses.clear();
+    for (size_t i = 0; i < 200000; ++i) {
+        uint64_t address = ((i % 3 == 0) ? (i * 2654435761ULL) % 65536 : (i * 7919) % 4096) & ~7ULL;
+        records.push_back(TraceRecord{address, (i % 4 == 0) ? Cache::Operation::WRITE : Cache::Operation::READ});
+        addresses.push_back(address);
+    }
+    VectorTraceReader spool_reader(records);
+    NextUseIndex spooled(spool_reader, 64, 1000);
+    NextUseIndex in_memory(addresses, 64);
+    assert(spooled.isFileBacked() && !in_memory.isFileBacked());
+    assert(spooled.size() == records.size());
+    NextUseIndex::Cursor spooled_cursor(spooled);
+    NextUseIndex::Cursor memory_cursor(in_memory);
+    for (size_t i = 0; i < records.size(); ++i) {
+        assert(spooled_cursor.nextUse(i) == memory_cursor.nextUse(i));
+    }
+    
+    // OPT in a sweep never misses more than the online policies
+    CacheSpec base;
+    base.cache_size = 4096;
+    base.block_size = 64;
+    auto specs = parseSweepGrid("a=2,0; r=OPT,LRU,SRRIP,TREE_PLRU", base);
+    VectorTraceReader sweep_reader(records);
+    std::vector<std::shared_ptr<const NextUseIndex>> next_use = {std::make_shared<const NextUseIndex>(addresses, 64)};
+    auto results = runSweep(sweep_reader, specs, 2, next_use);
+    assert(results.size() == 8);
+    for (const auto& result : results) {
+        const SweepResult& opt = results[result.spec.associativity == 2 ? 0 : 4];
+        assert(opt.spec.replacement_policy == "OPT");
+        assert(opt.statistics.getMisses() <= result.statistics.getMisses());
+    }
+    assert(results[0].statistics.getMisses() < results[1].statistics.getMisses());
+    
+    // The sweep result matches a standalone run, and clear() rewinds the trace position
+    auto standalone = results[0].spec.createCache(next_use[0]);
+    for (size_t round = 0; round < 2; ++round) {
+        standalone->clear();
+        for (const auto& record : records) {
+            standalone->access(record.address, record.operation);
+        }
+        assert(standalone->getStatistics().getMisses() == results[0].statistics.getMisses());
+    }
+    
+    std::cout << "OPT reaches the textbook optimum and bounds the online policies\n";
+}
+
+void testShardedCache() {
+    std::cout << "\n=== Testing Set-Sharded Simulation ===\n";
+    
+    std::vector<uint64_t> addresses;
+    std::vector<Cache::Operation> operations;
+    for (size_t i = 0; i < 150000; ++i) {
+        addresses.push_back((i * 2654435761ULL) % (1 << 18));
+        operations.push_back((i % 3 == 0) ? Cache::Operation::WRITE : Cache::Operation::READ);
+    }
+    
+    for (const char* policy : {"LRU", "FIFO"}) {
+        CacheSpec spec;
+        spec.cache_size = 16384;
+        spec.block_size = 64;
+        spec.associativity = 4;
+        spec.replacement_policy = policy;
+        spec.write_policy = "WRITE_BACK";
+        
+        auto serial = spec.createCache();
+        ShardedCache sharded(spec, 6);
+        assert(sharded.getShardCount() == 4);
+        
+        // Two batches: one partitioned in parallel, one small enough to run inline
+        std::vector<Cache::AccessResult> expected(addresses.size());
+        std::vector<Cache::AccessResult> actual(addresses.size());
+        serial->accessBatch(addresses.data(), operations.data(), addresses.size(), expected.data());
+        size_t split = addresses.size() - 1000;
+        sharded.accessBatch(addresses.data(), operations.data(), split, actual.data());
+        sharded.accessBatch(addresses.data() + split, operations.data() + split, 1000, actual.data() + split);
+        
+        assert(actual == expected);
+        CacheStatistics merged = sharded.getStatistics();
+        assert(merged.getHits() == serial->getStatistics().getHits());
+        assert(merged.getMisses() == serial->getStatistics().getMisses());
+        assert(merged.getWriteHits() == serial->getStatistics().getWriteHits());
+        assert(merged.getReads() == serial->getStatistics().getReads());
+        
+        // Single accesses route to the owning shard
+        assert(sharded.access(addresses.back(), Cache::Operation::READ) == Cache::AccessResult::HIT);
+    }
+    
+    // Every other set-local policy matches the serial engine too
+    for (const char* policy : {"SRRIP", "LFU", "ARC"}) {
+        CacheSpec spec;
+        spec.cache_size = 16384;
+        spec.associativity = 4;
+        spec.replacement_policy = policy;
+        auto serial = spec.createCache();
+        ShardedCache sharded(spec, 4);
+        serial->accessBatch(addresses.data(), operations.data(), addresses.size(), nullptr);
+        sharded.accessBatch(addresses.data(), operations.data(), addresses.size(), nullptr);
+        assert(sharded.getStatistics().getMisses() == serial->getStatistics().getMisses());
+    }
+    
+    // BRRIP and DRRIP keep cache-wide state that shards would split, so
+    // a sharded run could not match the serial one and is rejected
+    for (const char* policy : {"BRRIP", "DRRIP"}) {
+        CacheSpec spec;
+        spec.cache_size = 16384;
+        spec.associativity = 4;
+        spec.replacement_policy = policy;
+        bool threw = false;
+        try {
+            ShardedCache sharded(spec, 4);
+        } catch (const std::invalid_argument&) {
+            threw = true;
+        }
+        assert(threw);
+    }
+    
+    // Fully associative caches have a single set and cannot be split
+    CacheSpec full;
+    full.associativity = 0;
+    assert(ShardedCache(full, 8).getShardCount() == 1);
+    
+    std::cout << "Sharded results match the serial engine\n";
+}
+
+void testCacheHierarchy() {
+    std::cout << "\n=== Testing Cache Hierarchy ===\n";
+    
+    CacheSpec base;
+    base.block_size = 64;
+    base.write_policy = "WRITE_BACK";
+    
+    // The first level behaves exactly like a standalone cache
+    {
+        auto levels = CacheHierarchy::parseSpec("s=1K,a=2;s=8K,a=4,i=INCLUSIVE;s=32K,a=8,i=EXCLUSIVE", base);
+        assert(levels.size() == 3);
+        assert(levels[1].cache.cache_size == 8192);
+        assert(levels[2].inclusion == CacheHierarchy::InclusionPolicy::EXCLUSIVE);
+        
+        CacheHierarchy hierarchy(levels);
+        auto standalone = levels[0].cache.createCache();
+        for (size_t i = 0; i < 20000; ++i) {
+            uint64_t address = (i * 2654435761ULL) % (1 << 16);
+            auto operation = (i % 4 == 0) ? Cache::Operation::WRITE : Cache::Operation::READ;
+            assert(hierarchy.access(address, operation) == standalone->access(address, operation));
+        }
+        CacheStatistics l1 = hierarchy.getLevelStatistics(0);
+        CacheStatistics l2 = hierarchy.getLevelStatistics(1);
+        assert(l1.getMisses() == standalone->getStatistics().getMisses());
+        // Every L1 miss fetches from L2
+        assert(l2.getReads() == l1.getMisses());
+        assert(hierarchy.getMemoryReads() > 0);
+    }
+    
+    // Inclusive: evicting from L2 removes the L1 copy and writes it back
+    {
+        CacheHierarchy hierarchy(CacheHierarchy::parseSpec("s=128,a=0;s=128,a=1,i=INCLUSIVE", base));
+        hierarchy.access(0x0, Cache::Operation::WRITE);
+        hierarchy.access(0x80, Cache::Operation::READ);   // Same L2 set as 0x0
+        assert(!hierarchy.getLevel(0).contains(0x0));
+        assert(hierarchy.getLevel(0).contains(0x80));
+        assert(hierarchy.getLevelCounters(1).back_invalidations == 1);
+        assert(hierarchy.getMemoryReads() == 2);
+        assert(hierarchy.getMemoryWrites() == 1);
+    }
+    
+    // Exclusive: L1 victims fill L2 and L2 hits move back up
+    {
+        CacheHierarchy hierarchy(CacheHierarchy::parseSpec("s=128,a=0;s=256,a=0,i=EXCLUSIVE", base));
+        hierarchy.access(0x0, Cache::Operation::READ);
+        hierarchy.access(0x40, Cache::Operation::READ);
+        hierarchy.access(0x80, Cache::Operation::READ);   // Evicts 0x0 into L2
+        assert(hierarchy.getLevel(1).contains(0x0));
+        assert(!hierarchy.getLevel(1).contains(0x80));
+        assert(hierarchy.getLevelCounters(1).victim_fills == 1);
+        
+        assert(hierarchy.access(0x0, Cache::Operation::READ) == Cache::AccessResult::MISS);
+        assert(!hierarchy.getLevel(1).contains(0x0));
+        assert(hierarchy.getLevel(1).contains(0x40));
+        assert(hierarchy.getLevelStatistics(1).getHits() == 1);
+        assert(hierarchy.getMemoryReads() == 3);
+    }
+    
+    // Levels must agree on the block size
+    bool threw = false;
+    try {
+        CacheHierarchy hierarchy(CacheHierarchy::parseSpec("b=32;b=64", base));
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    assert(threw);
+    
+    std::cout << "Hierarchy propagates misses, evictions and invalidations\n";
+}
+
+void testCoherence() {
+    std::cout << "\n=== Testing MESI/MOESI Coherence ===\n";
+    
+    CacheSpec spec;
+    spec.cache_size = 4096;
+    spec.block_size = 64;
+    spec.associativity = 4;
+    using State = CoherenceSimulator::LineState;
+    
+    for (auto protocol : {CoherenceSimulator::Protocol::MESI, CoherenceSimulator::Protocol::MOESI}) {
+        CoherenceSimulator sim(spec, 2, protocol);
+        bool moesi = protocol == CoherenceSimulator::Protocol::MOESI;
+        
+        sim.access(0, 0x1000, Cache::Operation::READ);
+        assert(sim.getLineState(0, 0x1000) == State::EXCLUSIVE);
+        sim.access(1, 0x1000, Cache::Operation::READ);
+        assert(sim.getLineState(0, 0x1000) == State::SHARED);
+        assert(sim.getLineState(1, 0x1000) == State::SHARED);
+        
+        // Write hit on a Shared line upgrades and invalidates the other copy
+        assert(sim.access(0, 0x1000, Cache::Operation::WRITE) == Cache::AccessResult::WRITE_HIT);
+        assert(sim.getLineState(0, 0x1000) == State::MODIFIED);
+        assert(sim.getLineState(1, 0x1000) == State::INVALID);
+        assert(!sim.getCache(1).contains(0x1000));
+        assert(sim.getUpgrades() == 1);
+        assert(sim.getCoreCounters(1).invalidations_received == 1);
+        
+        // Reading the written word again is a true-sharing coherence miss
+        assert(sim.access(1, 0x1000, Cache::Operation::READ) == Cache::AccessResult::MISS);
+        assert(sim.getCoreCounters(1).true_sharing_misses == 1);
+        assert(sim.getLineState(0, 0x1000) == (moesi ? State::OWNED : State::SHARED));
+        assert(sim.getMemoryWrites() == (moesi ? 0u : 1u));
+        assert(sim.getCacheToCacheTransfers() == 2);
+    }
+    
+    // Two cores writing different words of one line: false sharing
+    CoherenceSimulator sim(spec, 2);
+    for (int i = 0; i < 10; ++i) {
+        sim.access(0, 0x2000, Cache::Operation::WRITE);
+        sim.access(1, 0x2008, Cache::Operation::WRITE);
+    }
+    assert(sim.getCoreCounters(0).false_sharing_misses == 9);
+    assert(sim.getCoreCounters(0).true_sharing_misses == 0);
+    auto lines = sim.getContendedLines(1);
+    assert(lines.size() == 1);
+    assert(lines[0].address == 0x2000);
+    assert(lines[0].ping_pongs == 19);
+    assert(lines[0].writers == 2);
+    
+    // Core ids come from the third trace column and survive the binary format
+    TextTraceParser parser;
+    std::vector<TraceRecord> records;
+    std::string text = "R 0x40 3\nW 0x80\nW 0xc0 1 # comment\nR 0x100 x\n";
+    parser.parse(text.data(), text.data() + text.size(), true, records, 10);
+    assert(records.size() == 3);
+    assert(records[0].core == 3 && records[1].core == 0 && records[2].core == 1);
+    assert(parser.getInvalidLines() == 1);
+    
+    std::string filename = "cache_test_cores.bin";
+    {
+        BinaryTraceWriter writer(filename, 2, true);
+        for (const auto& record : records) {
+            writer.write(record);
+        }
+    }
+    BinaryTraceReader reader(filename);
+    assert(reader.hasCoreIds());
+    std::vector<TraceRecord> decoded;
+    reader.read(decoded, 10);
+    assert(decoded.size() == 3 && decoded[0].core == 3 && decoded[2].core == 1);
+    std::remove(filename.c_str());
+    
+    bool threw = false;
+    try {
+        BinaryTraceWriter writer(filename, 2);
+        writer.write(records[0]);
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    assert(threw);
+    std::remove(filename.c_str());
+    
+    std::cout << "Coherence states, invalidations and sharing misses verified\n";
+}
+
 int main() {
     std::cout << "Cache Simulator Test Suite\n";
     std::cout << "==========================\n";
@@ -186,7 +1775,31 @@ int main() {
     testFullyAssociativeCache();
     testSetAssociativeCache();
     testReplacementPolicies();
+    testPseudoLRUPolicies();
+    testRRIPPolicies();
+    testFrequencyPolicies();
+    testRandomSeed();
+    testWideSetLRU();
     testWritePolicies();
+    testCacheInspection();
+    testDataTracking();
+    testTagLookupKernels();
+    testCustomPolicy();
+    testBatchAccess();
+    testPrefetchers();
+    testVictimCache();
+    testMemoryTraffic();
+    testTiming();
+    testNonBlockingCache();
+    testTraceParser();
+    testBinaryTrace();
+    testGzipTrace();
+    testSweep();
+    testStackDistance();
+    testBeladyPolicy();
+    testShardedCache();
+    testCacheHierarchy();
+    testCoherence();
     
     std::cout << "\nAll tests completed!\n";
     return 0;